@@ -0,0 +1,268 @@
+#include "Foundation/efwAsyncFileReader.h"
+#include "Foundation/efwThread.h"
+#include "Math/efwMath.h"
+
+using namespace efw;
+
+struct AsyncReadEntry
+{
+	const char* filename;
+	int32_t requiredAlignment;
+	AsyncReadCallback_t callback;
+	void* userData;
+
+	WorkerTask task;
+	AsyncReadBatch* batch;
+	int32_t result;
+	void* data;
+	uint64_t dataSize;
+	bool isComplete;
+	bool isClaimed;
+};
+
+struct efw::AsyncReadBatch
+{
+	AsyncReadBatch* nextLive;
+	FileReader::ReadFileFunc_t readFileFunc;
+
+	int32_t requestCount;
+	int32_t completedCount;
+	int32_t waiterCount;					// Threads waiting on a claimed entry, Release waits for them to leave
+	AsyncReadEntry entries[];
+};
+
+// Globals
+Mutex gAsyncMutex;
+ConditionVariable gAsyncWorkCompleted;
+bool gAsyncIsInitialized = false;
+
+// All batches not released yet, used to find prefetched files
+AsyncReadBatch* gAsyncLiveHead = NULL;
+
+
+void AsyncReadTask(void* userData)
+{
+	AsyncReadEntry* entry = (AsyncReadEntry*)userData;
+	AsyncReadBatch* batch = entry->batch;
+
+	void* data = NULL;
+	uint64_t dataSize = 0;
+	int32_t result = (*batch->readFileFunc)(&data, &dataSize, entry->filename, entry->requiredAlignment);
+	if (entry->callback != NULL)
+		entry->callback(result, data, dataSize, entry->filename, entry->userData);
+
+	ScopedLock lock(gAsyncMutex);
+	entry->result = result;
+	entry->data = data;
+	entry->dataSize = dataSize;
+	entry->isComplete = true;
+	batch->completedCount++;
+	gAsyncWorkCompleted.NotifyAll();
+}
+
+
+// Takes the data of an entry, waiting for it to complete. Must be called with gAsyncMutex locked.
+static int32_t ClaimEntry(void** outData, uint64_t* outSizeInBytes, AsyncReadEntry* entry)
+{
+	AsyncReadBatch* batch = entry->batch;
+	entry->isClaimed = true;
+	batch->waiterCount++;
+	while (!entry->isComplete)
+		gAsyncWorkCompleted.Wait(gAsyncMutex);
+
+	*outData = entry->data;
+	*outSizeInBytes = entry->dataSize;
+	entry->data = NULL;
+	int32_t result = entry->result;
+
+	// A Release waiting on this batch can only free it once every waiter is done with its entry
+	if (--batch->waiterCount == 0)
+		gAsyncWorkCompleted.NotifyAll();
+	return result;
+}
+
+
+int32_t AsyncFileReader::Initialize(int32_t workerCount)
+{
+	ScopedLock lock(gAsyncMutex);
+	if (gAsyncIsInitialized)
+		return efwErrs::kInvalidState;
+
+	int32_t result = WorkerPool::Initialize(workerCount);
+	gAsyncIsInitialized = (result == efwErrs::kOk);
+	return result;
+}
+
+
+void AsyncFileReader::Shutdown()
+{
+	// Pending requests are drained before shutting down, even when the pool stays alive for other users
+	{
+		ScopedLock lock(gAsyncMutex);
+		if (!gAsyncIsInitialized)
+			return;
+		gAsyncIsInitialized = false;
+
+		for (AsyncReadBatch* batch = gAsyncLiveHead; batch != NULL; batch = batch->nextLive)
+		{
+			while (batch->completedCount < batch->requestCount)
+				gAsyncWorkCompleted.Wait(gAsyncMutex);
+		}
+	}
+
+	WorkerPool::Shutdown();
+}
+
+
+int32_t AsyncFileReader::Submit(AsyncReadBatch** outBatch, const AsyncReadRequest* requests, int32_t requestCount, FileReader::ReadFileFunc_t readFileFunc)
+{
+	if (outBatch == NULL || requests == NULL || requestCount <= 0)
+		return efwErrs::kInvalidInput;
+	*outBatch = NULL;
+
+	// Entries and a copy of all file names are stored in a single allocation
+	size_t namesSize = 0;
+	for (int32_t i=0; i<requestCount; ++i)
+	{
+		if (requests[i].filename == NULL)
+			return efwErrs::kInvalidInput;
+		namesSize += strlen(requests[i].filename) + 1;
+	}
+
+	size_t entriesSize = sizeof(AsyncReadBatch) + requestCount * sizeof(AsyncReadEntry);
+	AsyncReadBatch* batch = (AsyncReadBatch*)memalign(16, entriesSize + namesSize);
+	if (batch == NULL)
+		return efwErrs::kOutOfMemory;
+	memset(batch, 0, entriesSize);
+	batch->readFileFunc = (readFileFunc != NULL)? readFileFunc : FileReader::ReadAll;
+	batch->requestCount = requestCount;
+
+	char* names = (char*)batch + entriesSize;
+	for (int32_t i=0; i<requestCount; ++i)
+	{
+		size_t nameSize = strlen(requests[i].filename) + 1;
+		memcpy(names, requests[i].filename, nameSize);
+
+		AsyncReadEntry& entry = batch->entries[i];
+		entry.filename = names;
+		entry.requiredAlignment = (requests[i].requiredAlignment > 0)? requests[i].requiredAlignment : File::kDefaultDataAlignment;
+		entry.callback = requests[i].callback;
+		entry.userData = requests[i].userData;
+		entry.task.func = AsyncReadTask;
+		entry.task.userData = &entry;
+		entry.batch = batch;
+		names += nameSize;
+	}
+
+	{
+		ScopedLock lock(gAsyncMutex);
+		if (!gAsyncIsInitialized)
+		{
+			freealign(batch);
+			return efwErrs::kInvalidState;
+		}
+
+		batch->nextLive = gAsyncLiveHead;
+		gAsyncLiveHead = batch;
+	}
+
+	// The reader holds a pool reference until Shutdown, which waits for this batch, so submitting can't fail
+	for (int32_t i=0; i<requestCount; ++i)
+		WorkerPool::Submit(&batch->entries[i].task);
+
+	*outBatch = batch;
+	return efwErrs::kOk;
+}
+
+
+bool AsyncFileReader::IsComplete(const AsyncReadBatch* batch)
+{
+	if (batch == NULL)
+		return true;
+
+	ScopedLock lock(gAsyncMutex);
+	return (batch->completedCount == batch->requestCount);
+}
+
+
+int32_t AsyncFileReader::Wait(AsyncReadBatch* batch)
+{
+	if (batch == NULL)
+		return efwErrs::kInvalidInput;
+
+	ScopedLock lock(gAsyncMutex);
+	while (batch->completedCount < batch->requestCount)
+		gAsyncWorkCompleted.Wait(gAsyncMutex);
+
+	int32_t result = efwErrs::kOk;
+	for (int32_t i=0; i<batch->requestCount && result == efwErrs::kOk; ++i)
+		result = batch->entries[i].result;
+	return result;
+}
+
+
+int32_t AsyncFileReader::GetResult(void** outData, uint64_t* outSizeInBytes, AsyncReadBatch* batch, int32_t requestIndex)
+{
+	if (outData == NULL || outSizeInBytes == NULL || batch == NULL || requestIndex < 0 || requestIndex >= batch->requestCount)
+		return efwErrs::kInvalidInput;
+	*outData = NULL;
+	*outSizeInBytes = 0;
+
+	ScopedLock lock(gAsyncMutex);
+	AsyncReadEntry* entry = &batch->entries[requestIndex];
+	if (entry->isClaimed)
+		return efwErrs::kInvalidState;
+
+	return ClaimEntry(outData, outSizeInBytes, entry);
+}
+
+
+void AsyncFileReader::Release(AsyncReadBatch* batch)
+{
+	if (batch == NULL)
+		return;
+
+	ScopedLock lock(gAsyncMutex);
+	while (batch->completedCount < batch->requestCount || batch->waiterCount > 0)
+		gAsyncWorkCompleted.Wait(gAsyncMutex);
+
+	AsyncReadBatch** link = &gAsyncLiveHead;
+	while (*link != NULL && *link != batch)
+		link = &(*link)->nextLive;
+	if (*link != NULL)
+		*link = batch->nextLive;
+
+	for (int32_t i=0; i<batch->requestCount; ++i)
+		EFW_SAFE_ALIGNED_FREE(batch->entries[i].data);
+	freealign(batch);
+}
+
+
+int32_t AsyncFileReader::ReadPrefetched(void** outData, uint64_t* outSizeInBytes, const char* filename, int32_t requiredAlignment)
+{
+	if (outData == NULL || outSizeInBytes == NULL || filename == NULL)
+		return efwErrs::kInvalidInput;
+	if (requiredAlignment <= 0)
+		requiredAlignment = File::kDefaultDataAlignment;
+
+	AsyncReadEntry* entry = NULL;
+	{
+		ScopedLock lock(gAsyncMutex);
+		for (AsyncReadBatch* batch = gAsyncLiveHead; batch != NULL && entry == NULL; batch = batch->nextLive)
+		{
+			for (int32_t i=0; i<batch->requestCount && entry == NULL; ++i)
+			{
+				AsyncReadEntry& candidate = batch->entries[i];
+				bool isAligned = (candidate.requiredAlignment % requiredAlignment) == 0;
+				if (!candidate.isClaimed && isAligned && strcmp(candidate.filename, filename) == 0)
+					entry = &candidate;
+			}
+		}
+
+		if (entry != NULL)
+			return ClaimEntry(outData, outSizeInBytes, entry);
+	}
+
+	// Not prefetched
+	return FileReader::ReadAll(outData, outSizeInBytes, filename, requiredAlignment);
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+/**
+ * Copyright (C) 2012 Bruno P. Evangelista. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "Foundation/efwPlatform.h"
+#include "Foundation/efwFileReader.h"
+
+namespace efw
+{
+	// Called from a worker thread as soon as a request completes. The data is still owned by the batch.
+	typedef void (*AsyncReadCallback_t)(int32_t result, void* data, uint64_t dataSize, const char* filename, void* userData);
+
+	struct AsyncReadRequest
+	{
+		const char* filename;
+		int32_t requiredAlignment;
+		AsyncReadCallback_t callback;			// Optional
+		void* userData;
+	};
+
+	// Completion handle for a batch of submitted requests
+	struct AsyncReadBatch;
+
+	/**
+	 * Batched file loading on the WorkerPool threads. Initialize and Shutdown take and release a pool reference.
+	 * Requests of a batch complete out of order. Completed data stays owned by the batch until claimed with GetResult or 
+	 * ReadPrefetched, and unclaimed data is freed when the batch is released. Release waits for pending requests and for 
+	 * GetResult or ReadPrefetched calls still waiting on the batch, so it is safe to release from another thread.
+	 */
+	namespace AsyncFileReader
+	{
+		int32_t Initialize(int32_t workerCount = 0);
+		void Shutdown();
+
+		int32_t Submit(AsyncReadBatch** outBatch, const AsyncReadRequest* requests, int32_t requestCount, FileReader::ReadFileFunc_t readFileFunc = NULL);
+		bool IsComplete(const AsyncReadBatch* batch);
+		int32_t Wait(AsyncReadBatch* batch);
+		int32_t GetResult(void** outData, uint64_t* outSizeInBytes, AsyncReadBatch* batch, int32_t requestIndex);
+		void Release(AsyncReadBatch* batch);
+
+		/**
+		 * Same signature as FileReader::ReadAll, so it can be used as a ReadFileFunc_t hook.
+		 * Claims the data of a pending or completed request for the same file, waiting for it if needed, or reads the file
+		 * synchronously when it was never submitted.
+		 */
+		int32_t ReadPrefetched(void** outData, uint64_t* outSizeInBytes, const char* filename, int32_t requiredAlignment);
+	}
+
+} // efw
\ No newline at end of file
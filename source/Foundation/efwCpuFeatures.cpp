@@ -0,0 +1,155 @@
+#include "Foundation/efwCpuFeatures.h"
+
+#if defined(EFW_X86)
+#if defined _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+using namespace efw;
+
+// Detected once during static initialization and only read afterwards, so threads can query them without locking
+static bool sIsDetected = false;
+static int32_t sMaxSimdTier = SimdTiers::kAuto;
+static int32_t sSimdTier = SimdTiers::kAuto;
+static uint32_t sFeatures = 0;
+
+
+#if defined(EFW_X86)
+static void Cpuid(uint32_t outRegisters[4], uint32_t leaf, uint32_t subLeaf)
+{
+#if defined _MSC_VER
+	__cpuidex((int*)outRegisters, (int)leaf, (int)subLeaf);
+#else
+	__cpuid_count(leaf, subLeaf, outRegisters[0], outRegisters[1], outRegisters[2], outRegisters[3]);
+#endif
+}
+
+
+static uint64_t GetEnabledXStateFeatures()
+{
+#if defined _MSC_VER
+	return _xgetbv(0);
+#else
+	uint32_t eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((uint64_t)edx << 32) | eax;
+#endif
+}
+#endif
+
+
+static void DetectFeatures()
+{
+	uint32_t features = 0;
+
+#if defined(EFW_X86)
+	uint32_t registers[4];
+	Cpuid(registers, 0, 0);
+	const uint32_t maxLeaf = registers[0];
+
+	Cpuid(registers, 1, 0);
+	const uint32_t ecx1 = registers[2];
+	const uint32_t edx1 = registers[3];
+	features |= (edx1 & (1<<26))? CpuFeatures::kSSE2 : 0;
+	features |= (ecx1 & (1<<9))? CpuFeatures::kSSSE3 : 0;
+	features |= (ecx1 & (1<<19))? CpuFeatures::kSSE41 : 0;
+
+	// AVX registers need OS support, which is reported in XCR0
+	const bool hasOsXSave = (ecx1 & (1<<27)) != 0;
+	const uint64_t xStateFeatures = (hasOsXSave)? GetEnabledXStateFeatures() : 0;
+	const bool hasOsYmm = (xStateFeatures & 0x6) == 0x6;
+	const bool hasOsZmm = (xStateFeatures & 0xE6) == 0xE6;
+
+	if (hasOsYmm)
+	{
+		features |= (ecx1 & (1<<28))? CpuFeatures::kAVX : 0;
+		features |= (ecx1 & (1<<12))? CpuFeatures::kFMA : 0;
+		features |= (ecx1 & (1<<29))? CpuFeatures::kF16C : 0;
+
+		if (maxLeaf >= 7)
+		{
+			Cpuid(registers, 7, 0);
+			const uint32_t ebx7 = registers[1];
+			features |= (ebx7 & (1<<5))? CpuFeatures::kAVX2 : 0;
+			if (hasOsZmm)
+			{
+				features |= (ebx7 & (1<<16))? CpuFeatures::kAVX512F : 0;
+				features |= (ebx7 & (1<<30))? CpuFeatures::kAVX512BW : 0;
+			}
+		}
+	}
+#endif
+
+	int32_t tier = SimdTiers::kScalar;
+	const uint32_t kSSE41Features = CpuFeatures::kSSE2 | CpuFeatures::kSSSE3 | CpuFeatures::kSSE41;
+	const uint32_t kAVX2Features = kSSE41Features | CpuFeatures::kAVX | CpuFeatures::kAVX2 | CpuFeatures::kFMA;
+	const uint32_t kAVX512Features = kAVX2Features | CpuFeatures::kAVX512F | CpuFeatures::kAVX512BW;
+	if ((features & kAVX512Features) == kAVX512Features)
+		tier = SimdTiers::kAVX512;
+	else if ((features & kAVX2Features) == kAVX2Features)
+		tier = SimdTiers::kAVX2;
+	else if ((features & kSSE41Features) == kSSE41Features)
+		tier = SimdTiers::kSSE41;
+
+	sFeatures = features;
+	sMaxSimdTier = tier;
+	if (sSimdTier == SimdTiers::kAuto)
+		sSimdTier = tier;
+	sIsDetected = true;
+}
+
+
+// Static initializers of other files may query features before this one runs, and detect them on the spot
+struct CpuFeatureDetector
+{
+	CpuFeatureDetector()
+	{
+		if (!sIsDetected)
+			DetectFeatures();
+	}
+};
+static CpuFeatureDetector sCpuFeatureDetector;
+
+
+uint32_t Cpu::GetFeatures()
+{
+	if (!sIsDetected)
+		DetectFeatures();
+	return sFeatures;
+}
+
+
+int32_t Cpu::GetMaxSimdTier()
+{
+	if (!sIsDetected)
+		DetectFeatures();
+	return sMaxSimdTier;
+}
+
+
+int32_t Cpu::GetSimdTier()
+{
+	if (!sIsDetected)
+		DetectFeatures();
+	return sSimdTier;
+}
+
+
+int32_t Cpu::ForceSimdTier(int32_t tier)
+{
+	const int32_t maxTier = GetMaxSimdTier();
+	if (tier == SimdTiers::kAuto)
+	{
+		sSimdTier = maxTier;
+		return efwErrs::kOk;
+	}
+
+	if (tier < SimdTiers::kScalar || tier > maxTier)
+		return efwErrs::kInvalidInput;
+
+	sSimdTier = tier;
+	return efwErrs::kOk;
+}
\ No newline at end of file
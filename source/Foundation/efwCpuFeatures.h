@@ -0,0 +1,61 @@
+/**
+ * Copyright (C) 2012 Bruno P. Evangelista. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "Foundation/efwPlatform.h"
+
+namespace efw
+{
+
+	namespace CpuFeatures
+	{
+		const uint32_t kSSE2			= 1<<0;
+		const uint32_t kSSSE3			= 1<<1;
+		const uint32_t kSSE41			= 1<<2;
+		const uint32_t kAVX				= 1<<3;
+		const uint32_t kAVX2			= 1<<4;
+		const uint32_t kFMA				= 1<<5;
+		const uint32_t kF16C			= 1<<6;
+		const uint32_t kAVX512F			= 1<<7;
+		const uint32_t kAVX512BW		= 1<<8;
+	}
+
+	/**
+	 * Instruction set tiers that SIMD kernels are written for. Kernels bind to the best implementation at or below the 
+	 * current tier, so hosts above the widest kernel use it.
+	 */
+	namespace SimdTiers
+	{
+		const int32_t kAuto		= -1;
+		const int32_t kScalar	= 0;
+		const int32_t kSSE41	= 1;		// SSE2, SSSE3 and SSE4.1
+		const int32_t kAVX2		= 2;		// AVX, AVX2 and FMA with OS support for YMM registers
+		const int32_t kAVX512	= 3;		// AVX-512F and BW with OS support for ZMM registers
+	}
+
+	namespace Cpu
+	{
+		// Features are detected with cpuid during static initialization, and may be queried from any thread
+		uint32_t GetFeatures();
+		int32_t GetMaxSimdTier();
+		int32_t GetSimdTier();
+
+		/**
+		 * Forces kernels to a lower tier, mainly to test every implementation on one host. kAuto restores the detected tier. 
+		 * Call it before starting worker threads.
+		 */
+		int32_t ForceSimdTier(int32_t tier);
+	}
+
+} // efw
\ No newline at end of file
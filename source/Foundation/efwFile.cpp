@@ -18,6 +18,7 @@ int32_t File::GetInfo(FileInfo* outFileInfo, const char* filename)
 	{
 		outFileInfo->exists = true;
 		outFileInfo->size = (size_t)fileStats.st_size;
+		outFileInfo->modificationTime = (uint64_t)fileStats.st_mtime;
 		return efwErrs::kOk;
 	}
 
@@ -20,6 +20,7 @@ namespace efw
 	struct FileInfo
 	{
 		size_t size;
+		uint64_t modificationTime;				// Seconds since the epoch
 		bool exists;
 	};
 
@@ -1,6 +1,14 @@
 #include "Foundation/efwFileReader.h"
 #include "Math/efwMath.h"
 
+#if defined _MSC_VER
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined __GNUC__
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
 using namespace efw;
 
 int32_t FileReader::Read(void* outData, uint64_t outSizeInBytes, const char* filename)
@@ -63,4 +71,174 @@ int32_t FileReader::ReadAll(void** outData, uint64_t* outSizeInBytes, const char
 	*outSizeInBytes = fileSize;
 	
 	return result;
+}
+
+
+static int32_t MapByCopy(MappedFile* outMappedFile, const char* filename, int32_t requiredAlignment)
+{
+	FileInfo fileInfo;
+	File::GetInfo(&fileInfo, filename);
+	if (fileInfo.size == 0)
+		return efwErrs::kInvalidInput;
+
+	// Zero the padding so the copy behaves as the mapped view
+	size_t allocationSize = fileInfo.size + FileReader::kMappedFilePadding;
+	uint8_t* fileData = (uint8_t*)memalign(requiredAlignment, allocationSize);
+	if (fileData == NULL)
+		return efwErrs::kOperationFailed;
+	memset(fileData + fileInfo.size, 0, FileReader::kMappedFilePadding);
+
+	int32_t result = FileReader::Read(fileData, fileInfo.size, filename);
+	if (result != efwErrs::kOk)
+	{
+		freealign(fileData);
+		return result;
+	}
+
+	outMappedFile->data = fileData;
+	outMappedFile->size = fileInfo.size;
+	outMappedFile->isMapped = false;
+	outMappedFile->mappedAddress = fileData;
+	outMappedFile->mappedSize = allocationSize;
+	return efwErrs::kOk;
+}
+
+
+int32_t FileReader::Map(MappedFile* outMappedFile, const char* filename, int32_t mapHints, int32_t requiredAlignment)
+{
+	if (outMappedFile == NULL || filename == NULL)
+		return efwErrs::kInvalidInput;
+	memset(outMappedFile, 0, sizeof(MappedFile));
+
+#if defined _MSC_VER
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	uint64_t pageSize = systemInfo.dwPageSize;
+
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return efwErrs::kInvalidInput;
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	uint64_t size = (uint64_t)fileSize.QuadPart;
+
+	// The view is only zero padded up to the end of its last page
+	uint64_t pageTail = EFW_ALIGN(pageSize, size) - size;
+	if (size == 0 || pageTail < (uint64_t)kMappedFilePadding || (uint64_t)requiredAlignment > pageSize)
+	{
+		CloseHandle(file);
+		return MapByCopy(outMappedFile, filename, requiredAlignment);
+	}
+
+	bool isCopyOnWrite = (mapHints & FileMapHints::kCopyOnWrite) != 0;
+	HANDLE mapping = CreateFileMappingA(file, NULL, isCopyOnWrite? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (mapping == NULL)
+		return MapByCopy(outMappedFile, filename, requiredAlignment);
+
+	void* view = MapViewOfFile(mapping, isCopyOnWrite? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL)
+	{
+		CloseHandle(mapping);
+		return MapByCopy(outMappedFile, filename, requiredAlignment);
+	}
+
+	outMappedFile->data = view;
+	outMappedFile->size = size;
+	outMappedFile->isMapped = true;
+	outMappedFile->mappedAddress = view;
+	outMappedFile->mappedSize = size;
+	outMappedFile->mappingHandle = (uintptr_t)mapping;
+
+#elif defined __GNUC__
+	uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+
+	int fileDescriptor = open(filename, O_RDONLY);
+	if (fileDescriptor < 0)
+		return efwErrs::kInvalidInput;
+
+	struct stat fileStats;
+	if (fstat(fileDescriptor, &fileStats) != 0 || fileStats.st_size == 0 || (uint64_t)requiredAlignment > pageSize)
+	{
+		close(fileDescriptor);
+		return MapByCopy(outMappedFile, filename, requiredAlignment);
+	}
+	uint64_t size = (uint64_t)fileStats.st_size;
+
+	// Reserve the view plus padding as zeroed anonymous pages, then map the file over its start
+	uint64_t reserveSize = EFW_ALIGN(pageSize, size + kMappedFilePadding);
+	void* reserved = mmap(NULL, (size_t)reserveSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	void* view = MAP_FAILED;
+	if (reserved != MAP_FAILED)
+	{
+		int protection = ((mapHints & FileMapHints::kCopyOnWrite) != 0)? (PROT_READ | PROT_WRITE) : PROT_READ;
+		view = mmap(reserved, (size_t)size, protection, MAP_PRIVATE | MAP_FIXED, fileDescriptor, 0);
+		if (view == MAP_FAILED)
+			munmap(reserved, (size_t)reserveSize);
+	}
+	close(fileDescriptor);
+
+	if (view == MAP_FAILED)
+		return MapByCopy(outMappedFile, filename, requiredAlignment);
+
+	outMappedFile->data = view;
+	outMappedFile->size = size;
+	outMappedFile->isMapped = true;
+	outMappedFile->mappedAddress = view;
+	outMappedFile->mappedSize = reserveSize;
+#endif
+
+	Advise(*outMappedFile, mapHints);
+	return efwErrs::kOk;
+}
+
+
+void FileReader::Advise(const MappedFile& mappedFile, int32_t mapHints)
+{
+	if (!mappedFile.isMapped || mapHints == FileMapHints::kNone)
+		return;
+
+#if defined __GNUC__
+	if ((mapHints & FileMapHints::kSequential) != 0)
+		madvise(mappedFile.mappedAddress, (size_t)mappedFile.size, MADV_SEQUENTIAL);
+	if ((mapHints & FileMapHints::kRandom) != 0)
+		madvise(mappedFile.mappedAddress, (size_t)mappedFile.size, MADV_RANDOM);
+	if ((mapHints & FileMapHints::kWillNeed) != 0)
+		madvise(mappedFile.mappedAddress, (size_t)mappedFile.size, MADV_WILLNEED);
+#elif defined _MSC_VER
+	// Views have no access pattern hints, but they can be paged in ahead (PrefetchVirtualMemory needs Windows 8)
+#if defined(_WIN32_WINNT_WIN8) && _WIN32_WINNT >= _WIN32_WINNT_WIN8
+	if ((mapHints & FileMapHints::kWillNeed) != 0)
+	{
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = mappedFile.mappedAddress;
+		range.NumberOfBytes = (SIZE_T)mappedFile.size;
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+#endif
+#endif
+}
+
+
+void FileReader::Unmap(MappedFile* mappedFile)
+{
+	if (mappedFile == NULL || mappedFile->mappedAddress == NULL)
+		return;
+
+	if (!mappedFile->isMapped)
+	{
+		freealign(mappedFile->mappedAddress);
+	}
+	else
+	{
+#if defined _MSC_VER
+		UnmapViewOfFile(mappedFile->mappedAddress);
+		CloseHandle((HANDLE)mappedFile->mappingHandle);
+#elif defined __GNUC__
+		munmap(mappedFile->mappedAddress, (size_t)mappedFile->mappedSize);
+#endif
+	}
+
+	memset(mappedFile, 0, sizeof(MappedFile));
 }
\ No newline at end of file
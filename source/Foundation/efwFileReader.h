@@ -18,10 +18,45 @@
 
 namespace efw
 {
+	namespace FileMapHints
+	{
+		const int32_t kNone = 0;
+		const int32_t kSequential = 1 << 0;		// Data will be read once from start to end
+		const int32_t kRandom = 1 << 1;			// Data will be accessed in random order, disables read-ahead
+		const int32_t kWillNeed = 1 << 2;		// Start paging in the whole file right away
+		const int32_t kCopyOnWrite = 1 << 3;	// View is writable, changes are private and never written back to the file
+	}
+
+	/**
+	 * Read-only (or copy-on-write) view of a whole file.
+	 * The view is followed by at least FileReader::kMappedFilePadding zeroed bytes, so text parsers can rely on a '\0' terminator.
+	 * When the file can't be mapped (or the platform can't honor the padding) the data is copied into memory instead.
+	 */
+	struct MappedFile
+	{
+		const void* data;
+		uint64_t size;
+
+		// Internal
+		bool isMapped;
+		void* mappedAddress;
+		uint64_t mappedSize;
+		uintptr_t mappingHandle;
+	};
+
 	namespace FileReader
 	{
+		const int32_t kMappedFilePadding = 64;
+
+		// Read file function declaration, matches ReadAll
+		typedef int32_t (*ReadFileFunc_t)(void** outData, uint64_t* outSize, const char* filename, int32_t requiredAlignment);
+
 		int32_t Read(void* outData, uint64_t outDataSizeInBytes, const char* filename);
 		int32_t ReadAll(void** outData, uint64_t* outSizeInBytes, const char* filename, int32_t requiredAlignment = File::kDefaultDataAlignment);
+
+		int32_t Map(MappedFile* outMappedFile, const char* filename, int32_t mapHints = FileMapHints::kSequential, int32_t requiredAlignment = File::kDefaultDataAlignment);
+		void Advise(const MappedFile& mappedFile, int32_t mapHints);
+		void Unmap(MappedFile* mappedFile);
 	}
 
 } // efw
\ No newline at end of file
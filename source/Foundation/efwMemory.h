@@ -112,6 +112,23 @@ inline int64_t efwHash64(const void* data, int32_t sizeInBytes)
 }
 
 
+// Continues a hash of previous data, so data of any size can be hashed in pieces
+inline int64_t efwHash64(const void* data, uint64_t sizeInBytes, int64_t previousHash)
+{
+	EFW_ASSERT(data != NULL);
+
+	int64_t h = previousHash;
+	const uint8_t* dataU8 = (const uint8_t*)data;
+
+	for (uint64_t i=0; i < sizeInBytes; i++)
+	{
+		h = (h * kHashEncodeMul) ^ kHashEncodeTable[ dataU8[i] ];
+	}
+
+	return h;
+}
+
+
 inline int64_t efwHash64(const char* str)
 {
 	EFW_ASSERT(str != NULL);
@@ -0,0 +1,170 @@
+#include "Foundation/efwPackageWriter.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace efw;
+
+struct PackageResource
+{
+	uint64_t guid;
+	uint32_t resourceType;
+	uint32_t dataSize;
+	int32_t alignment;
+	size_t dataStart;
+	size_t pointerOffsetStart;
+	int32_t pointerOffsetCount;
+};
+
+struct efw::PackageContent
+{
+	std::vector<PackageResource> resources;
+	std::vector<uint8_t> data;
+	std::vector<uint32_t> pointerOffsets;
+};
+
+
+int32_t PackageWriter::Create(PackageContent** outContent)
+{
+	if (outContent == NULL)
+		return efwErrs::kInvalidInput;
+
+	*outContent = new PackageContent();
+	return efwErrs::kOk;
+}
+
+
+void PackageWriter::Destroy(PackageContent** content)
+{
+	if (content == NULL)
+		return;
+
+	delete *content;
+	*content = NULL;
+}
+
+
+int32_t PackageWriter::AddResource(PackageContent* content, uint64_t guid, uint32_t resourceType, const void* data, uint32_t dataSize, 
+	const uint32_t* pointerOffsets, int32_t pointerOffsetCount, int32_t alignment)
+{
+	if (content == NULL || guid == ResourceTable::kEmptyGuid || (data == NULL && dataSize > 0) || 
+		resourceType >= ResourceTypes::kCount)
+		return efwErrs::kInvalidInput;
+	if (pointerOffsetCount > 0 && pointerOffsets == NULL)
+		return efwErrs::kInvalidInput;
+	if (alignment <= 0 || alignment > PackageFormat::kMaxDataAlignment || (alignment & (alignment-1)) != 0)
+		return efwErrs::kInvalidInput;
+
+	for (int32_t i=0; i<pointerOffsetCount; ++i)
+	{
+		if ((uint64_t)pointerOffsets[i] + sizeof(uintptr_t) > dataSize)
+			return efwErrs::kInvalidInput;
+	}
+
+	PackageResource resource;
+	resource.guid = guid;
+	resource.resourceType = resourceType;
+	resource.dataSize = dataSize;
+	resource.alignment = alignment;
+	resource.dataStart = content->data.size();
+	resource.pointerOffsetStart = content->pointerOffsets.size();
+	resource.pointerOffsetCount = pointerOffsetCount;
+	content->resources.push_back(resource);
+
+	content->data.insert(content->data.end(), (const uint8_t*)data, (const uint8_t*)data + dataSize);
+	content->pointerOffsets.insert(content->pointerOffsets.end(), pointerOffsets, pointerOffsets + pointerOffsetCount);
+
+	return efwErrs::kOk;
+}
+
+
+struct PackageResourceTypeSort
+{
+	const std::vector<PackageResource>* resources;
+	bool operator () (int32_t a, int32_t b) const { return (*resources)[a].resourceType < (*resources)[b].resourceType; }
+};
+
+
+int32_t PackageWriter::WriteToFile(const PackageContent* content, uint64_t packageId, const char* filePath)
+{
+	if (content == NULL || filePath == NULL)
+		return efwErrs::kInvalidInput;
+
+	// Sort resources by type, keeping the order they were added in
+	const int32_t resourceCount = (int32_t)content->resources.size();
+	std::vector<int32_t> sortedResources(resourceCount);
+	for (int32_t i=0; i<resourceCount; ++i)
+		sortedResources[i] = i;
+	PackageResourceTypeSort typeSort = { &content->resources };
+	std::stable_sort(sortedResources.begin(), sortedResources.end(), typeSort);
+
+	// Layout: header, resource descs, relocation table, then the data of each type group
+	const uint64_t relocationCount = content->pointerOffsets.size();
+	const uint64_t headerSize = sizeof(PackageHeader) + resourceCount * sizeof(ResourceDesc);
+	const uint64_t relocationTableOffset = EFW_ALIGN(8, headerSize);
+
+	uint64_t currentOffset = relocationTableOffset + relocationCount * sizeof(uint64_t);
+	std::vector<uint64_t> resourceOffsets(resourceCount);
+	for (int32_t i=0; i<resourceCount; ++i)
+	{
+		const PackageResource& resource = content->resources[sortedResources[i]];
+		currentOffset = EFW_ALIGN((uint64_t)resource.alignment, currentOffset);
+		resourceOffsets[i] = currentOffset;
+		currentOffset += resource.dataSize;
+	}
+	const uint64_t fileSize = currentOffset;
+
+	std::vector<uint8_t> fileData((size_t)fileSize, 0);
+	PackageHeader* header = (PackageHeader*)&fileData[0];
+	uint64_t* relocationTable = (uint64_t*)&fileData[(size_t)relocationTableOffset];
+
+	header->signature = PackageFormat::kSignature;
+	header->version = PackageFormat::kVersion;
+	header->pointerSize = sizeof(uintptr_t);
+	header->id = packageId;
+	header->resourceCount = resourceCount;
+	header->relocationCount = (uint32_t)relocationCount;
+	header->relocationTableOffset = relocationTableOffset;
+
+	uint32_t relocationIndex = 0;
+	for (int32_t i=0; i<resourceCount; ++i)
+	{
+		const PackageResource& resource = content->resources[sortedResources[i]];
+		uint8_t* resourceData = &fileData[(size_t)resourceOffsets[i]];
+		if (resource.dataSize > 0)
+			memcpy(resourceData, &content->data[resource.dataStart], resource.dataSize);
+
+		// Pointers are stored relative to the resource, rebase them to the package start
+		for (int32_t j=0; j<resource.pointerOffsetCount; ++j)
+		{
+			uint32_t pointerOffset = content->pointerOffsets[resource.pointerOffsetStart + j];
+			uintptr_t* pointer = (uintptr_t*)(resourceData + pointerOffset);
+			*pointer += (uintptr_t)resourceOffsets[i];
+			relocationTable[relocationIndex++] = resourceOffsets[i] + pointerOffset;
+		}
+
+		ResourceDesc& desc = header->resourceDesc[i];
+		desc.guid = resource.guid;
+		desc.resourceType = resource.resourceType;
+		desc.dataOffset = (uintptr_t)resourceOffsets[i];
+		desc.dataSize = resource.dataSize;
+
+		ResourceTypeGroup& group = header->resourceTypeGroup[resource.resourceType];
+		if (group.resourceDescCount == 0)
+		{
+			group.resourceDescStartIndex = i;
+			group.resourceDataOffsetInBytes = resourceOffsets[i];
+		}
+		group.resourceDescCount++;
+		group.resourceDataSize = (resourceOffsets[i] + resource.dataSize) - group.resourceDataOffsetInBytes;
+	}
+
+	FILE* file = fopen(filePath, "wb");
+	if (file == NULL)
+		return efwErrs::kInvalidInput;
+
+	size_t writtenBytes = fwrite(&fileData[0], 1, (size_t)fileSize, file);
+	fclose(file);
+
+	return (writtenBytes == fileSize)? efwErrs::kOk : efwErrs::kOperationFailed;
+}
\ No newline at end of file
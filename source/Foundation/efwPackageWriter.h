@@ -0,0 +1,43 @@
+/**
+ * Copyright (C) 2012 Bruno P. Evangelista. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "Foundation/efwPlatform.h"
+#include "Foundation/efwResourceManager.h"
+
+namespace efw
+{
+	// Resources added to a package, kept in memory until written
+	struct PackageContent;
+
+	namespace PackageWriter
+	{
+		int32_t Create(PackageContent** outContent);
+		void Destroy(PackageContent** content);
+
+		/**
+		 * Copies one resource into the package content.
+		 * 
+		 * @param guid Resource guid, ResourceTable::kEmptyGuid is reserved and rejected.
+		 * @param data Resource data. Pointers inside it must be stored as offsets from the start of the data.
+		 * @param pointerOffsets Offsets from the start of the data to each uintptr_t that must become a pointer once loaded.
+		 * @param alignment Required alignment of the data once loaded, up to PackageFormat::kMaxDataAlignment.
+		 */
+		int32_t AddResource(PackageContent* content, uint64_t guid, uint32_t resourceType, const void* data, uint32_t dataSize, 
+			const uint32_t* pointerOffsets = NULL, int32_t pointerOffsetCount = 0, int32_t alignment = PackageFormat::kDefaultDataAlignment);
+
+		int32_t WriteToFile(const PackageContent* content, uint64_t packageId, const char* filePath);
+	}
+
+} // efw
\ No newline at end of file
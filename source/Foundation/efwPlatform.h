@@ -63,6 +63,18 @@ EFW_INLINE void freealign(void* address) { free(address); }
 #define NULL 0L
 #endif
 
+// x86 targets can select SIMD kernels at runtime, see efwCpuFeatures.h
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define EFW_X86
+#endif
+
+// Compiles a function for an instruction set above the build baseline. MSVC accepts intrinsics without it.
+#if defined __GNUC__
+#define EFW_TARGET_ISA(_ISA) __attribute__((target(_ISA)))
+#else
+#define EFW_TARGET_ISA(_ISA)
+#endif
+
 template <bool test> struct EFW_STATIC_ASSERT_FAILED;
 template <> struct EFW_STATIC_ASSERT_FAILED<true> { enum { value = 1}; };
 template <int value> struct EFW_STATIC_ASSERT_DUMMY_STRUCT;
@@ -126,6 +138,7 @@ namespace efwErrs
 	const int32_t kInvalidInput = 2;
 	const int32_t kInvalidState = 3;
 	const int32_t kOperationFailed = 4;
+	const int32_t kOutOfMemory = 5;
 }
 
 namespace efw
@@ -0,0 +1,280 @@
+#include "Foundation/efwResourceManager.h"
+#include "Foundation/efwFileReader.h"
+
+using namespace efw;
+
+struct OpenedPackage
+{
+	MappedFile mappedFile;
+	PackageHeader* header;
+};
+
+static OpenedPackage gOpenedPackages[ResourceLoader::kMaxOpenPackages];
+// Maps the guid of every resource in the opened packages to its ResourceDesc
+static ResourceTable gResourceTable;
+
+
+static int32_t FindOpenedPackage(uint64_t packageId)
+{
+	for (int32_t i=0; i<ResourceLoader::kMaxOpenPackages; ++i)
+	{
+		if (gOpenedPackages[i].header != NULL && gOpenedPackages[i].header->id == packageId)
+			return i;
+	}
+	return -1;
+}
+
+
+static int32_t ValidateAndRelocate(uint8_t* packageData, uint64_t packageSize)
+{
+	if (packageSize < sizeof(PackageHeader))
+		return efwErrs::kCorruptedData;
+
+	PackageHeader* header = (PackageHeader*)packageData;
+	if (header->signature != PackageFormat::kSignature || header->version != PackageFormat::kVersion || 
+		header->pointerSize != sizeof(uintptr_t))
+		return efwErrs::kCorruptedData;
+
+	// Ranges are checked as offset > size || count > size - offset, so huge values can't wrap around the checks
+	uint64_t headerSize = sizeof(PackageHeader) + (uint64_t)header->resourceCount * sizeof(ResourceDesc);
+	uint64_t relocationTableSize = (uint64_t)header->relocationCount * sizeof(uint64_t);
+	if (headerSize > packageSize || header->relocationTableOffset < headerSize || 
+		header->relocationTableOffset > packageSize || relocationTableSize > packageSize - header->relocationTableOffset ||
+		(header->relocationTableOffset & (sizeof(uint64_t)-1)) != 0)
+		return efwErrs::kCorruptedData;
+	uint64_t relocationTableEnd = header->relocationTableOffset + relocationTableSize;
+
+	for (int32_t i=0; i<ResourceTypes::kCount; ++i)
+	{
+		const ResourceTypeGroup& group = header->resourceTypeGroup[i];
+		if (group.resourceDescStartIndex > header->resourceCount || 
+			group.resourceDescCount > header->resourceCount - group.resourceDescStartIndex)
+			return efwErrs::kCorruptedData;
+	}
+
+	// Validate everything before touching the data, a corrupted package must be left untouched
+	for (uint32_t i=0; i<header->resourceCount; ++i)
+	{
+		const ResourceDesc& desc = header->resourceDesc[i];
+		if (desc.resourceType >= ResourceTypes::kCount || desc.dataOffset < relocationTableEnd || 
+			desc.dataOffset > packageSize || desc.dataSize > packageSize - desc.dataOffset)
+			return efwErrs::kCorruptedData;
+	}
+
+	const uint64_t* relocationTable = (const uint64_t*)(packageData + header->relocationTableOffset);
+	for (uint32_t i=0; i<header->relocationCount; ++i)
+	{
+		uint64_t pointerOffset = relocationTable[i];
+		if (pointerOffset < relocationTableEnd || pointerOffset > packageSize - sizeof(uintptr_t) || 
+			(pointerOffset & (sizeof(uintptr_t)-1)) != 0)
+			return efwErrs::kCorruptedData;
+		if (*(const uintptr_t*)(packageData + pointerOffset) > packageSize)
+			return efwErrs::kCorruptedData;
+	}
+
+	// Fix up offsets into pointers
+	for (uint32_t i=0; i<header->resourceCount; ++i)
+		header->resourceDesc[i].dataOffset += (uintptr_t)packageData;
+
+	for (uint32_t i=0; i<header->relocationCount; ++i)
+		*(uintptr_t*)(packageData + relocationTable[i]) += (uintptr_t)packageData;
+
+	return efwErrs::kOk;
+}
+
+
+static void RemovePackageResources(const PackageHeader* header, uint32_t resourceCount)
+{
+	for (uint32_t i=0; i<resourceCount; ++i)
+		gResourceTable.Remove(header->resourceDesc[i].guid);
+}
+
+
+static int32_t AddPackageResources(const PackageHeader* header)
+{
+	int32_t result = gResourceTable.Reserve(gResourceTable.GetCount() + header->resourceCount);
+	if (result != efwErrs::kOk)
+		return result;
+
+	for (uint32_t i=0; i<header->resourceCount; ++i)
+	{
+		const ResourceDesc& desc = header->resourceDesc[i];
+		result = gResourceTable.Insert(desc.guid, (uintptr_t)&desc);
+		if (result != efwErrs::kOk)
+		{
+			RemovePackageResources(header, i);
+			return result;
+		}
+	}
+
+	return efwErrs::kOk;
+}
+
+
+int32_t ResourceLoader::OpenPackage(uint64_t* outPackageId, const char* filePath)
+{
+	if (filePath == NULL)
+		return efwErrs::kInvalidInput;
+
+	int32_t freeSlot = -1;
+	for (int32_t i=0; i<kMaxOpenPackages && freeSlot < 0; ++i)
+	{
+		if (gOpenedPackages[i].header == NULL)
+			freeSlot = i;
+	}
+	if (freeSlot < 0)
+		return efwErrs::kInvalidState;
+
+	// Mapped as copy-on-write, only the pages holding relocated pointers get copied
+	MappedFile mappedFile;
+	int32_t result = FileReader::Map(&mappedFile, filePath, FileMapHints::kSequential | FileMapHints::kCopyOnWrite, 
+		PackageFormat::kMaxDataAlignment);
+	if (result != efwErrs::kOk)
+		return result;
+
+	uint8_t* packageData = (uint8_t*)mappedFile.data;
+	if (mappedFile.size >= sizeof(PackageHeader) && FindOpenedPackage(((PackageHeader*)packageData)->id) >= 0)
+		result = efwErrs::kInvalidState;
+	else
+		result = ValidateAndRelocate(packageData, mappedFile.size);
+
+	if (result == efwErrs::kOk)
+		result = AddPackageResources((const PackageHeader*)packageData);
+
+	if (result != efwErrs::kOk)
+	{
+		FileReader::Unmap(&mappedFile);
+		return result;
+	}
+
+	// Relocation is done, the package is read from now on
+	FileReader::Advise(mappedFile, FileMapHints::kRandom);
+
+	OpenedPackage& package = gOpenedPackages[freeSlot];
+	package.mappedFile = mappedFile;
+	package.header = (PackageHeader*)packageData;
+
+	if (outPackageId != NULL)
+		*outPackageId = package.header->id;
+	return efwErrs::kOk;
+}
+
+
+int32_t ResourceLoader::ClosePackage(uint64_t packageId)
+{
+	int32_t slot = FindOpenedPackage(packageId);
+	if (slot < 0)
+		return efwErrs::kInvalidInput;
+
+	OpenedPackage& package = gOpenedPackages[slot];
+	RemovePackageResources(package.header, package.header->resourceCount);
+	FileReader::Unmap(&package.mappedFile);
+	package.header = NULL;
+
+	return efwErrs::kOk;
+}
+
+
+int32_t ResourceLoader::CloseAllPackages()
+{
+	for (int32_t i=0; i<kMaxOpenPackages; ++i)
+	{
+		OpenedPackage& package = gOpenedPackages[i];
+		if (package.header != NULL)
+		{
+			FileReader::Unmap(&package.mappedFile);
+			package.header = NULL;
+		}
+	}
+	gResourceTable.Clear();
+
+	return efwErrs::kOk;
+}
+
+
+int32_t ResourceManager::GetAllByType(HandleSet** outHandleSet, int32_t resourceType)
+{
+	if (outHandleSet == NULL || resourceType < 0 || resourceType >= ResourceTypes::kCount)
+		return efwErrs::kInvalidInput;
+
+	uint64_t handleCount = 0;
+	for (int32_t i=0; i<ResourceLoader::kMaxOpenPackages; ++i)
+	{
+		if (gOpenedPackages[i].header != NULL)
+			handleCount += gOpenedPackages[i].header->resourceTypeGroup[resourceType].resourceDescCount;
+	}
+
+	HandleSet* handleSet = (HandleSet*)memalign(16, sizeof(HandleSet) + (size_t)handleCount * sizeof(Handle));
+	if (handleSet == NULL)
+		return efwErrs::kOperationFailed;
+
+	// Handle table index is the package slot in the high 32 bits and the resource desc index in the low 32 bits
+	int32_t handleIndex = 0;
+	for (int32_t i=0; i<ResourceLoader::kMaxOpenPackages; ++i)
+	{
+		const PackageHeader* header = gOpenedPackages[i].header;
+		if (header == NULL)
+			continue;
+
+		const ResourceTypeGroup& group = header->resourceTypeGroup[resourceType];
+		for (uint64_t j=group.resourceDescStartIndex; j<group.resourceDescStartIndex+group.resourceDescCount; ++j)
+		{
+			Handle& handle = handleSet->handles[handleIndex++];
+			handle.tableIndex = ((uint64_t)i << 32) | j;
+			handle.guid = header->resourceDesc[j].guid;
+		}
+	}
+	handleSet->count = handleIndex;
+
+	*outHandleSet = handleSet;
+	return efwErrs::kOk;
+}
+
+
+void ResourceManager::ReleaseHandleSet(HandleSet** handleSet)
+{
+	if (handleSet != NULL)
+		EFW_SAFE_ALIGNED_FREE(*handleSet);
+}
+
+
+int32_t ResourceManager::GetData(void** outData, uint32_t* outDataSize, const Handle& handle)
+{
+	if (outData == NULL)
+		return efwErrs::kInvalidInput;
+
+	uint64_t slot = handle.tableIndex >> 32;
+	uint64_t descIndex = handle.tableIndex & 0xFFFFFFFF;
+	if (slot >= ResourceLoader::kMaxOpenPackages)
+		return efwErrs::kInvalidInput;
+
+	// Handles outlive their package, make sure the slot wasn't closed or reused
+	const PackageHeader* header = gOpenedPackages[slot].header;
+	if (header == NULL || descIndex >= header->resourceCount || header->resourceDesc[descIndex].guid != handle.guid)
+		return efwErrs::kInvalidState;
+
+	const ResourceDesc& desc = header->resourceDesc[descIndex];
+	*outData = (void*)desc.dataOffset;
+	if (outDataSize != NULL)
+		*outDataSize = desc.dataSize;
+
+	return efwErrs::kOk;
+}
+
+
+int32_t ResourceManager::FindByGuid(void** outData, uint32_t* outDataSize, uint64_t guid)
+{
+	if (outData == NULL)
+		return efwErrs::kInvalidInput;
+
+	const ResourceEntry* entry = gResourceTable.Find(guid);
+	if (entry == NULL)
+		return efwErrs::kInvalidInput;
+
+	const ResourceDesc& desc = *(const ResourceDesc*)entry->resourceOffset;
+	*outData = (void*)desc.dataOffset;
+	if (outDataSize != NULL)
+		*outDataSize = desc.dataSize;
+
+	return efwErrs::kOk;
+}
\ No newline at end of file
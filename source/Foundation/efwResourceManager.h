@@ -14,6 +14,8 @@
 #pragma once
 
 #include "Foundation/efwPlatform.h"
+#include "Foundation/efwGuid.h"
+#include "Foundation/efwResourceTable.h"
 
 namespace efw
 {
@@ -25,19 +27,19 @@ namespace efw
 			kTexture,
 			kMaterial,
 			kMesh,
+			kModel,
 			kCount
 		};
 	}
 
 
-	struct PackageHeader
+	namespace PackageFormat
 	{
-		uint64_t id;
-		uint32_t resourceCount;
-
-		ResourceTypeGroup resourceTypeGroup[ResourceTypes::kCount];
-		ResourceDesc resourceDesc[0];
-	};
+		const uint32_t kSignature = 0x50574645;	// "EFWP"
+		const uint16_t kVersion = 2;
+		const int32_t kDefaultDataAlignment = 16;
+		const int32_t kMaxDataAlignment = 4096;
+	}
 
 
 	struct ResourceTypeGroup
@@ -53,29 +55,50 @@ namespace efw
 	{
 		uint64_t guid;
 		uint32_t resourceType;
-		uintptr_t dataOffset;
+		uintptr_t dataOffset;					// Offset from the package start on disk, pointer to the data once loaded
 		uint32_t dataSize;
 	};
 
 
+	/**
+	 * Packages are loaded in place: the file is mapped, and every pointer inside it is stored as an offset from the package 
+	 * start and listed in the relocation table, so it can be fixed up in place without any per-resource allocation.
+	 * Resources are sorted by type, and the data of each type is stored contiguously.
+	 */
+	struct PackageHeader
+	{
+		uint32_t signature;
+		uint16_t version;
+		uint16_t pointerSize;
+		uint64_t id;
+		uint32_t resourceCount;
+		uint32_t relocationCount;
+		uint64_t relocationTableOffset;		// Table of uint64_t offsets to each uintptr_t that must be fixed up
+
+		ResourceTypeGroup resourceTypeGroup[ResourceTypes::kCount];
+		ResourceDesc resourceDesc[];
+	};
+
+
 	namespace ResourceLoader
 	{
-		int32_t OpenPackage(const char* filePath);
+		const int32_t kMaxOpenPackages = 64;
+
+		// Fails with efwErrs::kInvalidState if the package, or any resource guid in it, is already opened
+		int32_t OpenPackage(uint64_t* outPackageId, const char* filePath);
 		
-		int32_t ClosePackage();
+		int32_t ClosePackage(uint64_t packageId);
 		int32_t CloseAllPackages();
 	}
 
 
-	struct ResourceEntry
-	{
-		uint64_t guid;
-		uintptr_t resourceOffset;
-	};
-
-
 	namespace ResourceManager
 	{
 		int32_t GetAllByType(HandleSet** outHandleSet, int32_t resourceType);
+		void ReleaseHandleSet(HandleSet** handleSet);
+
+		int32_t GetData(void** outData, uint32_t* outDataSize, const Handle& handle);
+		// Looks up a resource of any opened package by its guid, in constant time
+		int32_t FindByGuid(void** outData, uint32_t* outDataSize, uint64_t guid);
 	}
 }
@@ -0,0 +1,192 @@
+#include "Foundation/efwResourceTable.h"
+
+using namespace efw;
+
+// Guids made from random seeds or short names don't spread well in their low bits, mix them before masking
+static EFW_INLINE uint32_t HashGuid(uint64_t guid)
+{
+	guid ^= guid >> 33;
+	guid *= 0xff51afd7ed558ccdULL;
+	guid ^= guid >> 33;
+	guid *= 0xc4ceb9fe1a85ec53ULL;
+	guid ^= guid >> 33;
+	return (uint32_t)guid;
+}
+
+
+// Keeps the load factor under 3/4
+static EFW_INLINE uint32_t GetRequiredCapacity(uint32_t entryCount)
+{
+	uint64_t requiredCapacity = ((uint64_t)entryCount * 4 + 2) / 3;
+	uint64_t capacity = ResourceTable::kMinCapacity;
+	while (capacity < requiredCapacity)
+		capacity <<= 1;
+	return (capacity <= 0x80000000)? (uint32_t)capacity : 0;
+}
+
+
+ResourceTable::ResourceTable() :
+	mEntries(NULL),
+	mCapacity(0),
+	mCount(0)
+{
+}
+
+
+ResourceTable::~ResourceTable()
+{
+	EFW_SAFE_ALIGNED_FREE(mEntries);
+}
+
+
+int32_t ResourceTable::Reserve(uint32_t entryCount)
+{
+	uint32_t newCapacity = GetRequiredCapacity(entryCount);
+	if (newCapacity == 0)
+		return efwErrs::kInvalidInput;
+
+	if (newCapacity <= mCapacity)
+		return efwErrs::kOk;
+
+	return Rehash(newCapacity);
+}
+
+
+void ResourceTable::Clear()
+{
+	if (mEntries != NULL)
+		memset(mEntries, 0, mCapacity * sizeof(ResourceEntry));
+	mCount = 0;
+}
+
+
+int32_t ResourceTable::Rehash(uint32_t newCapacity)
+{
+	ResourceEntry* newEntries = (ResourceEntry*)memalign(64, newCapacity * sizeof(ResourceEntry));
+	if (newEntries == NULL)
+		return efwErrs::kOperationFailed;
+	memset(newEntries, 0, newCapacity * sizeof(ResourceEntry));
+
+	const uint32_t newMask = newCapacity - 1;
+	for (uint32_t i=0; i<mCapacity; ++i)
+	{
+		if (mEntries[i].guid == kEmptyGuid)
+			continue;
+
+		uint32_t slot = HashGuid(mEntries[i].guid) & newMask;
+		while (newEntries[slot].guid != kEmptyGuid)
+			slot = (slot + 1) & newMask;
+		newEntries[slot] = mEntries[i];
+	}
+
+	EFW_SAFE_ALIGNED_FREE(mEntries);
+	mEntries = newEntries;
+	mCapacity = newCapacity;
+
+	return efwErrs::kOk;
+}
+
+
+// Returns the slot holding the guid, or the empty slot where it would be inserted
+uint32_t ResourceTable::FindSlot(uint64_t guid) const
+{
+	EFW_ASSERT(mCapacity > 0);
+	const uint32_t mask = mCapacity - 1;
+
+	uint32_t slot = HashGuid(guid) & mask;
+	while (mEntries[slot].guid != guid && mEntries[slot].guid != kEmptyGuid)
+		slot = (slot + 1) & mask;
+
+	return slot;
+}
+
+
+int32_t ResourceTable::Insert(uint64_t guid, uintptr_t resourceOffset)
+{
+	if (guid == kEmptyGuid)
+		return efwErrs::kInvalidInput;
+
+	int32_t result = Reserve(mCount + 1);
+	if (result != efwErrs::kOk)
+		return result;
+
+	uint32_t slot = FindSlot(guid);
+	if (mEntries[slot].guid == guid)
+		return efwErrs::kInvalidState;
+
+	mEntries[slot].guid = guid;
+	mEntries[slot].resourceOffset = resourceOffset;
+	mCount++;
+
+	return efwErrs::kOk;
+}
+
+
+int32_t ResourceTable::InsertAll(const ResourceEntry* entries, uint32_t entryCount)
+{
+	if (entries == NULL && entryCount > 0)
+		return efwErrs::kInvalidInput;
+	if (entryCount > 0xFFFFFFFF - mCount)
+		return efwErrs::kInvalidInput;
+
+	// Grow once up front, so no rehash happens while inserting
+	int32_t result = Reserve(mCount + entryCount);
+	if (result != efwErrs::kOk)
+		return result;
+
+	for (uint32_t i=0; i<entryCount; ++i)
+	{
+		result = Insert(entries[i].guid, entries[i].resourceOffset);
+		if (result != efwErrs::kOk)
+		{
+			// Roll back, leaving the entries that were already in the table untouched
+			for (uint32_t j=0; j<i; ++j)
+				Remove(entries[j].guid);
+			return result;
+		}
+	}
+
+	return efwErrs::kOk;
+}
+
+
+bool ResourceTable::Remove(uint64_t guid)
+{
+	if (mCount == 0 || guid == kEmptyGuid)
+		return false;
+
+	uint32_t slot = FindSlot(guid);
+	if (mEntries[slot].guid != guid)
+		return false;
+
+	// Backward-shift deletion: move back every following entry of the cluster that can be closer to its home slot
+	const uint32_t mask = mCapacity - 1;
+	uint32_t emptySlot = slot;
+	uint32_t nextSlot = (slot + 1) & mask;
+	while (mEntries[nextSlot].guid != kEmptyGuid)
+	{
+		uint32_t homeSlot = HashGuid(mEntries[nextSlot].guid) & mask;
+		if (((nextSlot - homeSlot) & mask) >= ((nextSlot - emptySlot) & mask))
+		{
+			mEntries[emptySlot] = mEntries[nextSlot];
+			emptySlot = nextSlot;
+		}
+		nextSlot = (nextSlot + 1) & mask;
+	}
+
+	mEntries[emptySlot].guid = kEmptyGuid;
+	mEntries[emptySlot].resourceOffset = 0;
+	mCount--;
+
+	return true;
+}
+
+
+const ResourceEntry* ResourceTable::Find(uint64_t guid) const
+{
+	if (mCount == 0 || guid == kEmptyGuid)
+		return NULL;
+
+	uint32_t slot = FindSlot(guid);
+	return (mEntries[slot].guid == guid)? &mEntries[slot] : NULL;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+/**
+ * Copyright (C) 2012 Bruno P. Evangelista. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "Foundation/efwPlatform.h"
+
+namespace efw
+{
+	struct ResourceEntry
+	{
+		uint64_t guid;
+		uintptr_t resourceOffset;
+	};
+
+
+	/**
+	 * Open-addressing (linear probing) hash table of ResourceEntry, indexed by guid.
+	 * Entries are stored inline in a single power of two sized array, and removal uses backward-shift deletion so lookups 
+	 * never have to skip tombstones. Guid kEmptyGuid is reserved to mark empty slots.
+	 */
+	class ResourceTable : NonCopyable
+	{
+	public:
+		static const uint64_t kEmptyGuid = 0;
+		static const uint32_t kMinCapacity = 16;
+
+		ResourceTable();
+		~ResourceTable();
+
+		int32_t Reserve(uint32_t entryCount);
+		void Clear();
+
+		// Returns efwErrs::kInvalidState if the guid is already in the table
+		int32_t Insert(uint64_t guid, uintptr_t resourceOffset);
+		// Inserts all entries or none of them
+		int32_t InsertAll(const ResourceEntry* entries, uint32_t entryCount);
+		bool Remove(uint64_t guid);
+
+		const ResourceEntry* Find(uint64_t guid) const;
+		uint32_t GetCount() const { return mCount; }
+
+	private:
+		ResourceEntry* mEntries;
+		uint32_t mCapacity;
+		uint32_t mCount;
+
+		int32_t Rehash(uint32_t newCapacity);
+		uint32_t FindSlot(uint64_t guid) const;
+	};
+
+} // efw
\ No newline at end of file
@@ -5,6 +5,14 @@
 #include <string.h>
 #include <stdlib.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EFW_STRING_SSE2
+#include <emmintrin.h>
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 using namespace efw;
 
 
@@ -162,3 +170,179 @@ int32_t StringHelper::GetLineTokens(TokenArray* outTokenArray, const char* str,
 
 	return index;
 }
+
+
+
+// Powers of ten that are exactly representable as doubles
+static const double kExactPowersOfTen[] = 
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int32_t kMaxExactPowerOfTen = 22;
+
+
+// Returns the number of consecutive digits at the start of str, checking up to 16 characters at a time
+static EFW_INLINE int32_t CountDigits(const char* str, const char* strEnd)
+{
+#if defined(EFW_STRING_SSE2)
+	// Only read 16 bytes when they are all before the end of the string
+	if (strEnd - str >= 16)
+	{
+		__m128i values = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)str), _mm_set1_epi8('0'));
+		__m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(values, _mm_set1_epi8(9)), values);
+		uint32_t nonDigitMask = ~(uint32_t)_mm_movemask_epi8(isDigit);
+#if defined _MSC_VER
+		unsigned long digitCount;
+		_BitScanForward(&digitCount, nonDigitMask);
+		return (int32_t)digitCount;
+#else
+		return __builtin_ctz(nonDigitMask);
+#endif
+	}
+#endif
+
+	int32_t digitCount = 0;
+	while (str + digitCount < strEnd && (uint8_t)(str[digitCount] - '0') <= 9)
+		digitCount++;
+	return digitCount;
+}
+
+
+// Converts 8 ASCII digits to an integer with a few multiplies (SWAR), little endian only
+static EFW_INLINE uint32_t ParseEightDigits(const char* str)
+{
+	uint64_t value;
+	memcpy(&value, str, sizeof(value));
+	value -= 0x3030303030303030ULL;
+	value = (value * 10) + (value >> 8);
+	value = (((value & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) + 
+		(((value >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+	return (uint32_t)value;
+}
+
+
+/**
+ * Accumulates a run of digits into the mantissa. Digits that don't fit in the mantissa are dropped, and counted in 
+ * outDroppedDigitCount so integer digits can still scale the value.
+ */
+static EFW_INLINE const char* ParseDigits(uint64_t* inOutMantissa, int32_t* outAccumulatedDigitCount, int32_t* outDroppedDigitCount, 
+	const char* str, const char* strEnd)
+{
+	const uint64_t kMaxSwarMantissa = 100000000000ULL;			// Mantissa * 10^8 + 99999999 must fit in 10^19
+	const uint64_t kMaxMantissa = 100000000000000000ULL;		// Mantissa * 10 + 9 must fit in 10^19
+	uint64_t mantissa = *inOutMantissa;
+	int32_t accumulatedDigitCount = 0;
+	int32_t droppedDigitCount = 0;
+
+	int32_t digitCount = CountDigits(str, strEnd);
+	while (digitCount > 0)
+	{
+		const char* digitsEnd = str + digitCount;
+		while (digitsEnd - str >= 8 && mantissa < kMaxSwarMantissa)
+		{
+			mantissa = mantissa * 100000000 + ParseEightDigits(str);
+			accumulatedDigitCount += 8;
+			str += 8;
+		}
+		while (str < digitsEnd)
+		{
+			if (mantissa < kMaxMantissa)
+			{
+				mantissa = mantissa * 10 + (*str - '0');
+				accumulatedDigitCount++;
+			}
+			else
+			{
+				droppedDigitCount++;
+			}
+			str++;
+		}
+
+		// A full SIMD block may be followed by more digits
+		digitCount = (digitCount == 16)? CountDigits(str, strEnd) : 0;
+	}
+
+	*inOutMantissa = mantissa;
+	*outAccumulatedDigitCount = accumulatedDigitCount;
+	*outDroppedDigitCount = droppedDigitCount;
+	return str;
+}
+
+
+int32_t StringHelper::ParseFloat(float* outValue, const char* str, const char* strEnd)
+{
+	if (outValue == NULL || str == NULL || str >= strEnd)
+		return 0;
+
+	const char* current = str;
+	bool isNegative = (*current == '-');
+	if (*current == '-' || *current == '+')
+		current++;
+
+	uint64_t mantissa = 0;
+	int32_t exponent = 0;
+	int32_t accumulatedDigitCount = 0;
+	int32_t droppedDigitCount = 0;
+
+	// Integer part, dropped digits still scale the value
+	current = ParseDigits(&mantissa, &accumulatedDigitCount, &droppedDigitCount, current, strEnd);
+	int32_t totalDigitCount = accumulatedDigitCount + droppedDigitCount;
+	exponent += droppedDigitCount;
+
+	// Fraction part, each accumulated digit scales the value down
+	if (current < strEnd && *current == '.')
+	{
+		current++;
+		current = ParseDigits(&mantissa, &accumulatedDigitCount, &droppedDigitCount, current, strEnd);
+		totalDigitCount += accumulatedDigitCount + droppedDigitCount;
+		exponent -= accumulatedDigitCount;
+	}
+
+	if (totalDigitCount == 0)
+		return 0;
+
+	// Exponent part, only consumed when it has digits
+	if (current < strEnd && (*current == 'e' || *current == 'E'))
+	{
+		const char* exponentStart = current + 1;
+		bool isExponentNegative = (exponentStart < strEnd && *exponentStart == '-');
+		if (exponentStart < strEnd && (*exponentStart == '-' || *exponentStart == '+'))
+			exponentStart++;
+
+		int32_t exponentDigitCount = CountDigits(exponentStart, strEnd);
+		if (exponentDigitCount > 0)
+		{
+			// Float exponents are tiny, clamping keeps the accumulation from overflowing
+			int32_t fileExponent = 0;
+			for (int32_t i=0; i<exponentDigitCount; ++i)
+				fileExponent = Math::Min(fileExponent * 10 + (exponentStart[i] - '0'), 100000);
+			exponent += (isExponentNegative)? -fileExponent : fileExponent;
+			current = exponentStart + exponentDigitCount;
+		}
+	}
+
+	// Mantissas up to 2^53 and exponents within the exact powers of ten give a correctly rounded double
+	double value = (double)mantissa;
+	if (mantissa != 0)
+	{
+		while (exponent > kMaxExactPowerOfTen && value < DBL_MAX)
+		{
+			value *= kExactPowersOfTen[kMaxExactPowerOfTen];
+			exponent -= kMaxExactPowerOfTen;
+		}
+		while (exponent < -kMaxExactPowerOfTen && value > 0.0)
+		{
+			value /= kExactPowersOfTen[kMaxExactPowerOfTen];
+			exponent += kMaxExactPowerOfTen;
+		}
+
+		if (exponent >= 0)
+			value *= kExactPowersOfTen[Math::Min(exponent, kMaxExactPowerOfTen)];
+		else
+			value /= kExactPowersOfTen[Math::Min(-exponent, kMaxExactPowerOfTen)];
+	}
+
+	*outValue = (float)((isNegative)? -value : value);
+	return (int32_t)(current - str);
+}
\ No newline at end of file
@@ -49,6 +49,14 @@ namespace efw
 		int32_t GetFirstToken(void* outToken, int32_t tokenSize, const char* str, const char* delimiters, bool allowEmptyToken = false);
 		int32_t GetTokens(TokenArray* outTokenArray, const char* str, const char* delimiters, bool allowEmptyToken = false);
 		int32_t GetLineTokens(TokenArray* outTokenArray, const char* str, const char* delimiters, bool allowEmptyToken = false);
+
+		/**
+		 * Parses a decimal float ("-12.5", ".5", "1e-3") without copying it or going through the locale.
+		 * Results are exact when the value has up to 15 significant digits and an exponent within 1e22.
+		 * 
+		 * @return Number of characters read, or 0 when str doesn't start with a number.
+		 */
+		int32_t ParseFloat(float* outValue, const char* str, const char* strEnd);
 	}
 
 }
\ No newline at end of file
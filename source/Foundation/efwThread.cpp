@@ -0,0 +1,433 @@
+#include "Foundation/efwThread.h"
+
+#if defined _MSC_VER
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+typedef CRITICAL_SECTION PlatformMutex;
+typedef CONDITION_VARIABLE PlatformConditionVariable;
+#elif defined __GNUC__
+#include <pthread.h>
+typedef pthread_mutex_t PlatformMutex;
+typedef pthread_cond_t PlatformConditionVariable;
+#endif
+
+EFW_STATIC_ASSERT(sizeof(PlatformMutex) <= efw::PlatformStorage::kMutexSize);
+EFW_STATIC_ASSERT(sizeof(PlatformConditionVariable) <= efw::PlatformStorage::kConditionVariableSize);
+
+using namespace efw;
+
+struct ThreadStartData
+{
+	ThreadFunc_t threadFunc;
+	void* userData;
+};
+
+
+#if defined _MSC_VER
+DWORD WINAPI ThreadStart(LPVOID param)
+#else
+void* ThreadStart(void* param)
+#endif
+{
+	ThreadStartData startData = *(ThreadStartData*)param;
+	freealign(param);
+
+	startData.threadFunc(startData.userData);
+	return 0;
+}
+
+
+int32_t Thread::Create(ThreadHandle* outThread, ThreadFunc_t threadFunc, void* userData)
+{
+	if (outThread == NULL || threadFunc == NULL)
+		return efwErrs::kInvalidInput;
+
+	ThreadStartData* startData = (ThreadStartData*)memalign(16, sizeof(ThreadStartData));
+	startData->threadFunc = threadFunc;
+	startData->userData = userData;
+
+#if defined _MSC_VER
+	HANDLE thread = CreateThread(NULL, 0, ThreadStart, startData, 0, NULL);
+	if (thread == NULL)
+	{
+		freealign(startData);
+		return efwErrs::kOperationFailed;
+	}
+	outThread->handle = (uintptr_t)thread;
+#elif defined __GNUC__
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, ThreadStart, startData) != 0)
+	{
+		freealign(startData);
+		return efwErrs::kOperationFailed;
+	}
+	outThread->handle = (uintptr_t)thread;
+#endif
+
+	return efwErrs::kOk;
+}
+
+
+void Thread::Join(ThreadHandle* thread)
+{
+	if (thread == NULL || thread->handle == 0)
+		return;
+
+#if defined _MSC_VER
+	WaitForSingleObject((HANDLE)thread->handle, INFINITE);
+	CloseHandle((HANDLE)thread->handle);
+#elif defined __GNUC__
+	pthread_join((pthread_t)thread->handle, NULL);
+#endif
+	thread->handle = 0;
+}
+
+
+int32_t Thread::GetHardwareThreadCount()
+{
+#if defined _MSC_VER
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	int32_t threadCount = (int32_t)systemInfo.dwNumberOfProcessors;
+#elif defined __GNUC__
+	int32_t threadCount = (int32_t)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return (threadCount > 0)? threadCount : 1;
+}
+
+
+struct ParallelForJob
+{
+	ParallelForFunc_t func;
+	void* userData;
+	int32_t count;
+	volatile int32_t nextIndex;
+
+	// Pool workers running the job, guarded by the pool mutex
+	int32_t maxWorkerCount;
+	int32_t workerCount;
+	bool isExhausted;
+	ParallelForJob* next;
+};
+
+// Worker pool globals
+static Mutex gPoolMutex;
+static ConditionVariable gPoolWorkAvailable;
+static ConditionVariable gPoolJobFinished;
+static ThreadHandle gPoolWorkers[WorkerPool::kMaxWorkerCount];
+static int32_t gPoolWorkerCount = 0;
+static int32_t gPoolReferenceCount = 0;
+static bool gPoolShutdown = false;
+static WorkerTask* gPoolTaskHead = NULL;
+static WorkerTask* gPoolTaskTail = NULL;
+static ParallelForJob* gPoolJobHead = NULL;
+
+
+static void RunParallelForJob(ParallelForJob* job)
+{
+	int32_t index = Atomic::Increment(&job->nextIndex) - 1;
+	while (index < job->count)
+	{
+		job->func(job->userData, index);
+		index = Atomic::Increment(&job->nextIndex) - 1;
+	}
+}
+
+
+static ParallelForJob* FindJoinableJob()
+{
+	for (ParallelForJob* job = gPoolJobHead; job != NULL; job = job->next)
+	{
+		if (job->workerCount < job->maxWorkerCount && !job->isExhausted)
+			return job;
+	}
+	return NULL;
+}
+
+
+static void PoolWorker(void* userData)
+{
+	EFW_UNUSED(userData);
+
+	gPoolMutex.Lock();
+	for (;;)
+	{
+		// Parallel for jobs go first, their callers are waiting on them
+		ParallelForJob* job = FindJoinableJob();
+		if (job != NULL)
+		{
+			job->workerCount++;
+			gPoolMutex.Unlock();
+			RunParallelForJob(job);
+			gPoolMutex.Lock();
+			job->isExhausted = true;
+			if (--job->workerCount == 0)
+				gPoolJobFinished.NotifyAll();
+			continue;
+		}
+
+		// Tasks may be released as soon as they run, so they aren't touched afterwards
+		if (gPoolTaskHead != NULL)
+		{
+			WorkerTask* task = gPoolTaskHead;
+			gPoolTaskHead = task->next;
+			if (gPoolTaskHead == NULL)
+				gPoolTaskTail = NULL;
+			gPoolMutex.Unlock();
+			task->func(task->userData);
+			gPoolMutex.Lock();
+			continue;
+		}
+
+		// Queued tasks are drained before shutting down
+		if (gPoolShutdown)
+			break;
+		gPoolWorkAvailable.Wait(gPoolMutex);
+	}
+	gPoolMutex.Unlock();
+}
+
+
+int32_t WorkerPool::Initialize(int32_t workerCount)
+{
+	ScopedLock lock(gPoolMutex);
+	if (gPoolReferenceCount++ > 0)
+		return efwErrs::kOk;
+
+	if (workerCount <= 0)
+		workerCount = Thread::GetHardwareThreadCount();
+	if (workerCount > kMaxWorkerCount)
+		workerCount = kMaxWorkerCount;
+
+	gPoolShutdown = false;
+	for (int32_t i=0; i<workerCount; ++i)
+	{
+		if (Thread::Create(&gPoolWorkers[gPoolWorkerCount], PoolWorker, NULL) == efwErrs::kOk)
+			gPoolWorkerCount++;
+	}
+
+	if (gPoolWorkerCount == 0)
+	{
+		gPoolReferenceCount = 0;
+		return efwErrs::kOperationFailed;
+	}
+	return efwErrs::kOk;
+}
+
+
+void WorkerPool::Shutdown()
+{
+	gPoolMutex.Lock();
+	if (gPoolReferenceCount == 0 || --gPoolReferenceCount > 0)
+	{
+		gPoolMutex.Unlock();
+		return;
+	}
+
+	gPoolShutdown = true;
+	gPoolWorkAvailable.NotifyAll();
+	gPoolMutex.Unlock();
+
+	for (int32_t i=0; i<gPoolWorkerCount; ++i)
+		Thread::Join(&gPoolWorkers[i]);
+	gPoolWorkerCount = 0;
+}
+
+
+int32_t WorkerPool::GetWorkerCount()
+{
+	ScopedLock lock(gPoolMutex);
+	return (gPoolShutdown)? 0 : gPoolWorkerCount;
+}
+
+
+int32_t WorkerPool::Submit(WorkerTask* task)
+{
+	if (task == NULL || task->func == NULL)
+		return efwErrs::kInvalidInput;
+
+	ScopedLock lock(gPoolMutex);
+	if (gPoolWorkerCount == 0 || gPoolShutdown)
+		return efwErrs::kInvalidState;
+
+	task->next = NULL;
+	if (gPoolTaskTail != NULL)
+		gPoolTaskTail->next = task;
+	else
+		gPoolTaskHead = task;
+	gPoolTaskTail = task;
+	gPoolWorkAvailable.NotifyOne();
+	return efwErrs::kOk;
+}
+
+
+void Thread::ParallelFor(int32_t count, ParallelForFunc_t func, void* userData, int32_t threadCount)
+{
+	if (count <= 0 || func == NULL)
+		return;
+
+	if (threadCount <= 0)
+		threadCount = GetHardwareThreadCount();
+	if (threadCount > count)
+		threadCount = count;
+
+	ParallelForJob job;
+	job.func = func;
+	job.userData = userData;
+	job.count = count;
+	job.nextIndex = 0;
+	job.maxWorkerCount = threadCount - 1;
+	job.workerCount = 0;
+	job.isExhausted = false;
+	job.next = NULL;
+
+	if (job.maxWorkerCount == 0)
+	{
+		RunParallelForJob(&job);
+		return;
+	}
+
+	// Without a running pool the calling thread does all the work
+	gPoolMutex.Lock();
+	if (gPoolWorkerCount == 0 || gPoolShutdown)
+	{
+		gPoolMutex.Unlock();
+		RunParallelForJob(&job);
+		return;
+	}
+
+	job.next = gPoolJobHead;
+	gPoolJobHead = &job;
+	gPoolWorkAvailable.NotifyAll();
+	gPoolMutex.Unlock();
+
+	RunParallelForJob(&job);
+
+	// Every index is claimed, so only workers still running one are waited for
+	gPoolMutex.Lock();
+	ParallelForJob** link = &gPoolJobHead;
+	while (*link != &job)
+		link = &(*link)->next;
+	*link = job.next;
+	while (job.workerCount > 0)
+		gPoolJobFinished.Wait(gPoolMutex);
+	gPoolMutex.Unlock();
+}
+
+
+int32_t Atomic::Increment(volatile int32_t* value)
+{
+#if defined _MSC_VER
+	return (int32_t)InterlockedIncrement((volatile LONG*)value);
+#elif defined __GNUC__
+	return __sync_add_and_fetch(value, 1);
+#endif
+}
+
+
+int32_t Atomic::Decrement(volatile int32_t* value)
+{
+#if defined _MSC_VER
+	return (int32_t)InterlockedDecrement((volatile LONG*)value);
+#elif defined __GNUC__
+	return __sync_sub_and_fetch(value, 1);
+#endif
+}
+
+
+int32_t Atomic::Add(volatile int32_t* value, int32_t addend)
+{
+#if defined _MSC_VER
+	return (int32_t)InterlockedExchangeAdd((volatile LONG*)value, addend) + addend;
+#elif defined __GNUC__
+	return __sync_add_and_fetch(value, addend);
+#endif
+}
+
+
+Mutex::Mutex()
+{
+#if defined _MSC_VER
+	InitializeCriticalSection((PlatformMutex*)mStorage);
+#elif defined __GNUC__
+	pthread_mutex_init((PlatformMutex*)mStorage, NULL);
+#endif
+}
+
+
+Mutex::~Mutex()
+{
+#if defined _MSC_VER
+	DeleteCriticalSection((PlatformMutex*)mStorage);
+#elif defined __GNUC__
+	pthread_mutex_destroy((PlatformMutex*)mStorage);
+#endif
+}
+
+
+void Mutex::Lock()
+{
+#if defined _MSC_VER
+	EnterCriticalSection((PlatformMutex*)mStorage);
+#elif defined __GNUC__
+	pthread_mutex_lock((PlatformMutex*)mStorage);
+#endif
+}
+
+
+void Mutex::Unlock()
+{
+#if defined _MSC_VER
+	LeaveCriticalSection((PlatformMutex*)mStorage);
+#elif defined __GNUC__
+	pthread_mutex_unlock((PlatformMutex*)mStorage);
+#endif
+}
+
+
+ConditionVariable::ConditionVariable()
+{
+#if defined _MSC_VER
+	InitializeConditionVariable((PlatformConditionVariable*)mStorage);
+#elif defined __GNUC__
+	pthread_cond_init((PlatformConditionVariable*)mStorage, NULL);
+#endif
+}
+
+
+ConditionVariable::~ConditionVariable()
+{
+#if defined __GNUC__
+	pthread_cond_destroy((PlatformConditionVariable*)mStorage);
+#endif
+}
+
+
+void ConditionVariable::Wait(Mutex& mutex)
+{
+#if defined _MSC_VER
+	SleepConditionVariableCS((PlatformConditionVariable*)mStorage, (PlatformMutex*)mutex.mStorage, INFINITE);
+#elif defined __GNUC__
+	pthread_cond_wait((PlatformConditionVariable*)mStorage, (PlatformMutex*)mutex.mStorage);
+#endif
+}
+
+
+void ConditionVariable::NotifyOne()
+{
+#if defined _MSC_VER
+	WakeConditionVariable((PlatformConditionVariable*)mStorage);
+#elif defined __GNUC__
+	pthread_cond_signal((PlatformConditionVariable*)mStorage);
+#endif
+}
+
+
+void ConditionVariable::NotifyAll()
+{
+#if defined _MSC_VER
+	WakeAllConditionVariable((PlatformConditionVariable*)mStorage);
+#elif defined __GNUC__
+	pthread_cond_broadcast((PlatformConditionVariable*)mStorage);
+#endif
+}
\ No newline at end of file
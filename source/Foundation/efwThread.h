@@ -0,0 +1,125 @@
+/**
+ * Copyright (C) 2012 Bruno P. Evangelista. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "Foundation/efwPlatform.h"
+
+namespace efw
+{
+	typedef void (*ThreadFunc_t)(void* userData);
+	typedef void (*ParallelForFunc_t)(void* userData, int32_t index);
+
+	struct ThreadHandle
+	{
+		uintptr_t handle;
+	};
+
+	namespace Thread
+	{
+		int32_t Create(ThreadHandle* outThread, ThreadFunc_t threadFunc, void* userData);
+		void Join(ThreadHandle* thread);
+		int32_t GetHardwareThreadCount();
+
+		/**
+		 * Runs func for every index in [0, count) and waits for all of them. Indices are claimed one at a time, so
+		 * uneven work balances out when count is a few times the thread count. The calling thread works too, and idle 
+		 * WorkerPool threads join it, so the call never waits for workers busy with other tasks.
+		 * The WorkerPool must be initialized by the application, otherwise everything runs on the calling thread.
+		 * 
+		 * @param threadCount Maximum number of threads to use, including the calling one, or 0 to use one per hardware thread.
+		 */
+		void ParallelFor(int32_t count, ParallelForFunc_t func, void* userData, int32_t threadCount = 0);
+	}
+
+	// Task run on a WorkerPool thread. Tasks are owned by the submitter and must stay alive until they run.
+	struct WorkerTask
+	{
+		ThreadFunc_t func;
+		void* userData;
+
+		// Internal
+		WorkerTask* next;
+	};
+
+	/**
+	 * Worker threads shared by AsyncFileReader and Thread::ParallelFor. The pool is reference counted: the first 
+	 * Initialize starts it, and the last Shutdown joins its workers once every queued task has run.
+	 * Initialize and Shutdown must not be called concurrently.
+	 */
+	namespace WorkerPool
+	{
+		const int32_t kMaxWorkerCount = 64;
+
+		// workerCount only applies when the pool starts, 0 uses one per hardware thread
+		int32_t Initialize(int32_t workerCount = 0);
+		void Shutdown();
+		int32_t GetWorkerCount();
+
+		// Tasks run in submission order
+		int32_t Submit(WorkerTask* task);
+	}
+
+	namespace Atomic
+	{
+		int32_t Increment(volatile int32_t* value);
+		int32_t Decrement(volatile int32_t* value);
+		int32_t Add(volatile int32_t* value, int32_t addend);
+	}
+
+	// Platform objects are kept in opaque storage so platform headers don't leak out
+	namespace PlatformStorage
+	{
+		const int32_t kMutexSize = 64;
+		const int32_t kConditionVariableSize = 64;
+	}
+
+	class Mutex : NonCopyable
+	{
+	public:
+		Mutex();
+		~Mutex();
+
+		void Lock();
+		void Unlock();
+
+	private:
+		friend class ConditionVariable;
+		EFW_ALIGNED_TYPE(16, uint8_t) mStorage[PlatformStorage::kMutexSize];
+	};
+
+	class ConditionVariable : NonCopyable
+	{
+	public:
+		ConditionVariable();
+		~ConditionVariable();
+
+		void Wait(Mutex& mutex);
+		void NotifyOne();
+		void NotifyAll();
+
+	private:
+		EFW_ALIGNED_TYPE(16, uint8_t) mStorage[PlatformStorage::kConditionVariableSize];
+	};
+
+	class ScopedLock : NonCopyable
+	{
+	public:
+		ScopedLock(Mutex& mutex) : mMutex(mutex) { mMutex.Lock(); }
+		~ScopedLock() { mMutex.Unlock(); }
+
+	private:
+		Mutex& mMutex;
+	};
+
+} // efw
\ No newline at end of file
@@ -0,0 +1,337 @@
+#include "Graphics/efwMeshCache.h"
+
+#include "Foundation/efwFile.h"
+#include "Foundation/efwFileReader.h"
+#include "Foundation/efwMemory.h"
+#include "Foundation/efwPackageWriter.h"
+#include "Foundation/efwPathHelper.h"
+#include "Foundation/efwResourceManager.h"
+#include "Foundation/efwThread.h"
+#include "Graphics/efwPackageBaker.h"
+#include "Graphics/efwTextureReader.h"
+
+using namespace efw;
+using namespace efw::Graphics;
+
+// Resource index of the model desc and the material lib, meshes use their index plus one
+static const uint32_t kModelDescResourceIndex = 0;
+static const uint32_t kMaterialLibResourceIndex = 0xFFFFFFFF;
+
+// Stored as the kModel resource of a cache package
+struct CachedModelDesc
+{
+	uint64_t contentHash;
+	uint32_t meshCount;
+	uint32_t hasMaterialLib;
+};
+
+// Cache package opened by MeshCache, shared by every reader of its model. Its package id is the cache key.
+struct OpenedCachePackage
+{
+	uint64_t packageId;
+	int32_t readerCount;
+};
+
+static Mutex gOpenedPackagesMutex;
+static OpenedCachePackage gOpenedPackages[ResourceLoader::kMaxOpenPackages];
+static int32_t gOpenedPackageCount = 0;
+
+
+static uint64_t GetResourceGuid(uint64_t key, uint32_t resourceIndex)
+{
+	return (uint64_t)efwHash64(&resourceIndex, (uint64_t)sizeof(resourceIndex), (int64_t)key);
+}
+
+
+static void ReleaseParsedModel(UnprocessedTriModel* model, UnprocessedMaterialLib* materialLib)
+{
+	WavefrontObjReader::Release(model);
+	FreeAlignSafe(model);
+
+	WavefrontObjReader::Release(materialLib);
+	for (int32_t i=0; materialLib != NULL && i < materialLib->materialCount; ++i)
+	{
+		FreeAlignSafe(materialLib->materials[i].albedoTexture);
+		FreeAlignSafe(materialLib->materials[i].normalMapTexture);
+	}
+	FreeAlignSafe(materialLib);
+}
+
+
+static int32_t GetContentHash(uint64_t* outContentHash, const char* objFilePath)
+{
+	MappedFile objFile;
+	int32_t result = FileReader::Map(&objFile, objFilePath, FileMapHints::kSequential);
+	if (result != efwErrs::kOk)
+		return result;
+
+	*outContentHash = (uint64_t)efwHash64(objFile.data, objFile.size, kHashEncodeStart);
+	FileReader::Unmap(&objFile);
+	return efwErrs::kOk;
+}
+
+
+static int32_t GetKeyAndContentHash(uint64_t* outKey, uint64_t* outContentHash, const char* objFilePath)
+{
+	uint64_t contentHash;
+	int32_t result = GetContentHash(&contentHash, objFilePath);
+	if (result != efwErrs::kOk)
+		return result;
+
+	const uint32_t versions[] = { WavefrontObjReader::kVersion, MeshCache::kVersion, PackageFormat::kVersion };
+	int64_t hash = efwHash64(versions, (uint64_t)sizeof(versions), (int64_t)contentHash);
+
+	// Zero is reserved for models that aren't cached
+	*outKey = (hash != 0)? (uint64_t)hash : 1;
+	*outContentHash = contentHash;
+	return efwErrs::kOk;
+}
+
+
+int32_t MeshCache::GetKey(uint64_t* outKey, const char* objFilePath)
+{
+	if (outKey == NULL || objFilePath == NULL)
+		return efwErrs::kInvalidInput;
+
+	uint64_t contentHash;
+	return GetKeyAndContentHash(outKey, &contentHash, objFilePath);
+}
+
+
+int32_t MeshCache::ValidateContent(const CachedModel* cachedModel, const char* objFilePath)
+{
+	if (cachedModel == NULL || objFilePath == NULL)
+		return efwErrs::kInvalidInput;
+
+	uint64_t contentHash;
+	int32_t result = GetContentHash(&contentHash, objFilePath);
+	if (result != efwErrs::kOk)
+		return result;
+
+	return (contentHash == cachedModel->contentHash)? efwErrs::kOk : efwErrs::kCorruptedData;
+}
+
+
+// Builds the model of an opened cache package
+static int32_t GetCachedModel(CachedModel* outCachedModel, uint64_t key)
+{
+	void* data;
+	uint32_t dataSize;
+	const CachedModelDesc* modelDesc = NULL;
+	if (ResourceManager::FindByGuid(&data, &dataSize, GetResourceGuid(key, kModelDescResourceIndex)) == efwErrs::kOk && 
+		dataSize >= sizeof(CachedModelDesc))
+		modelDesc = (const CachedModelDesc*)data;
+
+	UnprocessedTriModel* model = NULL;
+	UnprocessedMaterialLib* materialLib = NULL;
+	int32_t result = (modelDesc != NULL)? efwErrs::kOk : efwErrs::kCorruptedData;
+
+	// Mesh structs are copied into the model, their data stays in the package
+	if (result == efwErrs::kOk && modelDesc->meshCount > 0)
+	{
+		model = (UnprocessedTriModel*)memalign(128, sizeof(UnprocessedTriModel) + modelDesc->meshCount * sizeof(UnprocessedTriMesh));
+		model->meshCount = modelDesc->meshCount;
+		for (uint32_t i=0; i<modelDesc->meshCount && result == efwErrs::kOk; ++i)
+		{
+			result = ResourceManager::FindByGuid(&data, &dataSize, GetResourceGuid(key, i+1));
+			if (result != efwErrs::kOk || dataSize < sizeof(UnprocessedTriMesh))
+				result = efwErrs::kCorruptedData;
+			else
+				model->meshes[i] = *(const UnprocessedTriMesh*)data;
+		}
+	}
+
+	if (result == efwErrs::kOk && modelDesc->hasMaterialLib != 0)
+	{
+		result = ResourceManager::FindByGuid(&data, &dataSize, GetResourceGuid(key, kMaterialLibResourceIndex));
+		if (result != efwErrs::kOk || dataSize < sizeof(UnprocessedMaterialLib))
+			result = efwErrs::kCorruptedData;
+		else
+			materialLib = (UnprocessedMaterialLib*)data;
+	}
+
+	if (result != efwErrs::kOk)
+	{
+		FreeAlignSafe(model);
+		return result;
+	}
+
+	outCachedModel->model = model;
+	outCachedModel->materialLib = materialLib;
+	outCachedModel->packageId = key;
+	outCachedModel->contentHash = modelDesc->contentHash;
+	return efwErrs::kOk;
+}
+
+
+static int32_t OpenCachedModel(CachedModel* outCachedModel, const char* cacheFilePath, uint64_t key)
+{
+	ScopedLock lock(gOpenedPackagesMutex);
+
+	// Readers of a model that is already opened share its package
+	for (int32_t i=0; i<gOpenedPackageCount; ++i)
+	{
+		if (gOpenedPackages[i].packageId == key)
+		{
+			int32_t result = GetCachedModel(outCachedModel, key);
+			if (result == efwErrs::kOk)
+				gOpenedPackages[i].readerCount++;
+			return result;
+		}
+	}
+
+	FileInfo cacheFileInfo;
+	File::GetInfo(&cacheFileInfo, cacheFilePath);
+	if (!cacheFileInfo.exists)
+		return efwErrs::kOperationFailed;
+	if (gOpenedPackageCount == ResourceLoader::kMaxOpenPackages)
+		return efwErrs::kInvalidState;
+
+	uint64_t packageId;
+	int32_t result = ResourceLoader::OpenPackage(&packageId, cacheFilePath);
+	if (result != efwErrs::kOk)
+		return result;
+
+	result = (packageId == key)? GetCachedModel(outCachedModel, key) : efwErrs::kCorruptedData;
+	if (result != efwErrs::kOk)
+	{
+		ResourceLoader::ClosePackage(packageId);
+		return result;
+	}
+
+	gOpenedPackages[gOpenedPackageCount].packageId = packageId;
+	gOpenedPackages[gOpenedPackageCount].readerCount = 1;
+	gOpenedPackageCount++;
+	return efwErrs::kOk;
+}
+
+
+static void CloseCachedModel(uint64_t packageId)
+{
+	ScopedLock lock(gOpenedPackagesMutex);
+
+	for (int32_t i=0; i<gOpenedPackageCount; ++i)
+	{
+		if (gOpenedPackages[i].packageId == packageId)
+		{
+			if (--gOpenedPackages[i].readerCount == 0)
+			{
+				ResourceLoader::ClosePackage(packageId);
+				gOpenedPackages[i] = gOpenedPackages[--gOpenedPackageCount];
+			}
+			return;
+		}
+	}
+}
+
+
+static int32_t WriteCachedModel(const char* cacheFilePath, uint64_t key, uint64_t contentHash, 
+	const UnprocessedTriModel* model, const UnprocessedMaterialLib* materialLib)
+{
+	PackageContent* content = NULL;
+	int32_t result = PackageWriter::Create(&content);
+	if (result != efwErrs::kOk)
+		return result;
+
+	CachedModelDesc modelDesc;
+	modelDesc.contentHash = contentHash;
+	modelDesc.meshCount = (model != NULL)? model->meshCount : 0;
+	modelDesc.hasMaterialLib = (materialLib != NULL)? 1 : 0;
+	result = PackageWriter::AddResource(content, GetResourceGuid(key, kModelDescResourceIndex), ResourceTypes::kModel, 
+		&modelDesc, sizeof(modelDesc));
+
+	for (uint32_t i=0; i<modelDesc.meshCount && result == efwErrs::kOk; ++i)
+		result = PackageBaker::AddMesh(content, GetResourceGuid(key, i+1), model->meshes[i]);
+
+	if (result == efwErrs::kOk && materialLib != NULL)
+		result = PackageBaker::AddMaterialLib(content, GetResourceGuid(key, kMaterialLibResourceIndex), *materialLib);
+
+	// Written aside and renamed, so a package being read or an interrupted write is never seen as a cache entry
+	char tempFilePath[Path::kMaxFullPathLength];
+	const char* kTempFileExtension = ".tmp";
+	if (strlen(cacheFilePath) + strlen(kTempFileExtension) >= sizeof(tempFilePath))
+		result = efwErrs::kInvalidInput;
+
+	if (result == efwErrs::kOk)
+	{
+		strcpy(tempFilePath, cacheFilePath);
+		strcat(tempFilePath, kTempFileExtension);
+
+		result = PackageWriter::WriteToFile(content, key, tempFilePath);
+		if (result == efwErrs::kOk && rename(tempFilePath, cacheFilePath) != 0)
+			result = efwErrs::kOperationFailed;
+		if (result != efwErrs::kOk)
+			remove(tempFilePath);
+	}
+
+	PackageWriter::Destroy(&content);
+	return result;
+}
+
+
+int32_t MeshCache::ReadModelAndMaterials(CachedModel* outCachedModel, const char* objFilePath, const char* cacheDirectory, 
+	WavefrontObjReader::ReadFileFunc_t readFileFunc, int32_t parseThreadCount)
+{
+	if (outCachedModel == NULL || objFilePath == NULL || cacheDirectory == NULL)
+		return efwErrs::kInvalidInput;
+	memset(outCachedModel, 0, sizeof(CachedModel));
+
+	uint64_t key, contentHash;
+	int32_t result = GetKeyAndContentHash(&key, &contentHash, objFilePath);
+	if (result != efwErrs::kOk)
+		return result;
+
+	char cacheFileName[Path::kMaxFileNameLength];
+	sprintf(cacheFileName, "%08x%08x.efwp", (uint32_t)(key >> 32), (uint32_t)key);
+	char cacheFilePath[Path::kMaxFullPathLength];
+	result = PathHelper::Combine(cacheFilePath, Path::kMaxFullPathLength, cacheDirectory, cacheFileName);
+	if (result != efwErrs::kOk)
+		return result;
+
+	// Missing or corrupted packages are parsed again and replaced, but packages clashing with other opened ones can't be
+	result = OpenCachedModel(outCachedModel, cacheFilePath, key);
+	if (result == efwErrs::kOk || result == efwErrs::kInvalidState)
+		return result;
+
+	UnprocessedTriModel* model = NULL;
+	UnprocessedMaterialLib* materialLib = NULL;
+	result = WavefrontObjReader::ReadModelAndMaterials(&model, &materialLib, objFilePath, readFileFunc, parseThreadCount);
+	if (result != efwErrs::kOk)
+		return result;
+
+	result = WriteCachedModel(cacheFilePath, key, contentHash, model, materialLib);
+	if (result == efwErrs::kOk)
+		result = OpenCachedModel(outCachedModel, cacheFilePath, key);
+
+	// Models that can't be cached are still returned
+	if (result != efwErrs::kOk)
+	{
+		outCachedModel->model = model;
+		outCachedModel->materialLib = materialLib;
+		outCachedModel->packageId = 0;
+		outCachedModel->contentHash = contentHash;
+		return efwErrs::kOk;
+	}
+
+	ReleaseParsedModel(model, materialLib);
+	return efwErrs::kOk;
+}
+
+
+void MeshCache::Release(CachedModel* cachedModel)
+{
+	if (cachedModel == NULL)
+		return;
+
+	if (cachedModel->packageId != 0)
+	{
+		FreeAlignSafe(cachedModel->model);
+		CloseCachedModel(cachedModel->packageId);
+	}
+	else
+	{
+		ReleaseParsedModel(cachedModel->model, cachedModel->materialLib);
+	}
+
+	memset(cachedModel, 0, sizeof(CachedModel));
+}
\ No newline at end of file
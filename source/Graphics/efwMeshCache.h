@@ -0,0 +1,67 @@
+/**
+ * Copyright (C) 2012 Bruno P. Evangelista. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "Foundation/efwPlatform.h"
+#include "Graphics/efwUnprocessedTriMesh.h"
+#include "Graphics/efwUnprocessedMaterial.h"
+#include "Graphics/efwWavefrontObjReader.h"
+
+namespace efw
+{
+namespace Graphics
+{
+	/**
+	 * Model read through the mesh cache. When it comes from a cache package, the mesh data and the material lib point 
+	 * into the mapped package, and only the model struct is allocated.
+	 */
+	struct CachedModel
+	{
+		UnprocessedTriModel* model;
+		UnprocessedMaterialLib* materialLib;
+
+		// Internal
+		uint64_t packageId;					// 0 when the model couldn't be cached and owns its parsed data
+		uint64_t contentHash;				// Hash of the OBJ file bytes the model was parsed from
+	};
+
+	/**
+	 * Binary cache of parsed OBJ models. Each model is stored as a resource package named after its key, the hash of the 
+	 * OBJ file bytes and the reader versions, so identical OBJ files share a package and an edited file never hits a 
+	 * stale one. Material libs and textures are cached with the model but aren't part of the key.
+	 * A cached model may be read any number of times at once, its package stays opened until the last one is released.
+	 */
+	namespace MeshCache
+	{
+		// Bumped whenever the cached layout changes
+		const uint32_t kVersion = 2;
+
+		// Hashes the whole OBJ file
+		int32_t GetKey(uint64_t* outKey, const char* objFilePath);
+
+		// Hashes the OBJ file and fails with efwErrs::kCorruptedData if the model wasn't parsed from the same bytes
+		int32_t ValidateContent(const CachedModel* cachedModel, const char* objFilePath);
+
+		/**
+		 * Reads a model from the cache, or parses it with WavefrontObjReader and adds it to the cache on a miss.
+		 * 
+		 * @param cacheDirectory Directory of the cache packages, which must exist.
+		 */
+		int32_t ReadModelAndMaterials(CachedModel* outCachedModel, const char* objFilePath, const char* cacheDirectory, 
+			WavefrontObjReader::ReadFileFunc_t readFileFunc = NULL, int32_t parseThreadCount = 1);
+		void Release(CachedModel* cachedModel);
+	}
+
+} // Graphics
+} // efw
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "Graphics/efwPackageBaker.h"
+#include "Graphics/efwTextureReader.h"
+
+#include <vector>
+
+using namespace efw;
+using namespace efw::Graphics;
+
+static const int32_t kMeshDataAlignment = 16;
+
+
+int32_t PackageBaker::AddTexture(PackageContent* content, uint64_t guid, const Texture& texture)
+{
+	if (content == NULL || (texture.data == NULL && texture.dataSize > 0))
+		return efwErrs::kInvalidInput;
+
+	const uint64_t dataOffset = EFW_ALIGN(TextureReader::kDefaultTextureAlignment, sizeof(Texture));
+	const uint64_t blobSize = dataOffset + texture.dataSize;
+	if (blobSize > 0xFFFFFFFF)
+		return efwErrs::kInvalidInput;
+
+	uint8_t* blob = (uint8_t*)memalign(16, (size_t)blobSize);
+	if (blob == NULL)
+		return efwErrs::kOperationFailed;
+	memset(blob, 0, (size_t)dataOffset);
+
+	Texture* bakedTexture = (Texture*)blob;
+	*bakedTexture = texture;
+	bakedTexture->data = (void*)(uintptr_t)dataOffset;
+	memcpy(blob + dataOffset, texture.data, (size_t)texture.dataSize);
+
+	const uint32_t pointerOffsets[] = { (uint32_t)offsetof(Texture, data) };
+	int32_t result = PackageWriter::AddResource(content, guid, ResourceTypes::kTexture, blob, (uint32_t)blobSize, 
+		pointerOffsets, 1, TextureReader::kDefaultTextureAlignment);
+
+	freealign(blob);
+	return result;
+}
+
+
+int32_t PackageBaker::AddMesh(PackageContent* content, const UnprocessedTriMesh& mesh)
+{
+	return AddMesh(content, mesh.guid.hash64, mesh);
+}
+
+
+int32_t PackageBaker::AddMesh(PackageContent* content, uint64_t guid, const UnprocessedTriMesh& mesh)
+{
+	if (content == NULL)
+		return efwErrs::kInvalidInput;
+
+	const uint64_t vertexDataSize = (uint64_t)mesh.vertexCount * mesh.vertexStride;
+	const uint64_t indexDataSize = (uint64_t)mesh.indexCount * mesh.indexStride;
+	if ((mesh.vertexData == NULL && vertexDataSize > 0) || (mesh.indexData == NULL && indexDataSize > 0) || 
+		(mesh.customUserData == NULL && mesh.customUserDataSize > 0))
+		return efwErrs::kInvalidInput;
+
+	const uint64_t vertexDataOffset = EFW_ALIGN(kMeshDataAlignment, sizeof(UnprocessedTriMesh));
+	const uint64_t indexDataOffset = EFW_ALIGN(kMeshDataAlignment, vertexDataOffset + vertexDataSize);
+	const uint64_t customUserDataOffset = EFW_ALIGN(kMeshDataAlignment, indexDataOffset + indexDataSize);
+	const uint64_t blobSize = customUserDataOffset + mesh.customUserDataSize;
+	if (blobSize > 0xFFFFFFFF)
+		return efwErrs::kInvalidInput;
+
+	uint8_t* blob = (uint8_t*)memalign(16, (size_t)blobSize);
+	if (blob == NULL)
+		return efwErrs::kOperationFailed;
+	memset(blob, 0, (size_t)blobSize);
+
+	// Null pointers are kept null and don't need relocation. UnprocessedTriMesh isn't standard layout, so the pointer 
+	// offsets are taken from the baked instance instead of offsetof.
+	uint32_t pointerOffsets[3];
+	int32_t pointerOffsetCount = 0;
+
+	UnprocessedTriMesh* bakedMesh = (UnprocessedTriMesh*)blob;
+	*bakedMesh = mesh;
+	if (mesh.vertexData != NULL)
+	{
+		memcpy(blob + vertexDataOffset, mesh.vertexData, (size_t)vertexDataSize);
+		bakedMesh->vertexData = (void*)(uintptr_t)vertexDataOffset;
+		pointerOffsets[pointerOffsetCount++] = (uint32_t)((uint8_t*)&bakedMesh->vertexData - blob);
+	}
+	if (mesh.indexData != NULL)
+	{
+		memcpy(blob + indexDataOffset, mesh.indexData, (size_t)indexDataSize);
+		bakedMesh->indexData = (void*)(uintptr_t)indexDataOffset;
+		pointerOffsets[pointerOffsetCount++] = (uint32_t)((uint8_t*)&bakedMesh->indexData - blob);
+	}
+	if (mesh.customUserData != NULL)
+	{
+		memcpy(blob + customUserDataOffset, mesh.customUserData, (size_t)mesh.customUserDataSize);
+		bakedMesh->customUserData = (void*)(uintptr_t)customUserDataOffset;
+		pointerOffsets[pointerOffsetCount++] = (uint32_t)((uint8_t*)&bakedMesh->customUserData - blob);
+	}
+
+	int32_t result = PackageWriter::AddResource(content, guid, ResourceTypes::kMesh, blob, (uint32_t)blobSize, 
+		pointerOffsets, pointerOffsetCount, kMeshDataAlignment);
+
+	freealign(blob);
+	return result;
+}
+
+
+int32_t PackageBaker::AddMaterialLib(PackageContent* content, uint64_t guid, const UnprocessedMaterialLib& materialLib)
+{
+	if (content == NULL || materialLib.materialCount < 0)
+		return efwErrs::kInvalidInput;
+
+	// Layout: the material lib, then each texture struct followed by its data
+	uint64_t blobSize = sizeof(UnprocessedMaterialLib) + (uint64_t)materialLib.materialCount * sizeof(UnprocessedMaterial);
+	for (int32_t i=0; i<materialLib.materialCount; ++i)
+	{
+		const Texture* textures[] = { materialLib.materials[i].albedoTexture, materialLib.materials[i].normalMapTexture };
+		for (uint32_t j=0; j<EFW_COUNTOF(textures); ++j)
+		{
+			if (textures[j] == NULL)
+				continue;
+			if (textures[j]->data == NULL && textures[j]->dataSize > 0)
+				return efwErrs::kInvalidInput;
+
+			blobSize = EFW_ALIGN(TextureReader::kDefaultTextureAlignment, blobSize) + sizeof(Texture);
+			blobSize = EFW_ALIGN(TextureReader::kDefaultTextureAlignment, blobSize) + textures[j]->dataSize;
+		}
+	}
+	if (blobSize > 0xFFFFFFFF)
+		return efwErrs::kInvalidInput;
+
+	uint8_t* blob = (uint8_t*)memalign(16, (size_t)blobSize);
+	if (blob == NULL)
+		return efwErrs::kOperationFailed;
+	memset(blob, 0, (size_t)blobSize);
+
+	UnprocessedMaterialLib* bakedMaterialLib = (UnprocessedMaterialLib*)blob;
+	bakedMaterialLib->materialCount = materialLib.materialCount;
+	memcpy(bakedMaterialLib->materials, materialLib.materials, materialLib.materialCount * sizeof(UnprocessedMaterial));
+
+	// Null textures are kept null and don't need relocation
+	std::vector<uint32_t> pointerOffsets;
+	uint64_t currentOffset = sizeof(UnprocessedMaterialLib) + (uint64_t)materialLib.materialCount * sizeof(UnprocessedMaterial);
+	for (int32_t i=0; i<materialLib.materialCount; ++i)
+	{
+		UnprocessedMaterial& bakedMaterial = bakedMaterialLib->materials[i];
+		Texture** textures[] = { &bakedMaterial.albedoTexture, &bakedMaterial.normalMapTexture };
+		for (uint32_t j=0; j<EFW_COUNTOF(textures); ++j)
+		{
+			const Texture* texture = *textures[j];
+			if (texture == NULL)
+				continue;
+
+			const uint64_t textureOffset = EFW_ALIGN(TextureReader::kDefaultTextureAlignment, currentOffset);
+			const uint64_t textureDataOffset = EFW_ALIGN(TextureReader::kDefaultTextureAlignment, textureOffset + sizeof(Texture));
+			currentOffset = textureDataOffset + texture->dataSize;
+
+			Texture* bakedTexture = (Texture*)(blob + textureOffset);
+			*bakedTexture = *texture;
+			if (texture->data != NULL)
+			{
+				memcpy(blob + textureDataOffset, texture->data, (size_t)texture->dataSize);
+				bakedTexture->data = (void*)(uintptr_t)textureDataOffset;
+				pointerOffsets.push_back((uint32_t)((uint8_t*)&bakedTexture->data - blob));
+			}
+
+			*textures[j] = (Texture*)(uintptr_t)textureOffset;
+			pointerOffsets.push_back((uint32_t)((uint8_t*)textures[j] - blob));
+		}
+	}
+
+	int32_t result = PackageWriter::AddResource(content, guid, ResourceTypes::kMaterial, blob, (uint32_t)blobSize, 
+		(pointerOffsets.size() > 0)? &pointerOffsets[0] : NULL, (int32_t)pointerOffsets.size(), TextureReader::kDefaultTextureAlignment);
+
+	freealign(blob);
+	return result;
+}
\ No newline at end of file
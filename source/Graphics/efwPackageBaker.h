@@ -0,0 +1,40 @@
+/**
+ * Copyright (C) 2012 Bruno P. Evangelista. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "Foundation/efwPlatform.h"
+#include "Foundation/efwPackageWriter.h"
+#include "Graphics/efwTexture.h"
+#include "Graphics/efwUnprocessedTriMesh.h"
+#include "Graphics/efwUnprocessedMaterial.h"
+
+namespace efw
+{
+namespace Graphics
+{
+	/**
+	 * Adds graphics resources to a package. Each resource is stored as its struct followed by its data, with the data 
+	 * pointers stored as offsets so the loaded resource can be used directly from the package.
+	 */
+	namespace PackageBaker
+	{
+		int32_t AddTexture(PackageContent* content, uint64_t guid, const Texture& texture);
+		int32_t AddMesh(PackageContent* content, const UnprocessedTriMesh& mesh);
+		int32_t AddMesh(PackageContent* content, uint64_t guid, const UnprocessedTriMesh& mesh);
+		// Textures are stored inside the material lib resource, after the materials
+		int32_t AddMaterialLib(PackageContent* content, uint64_t guid, const UnprocessedMaterialLib& materialLib);
+	}
+
+} // Graphics
+} // efw
\ No newline at end of file
@@ -2,10 +2,71 @@
 #include "Graphics/efwImageTypes.h"
 #include "Foundation/efwMemory.h"
 #include "Math/efwMath.h"
+#include "Foundation/efwCpuFeatures.h"
+
+#if defined(EFW_X86)
+#include <immintrin.h>
+#endif
 
 using namespace efw;
 using namespace efw::Graphics;
 
+
+#if defined(EFW_X86)
+EFW_TARGET_ISA("ssse3")
+static uint64_t CopyBGRAToRGBASSSE3(uint8_t* outData, const uint8_t* inData, uint64_t dataSize)
+{
+	const __m128i swizzleMask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	uint64_t i = 0;
+	for (; i+16<=dataSize; i+=16)
+	{
+		__m128i pixels = _mm_loadu_si128((const __m128i*)&inData[i]);
+		_mm_storeu_si128((__m128i*)&outData[i], _mm_shuffle_epi8(pixels, swizzleMask));
+	}
+	return i;
+}
+
+
+EFW_TARGET_ISA("avx2")
+static uint64_t CopyBGRAToRGBAAVX2(uint8_t* outData, const uint8_t* inData, uint64_t dataSize)
+{
+	// Shuffles stay within each 128-bit lane, so the mask is repeated
+	const __m256i swizzleMask = _mm256_setr_epi8(
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	uint64_t i = 0;
+	for (; i+32<=dataSize; i+=32)
+	{
+		__m256i pixels = _mm256_loadu_si256((const __m256i*)&inData[i]);
+		_mm256_storeu_si256((__m256i*)&outData[i], _mm256_shuffle_epi8(pixels, swizzleMask));
+	}
+	return i;
+}
+#endif
+
+
+static void CopyBGRAToRGBA(uint8_t* outData, const uint8_t* inData, uint64_t dataSize)
+{
+	EFW_ASSERT(dataSize%4==0);
+	uint64_t i = 0;
+
+#if defined(EFW_X86)
+	const int32_t simdTier = Cpu::GetSimdTier();
+	if (simdTier >= SimdTiers::kAVX2)
+		i = CopyBGRAToRGBAAVX2(outData, inData, dataSize);
+	if (simdTier >= SimdTiers::kSSE41)
+		i += CopyBGRAToRGBASSSE3(&outData[i], &inData[i], dataSize - i);
+#endif
+
+	for (; i<dataSize; i+=4)
+	{
+		outData[i+0] = inData[i+2];
+		outData[i+1] = inData[i+1];
+		outData[i+2] = inData[i+0];
+		outData[i+3] = inData[i+3];
+	}
+}
+
 void TextureReader::Release(Texture* outTexture)
 {
 	if (outTexture == NULL)
@@ -157,19 +218,9 @@ int32_t TextureReader::ReadTGA(Texture** outTexture, const char* filename, int32
 		(tgaHeader->bits == 32);
 	EFW_ASSERT(isValidTexture);
 
-	// Copy image data to VRAM
+	// Copy image data to VRAM, converting BGRA to RGBA
 	void* textureData = memalign(requiredDataAlignment, (size_t)imageDataSize);
-	memcpy(textureData, imageData, (size_t)imageDataSize);
-
-	// Convert BGRA to RGBA
-	EFW_ASSERT(imageDataSize%4==0);
-	for (int i=0; i<imageDataSize; i+=4)
-	{
-		uint8_t* textureDataU8 = &((uint8_t*)textureData)[i];
-		uint8_t temp = textureDataU8[0];
-		textureDataU8[0] = textureDataU8[2];
-		textureDataU8[2] = temp;
-	}
+	CopyBGRAToRGBA((uint8_t*)textureData, (const uint8_t*)imageData, imageDataSize);
 
 	// Copy out
 	Texture* result = (Texture*)memalign(16, sizeof(Texture));
@@ -190,19 +241,27 @@ int32_t TextureReader::ReadTGA(Texture** outTexture, const char* filename, int32
 
 int32_t TextureReader::ReadDDS(Texture** outTexture, const char* filename, int32_t requiredDataAlignment)
 {
-	ImageDDS::Header* ddsHeader = NULL;
-	ImageDDS::DX10Header* ddsDX10Header = NULL;
-	void* imageData = NULL;
-	void* textureFileData = NULL;
-	uint64_t textureFileSize = 0;
-
-	FileReader::ReadAll(&textureFileData, &textureFileSize, filename);
-	if (textureFileData != NULL && textureFileSize > sizeof(ImageDDS::Header))
-		ddsHeader = (ImageDDS::Header*)textureFileData;
+	// Map the file and copy the image data straight out of the view. Headers are copied as the view is read-only.
+	MappedFile textureFile;
+	FileReader::Map(&textureFile, filename, FileMapHints::kSequential);
+	const uint8_t* textureFileData = (const uint8_t*)textureFile.data;
+	uint64_t textureFileSize = textureFile.size;
+
+	ImageDDS::Header ddsHeader;
+	ImageDDS::DX10Header ddsDX10Header;
+	bool hasDX10Header = false;
+	const void* imageData = NULL;
+
+	if (textureFileData == NULL || textureFileSize <= sizeof(ImageDDS::Header))
+	{
+		FileReader::Unmap(&textureFile);
+		return efwErrs::kInvalidInput;
+	}
+	memcpy(&ddsHeader, textureFileData, sizeof(ImageDDS::Header));
 	
-	if (textureFileData == NULL || ddsHeader->signature != ImageDDS::kFileSignature || ddsHeader->size != efwEndianSwapIfRequired(ImageDDS::kHeaderSize))
+	if (ddsHeader.signature != ImageDDS::kFileSignature || ddsHeader.size != efwEndianSwapIfRequired(ImageDDS::kHeaderSize))
 	{
-		EFW_SAFE_ALIGNED_FREE(textureFileData);
+		FileReader::Unmap(&textureFile);
 		return efwErrs::kInvalidInput;
 	}
 
@@ -210,44 +269,51 @@ int32_t TextureReader::ReadDDS(Texture** outTexture, const char* filename, int32
 	EFW_ASSERT(sizeof(ImageDDS::Header) % 4 == 0);
 	for (int i=0; i<sizeof(ImageDDS::Header)/4; i++)
 	{
-		int32_t* data = &((int32_t*)ddsHeader)[i];
+		int32_t* data = &((int32_t*)&ddsHeader)[i];
 		*data = efwEndianSwapIfRequired(*data);
 	}
 
 	// Check flags
-	if ((ddsHeader->pixelFormat.flags & ImageDDS::kPixelFormatFlags_IsFourCC) != 0 &&
-		ddsHeader->pixelFormat.fourCC == ImageDDS::kPixelFormatFourCC_DX10)
+	if ((ddsHeader.pixelFormat.flags & ImageDDS::kPixelFormatFlags_IsFourCC) != 0 &&
+		ddsHeader.pixelFormat.fourCC == ImageDDS::kPixelFormatFourCC_DX10 &&
+		textureFileSize > sizeof(ImageDDS::Header) + sizeof(ImageDDS::DX10Header))
 	{
-		ddsDX10Header = (ImageDDS::DX10Header*)((uint8_t*)textureFileData + sizeof(ImageDDS::Header));
-		imageData = (uint8_t*)textureFileData + sizeof(ImageDDS::Header) + sizeof(ImageDDS::DX10Header);
+		hasDX10Header = true;
+		memcpy(&ddsDX10Header, textureFileData + sizeof(ImageDDS::Header), sizeof(ImageDDS::DX10Header));
+		imageData = textureFileData + sizeof(ImageDDS::Header) + sizeof(ImageDDS::DX10Header);
 	}
 	else
 	{
-		imageData = (uint8_t*)textureFileData + sizeof(ImageDDS::Header);
+		imageData = textureFileData + sizeof(ImageDDS::Header);
 	}
 
 	// Endian swap
-	if (ddsDX10Header != NULL)
+	if (hasDX10Header)
 	{
 		EFW_ASSERT(sizeof(ImageDDS::DX10Header) % 4 == 0);
 		for (int i=0; i<sizeof(ImageDDS::DX10Header)/4; i++)
 		{
-			int32_t* data = &((int32_t*)ddsDX10Header)[i];
+			int32_t* data = &((int32_t*)&ddsDX10Header)[i];
 			*data = efwEndianSwapIfRequired(*data);
 		}
 	}
 
 	// Get image desc
-	uint16_t width = (uint16_t)Math::Min(Math::Max(1, ddsHeader->width), UINT16_MAX);
-	uint16_t height = (uint16_t)Math::Min(Math::Max(1, ddsHeader->height), UINT16_MAX);
-	uint16_t depth = (uint16_t)Math::Min(Math::Max(1, ddsHeader->depth), UINT16_MAX);
-	uint16_t mipCount = (uint16_t)Math::Min(Math::Max(1, ddsHeader->mipMapCount), UINT16_MAX);
-	uint16_t textureFormat = ImageDDS::GetTextureFormat(ddsHeader);
+	uint16_t width = (uint16_t)Math::Min(Math::Max(1, ddsHeader.width), UINT16_MAX);
+	uint16_t height = (uint16_t)Math::Min(Math::Max(1, ddsHeader.height), UINT16_MAX);
+	uint16_t depth = (uint16_t)Math::Min(Math::Max(1, ddsHeader.depth), UINT16_MAX);
+	uint16_t mipCount = (uint16_t)Math::Min(Math::Max(1, ddsHeader.mipMapCount), UINT16_MAX);
+	uint16_t textureFormat = ImageDDS::GetTextureFormat(&ddsHeader);
 	uint16_t imageDataPitch = CalculatePitch(width, textureFormat);
 	
 	uint64_t imageDataSize = CalculateSize(width, height, depth, mipCount, textureFormat);
 	uint64_t checkImageDataSize = textureFileSize - ((uintptr_t)imageData - (uintptr_t)textureFileData);
 	EFW_ASSERT(imageDataSize == checkImageDataSize);
+	if (imageDataSize > checkImageDataSize)
+	{
+		FileReader::Unmap(&textureFile);
+		return efwErrs::kCorruptedData;
+	}
 
 	// Copy image data to VRAM
 	void* textureData = memalign(requiredDataAlignment, (size_t)imageDataSize);
@@ -265,6 +331,6 @@ int32_t TextureReader::ReadDDS(Texture** outTexture, const char* filename, int32
 	result->data = textureData;
 	*outTexture = result;
 
-	EFW_SAFE_ALIGNED_FREE(textureFileData);
+	FileReader::Unmap(&textureFile);
 	return efwErrs::kOk;
 }
\ No newline at end of file
@@ -27,6 +27,32 @@ namespace Graphics
 		const int32_t kCompressed16b_CCW = 2;
 	}
 
+	namespace TriMeshPrimitiveTypes
+	{
+		const uint16_t kTriangleList = 0;
+	}
+
+	namespace TriMeshVertexFormats
+	{
+		const uint8_t kInvalidFormat = 0;
+		const uint8_t kF32 = 1;
+		const uint8_t kF16 = 2;
+		const uint8_t kS16Norm = 3;
+		const uint8_t kU16Norm = 4;
+		const uint8_t kU8Norm = 5;
+		const uint8_t kX10Y11Z11 = 6;				// Unsigned normalized, packed in 32b from the least significant bit
+	}
+
+	// How quantized attribute values were remapped before being stored
+	namespace TriMeshVertexEncodings
+	{
+		const uint8_t kNone = 0;
+		const uint8_t kSignedToUnsigned = 1;		// Values in [-1, 1] stored in [0, 1]
+		const uint8_t kScaleAndBias = 2;			// Values stored in [0, 1] from the attribute range
+		const uint8_t kNormalAzimuthalProjection = 3;
+		const uint8_t kNormalSphereMapping = 4;
+	}
+
 	//namespace TriMeshVertexFixedFormats
 	//{
 	//	const int32_t kInvalidFormat = 0;
@@ -49,18 +75,36 @@ namespace Graphics
 		uint8_t dataOffset;
 		uint8_t componentCount;				// 1/2/3/4
 		uint8_t vertexShaderRegister;		// 0..16
+		uint8_t attribute;					// VertexAttributes the data came from
+		uint8_t encoding;					// TriMeshVertexEncodings
+		uint8_t _pad[2];
+
+		// Stored values map back to the attribute values as value * scale + bias
+		float scale[4];
+		float bias[4];
 	};
 
 
+	/**
+	 * Cluster of triangles indexing a bounded range of vertices, so its indices are local to the chunk and can be 
+	 * culled on its own. The chunk faces away from the camera when 
+	 * dot(center - camera, coneAxis) >= coneCutoff * length(center - camera) + radius.
+	 */
 	struct TriMeshChunk
 	{
 		// Can be either 16b CCW non-compressed, or 16b CCW compressed
 		// Does it make sense to compress things with 6 or less indices?
-		uintptr_t indexData;
+		uintptr_t indexData;				// Byte offset of the first index until relocated
+		uint32_t indexDataSize;
 		uint32_t indexCount;
+		uint32_t vertexOffset;				// First vertex used by the chunk, indices are relative to it
+		uint16_t vertexCount;
 		
 		uint16_t primitiveType;
 		//uint16_t indexFormat; // Indices are always 16b for now
+
+		float boundingSphere[4];			// Center XYZ and radius
+		float normalCone[4];				// Axis XYZ and cutoff, a cutoff of 1 means the chunk is never back facing
 	};
 
 	
@@ -72,19 +116,22 @@ namespace Graphics
 		uintptr_t vertexGpuData;
 
 		// Interleaved data on CPU
-		uint16_t vertexCpuCount;
+		uint32_t vertexCpuCount;
 		uint16_t vertexCpuStrideInBytes;
 		uint16_t vertexCpuAttributeCount;
 		TriMeshVertexAttribute vertexCpuAttributes[16];
 
 		// Interleaved data on GPU
-		uint16_t vertexGpuCount;
+		uint32_t vertexGpuCount;
 		uint16_t vertexGpuDataStrideInBytes;
-		uint16_t vertexCpuAttributeCount;
+		uint16_t vertexGpuAttributeCount;
 		TriMeshVertexAttribute vertexGpuAttributes[16];
 
+		int32_t indexFormat;				// TriMeshIndexFormats of every chunk
+		float boundingSphere[4];
+
 		// Chunks
-		uint16_t meshChunkCount;
+		uint32_t meshChunkCount;
 		TriMeshChunk meshChunks[];
 	};
 
@@ -0,0 +1,326 @@
+#include "Graphics/efwTriMeshConverter.h"
+
+#include "Foundation/efwPointerTypes.h"
+#include "Graphics/efwTriMeshIndexCodec.h"
+#include "Graphics/efwUnprocessedTriMeshHelper.h"
+#include "Math/efwMath.h"
+
+using namespace efw;
+using namespace efw::Graphics;
+
+static const uint32_t kMaxStreamAttributes = EFW_COUNTOF(((TriMesh*)NULL)->vertexCpuAttributes);
+static const uint32_t kDataAlignment = 16;
+
+
+static uint32_t GetFormatComponentSize(uint8_t dataFormat)
+{
+	switch (dataFormat)
+	{
+	case TriMeshVertexFormats::kF32:		return sizeof(float);
+	case TriMeshVertexFormats::kF16:
+	case TriMeshVertexFormats::kS16Norm:
+	case TriMeshVertexFormats::kU16Norm:	return sizeof(uint16_t);
+	case TriMeshVertexFormats::kU8Norm:		return sizeof(uint8_t);
+	case TriMeshVertexFormats::kX10Y11Z11:	return sizeof(uint32_t);
+	}
+	return 0;
+}
+
+
+static uint32_t GetElementSize(const TriMeshVertexAttribute& attribute)
+{
+	if (attribute.dataFormat == TriMeshVertexFormats::kX10Y11Z11)
+		return sizeof(uint32_t);
+	return GetFormatComponentSize(attribute.dataFormat) * attribute.componentCount;
+}
+
+
+/**
+ * Encodes an attribute of every mesh vertex in the element format, tightly packed. Normals are encoded with 
+ * CompressTangentSpace first, and unsigned normalized formats are quantized with CompressVertexAttribute.
+ */
+static int32_t EncodeVertexElement(uint8_t** outData, TriMeshVertexAttribute* outAttribute, const UnprocessedTriMesh& mesh, 
+	const TriMeshVertexElement& element)
+{
+	if (element.attribute >= VertexAttributes::kCount || mesh.vertexAttributes[element.attribute].componentCount == 0 || 
+		GetFormatComponentSize(element.dataFormat) == 0)
+		return efwErrs::kInvalidInput;
+
+	const bool isUnsignedNorm = (element.dataFormat == TriMeshVertexFormats::kU8Norm || element.dataFormat == TriMeshVertexFormats::kU16Norm || 
+		element.dataFormat == TriMeshVertexFormats::kX10Y11Z11);
+	const bool isNormalEncoding = (element.encoding == TriMeshVertexEncodings::kNormalAzimuthalProjection || 
+		element.encoding == TriMeshVertexEncodings::kNormalSphereMapping);
+	if ((element.encoding == TriMeshVertexEncodings::kSignedToUnsigned || element.encoding == TriMeshVertexEncodings::kScaleAndBias) && !isUnsignedNorm)
+		return efwErrs::kInvalidInput;
+	if (element.encoding > TriMeshVertexEncodings::kNormalSphereMapping || (isNormalEncoding && element.attribute != VertexAttributes::kNormal))
+		return efwErrs::kInvalidInput;
+
+	memset(outAttribute, 0, sizeof(TriMeshVertexAttribute));
+	outAttribute->dataFormat = element.dataFormat;
+	outAttribute->vertexShaderRegister = element.vertexShaderRegister;
+	outAttribute->attribute = (uint8_t)element.attribute;
+	outAttribute->encoding = element.encoding;
+
+	// Values to store, normals are first encoded in two unsigned normalized components
+	const float* values = (const float*)mesh.vertexData;
+	int32_t valueStride = mesh.vertexStride;
+	UnprocessedTriMeshVertexAttribute valueAttribute = mesh.vertexAttributes[element.attribute];
+	ScopedPtr<float> encodedNormals;
+	if (isNormalEncoding)
+	{
+		UnprocessedTriMeshVertexAttribute vertexAttributes[VertexAttributes::kCount];
+		memcpy(vertexAttributes, mesh.vertexAttributes, sizeof(vertexAttributes));
+
+		void* encodedNormalData = NULL;
+		int32_t result = UnprocessedTriMeshHelper::CompressTangentSpace(&encodedNormalData, (const float*)mesh.vertexData, mesh.vertexStride, 
+			mesh.vertexCount, vertexAttributes, (element.encoding == TriMeshVertexEncodings::kNormalAzimuthalProjection)? 
+			TangentFrameCompressions::k64bNormalOnly_AzimuthalProjection : TangentFrameCompressions::k64bNormalOnly_SphereMapping);
+		if (result != efwErrs::kOk)
+			return result;
+
+		encodedNormals.Reset((float*)encodedNormalData);
+		values = encodedNormals;
+		valueStride = 2 * sizeof(float);
+		valueAttribute.componentCount = 2;
+		valueAttribute.offset = 0;
+	}
+
+	outAttribute->componentCount = valueAttribute.componentCount;
+	if (element.dataFormat == TriMeshVertexFormats::kX10Y11Z11 && valueAttribute.componentCount != 3)
+		return efwErrs::kInvalidInput;
+	for (int32_t i=0; i<4; ++i)
+	{
+		outAttribute->scale[i] = 1.0f;
+		outAttribute->bias[i] = 0.0f;
+	}
+
+	const uint32_t vertexCount = mesh.vertexCount;
+	const uint32_t componentCount = valueAttribute.componentCount;
+	const int32_t valueComponents = valueStride / sizeof(float);
+	const float* attributeValues = (const float*)( (const uint8_t*)values + valueAttribute.offset );
+
+	if (isUnsignedNorm)
+	{
+		AttributeCompression compression = AttributeCompressions::kUFloatNormToU16Norm;
+		if (element.encoding == TriMeshVertexEncodings::kSignedToUnsigned)
+			compression = AttributeCompressions::kSFloatNormToU16Norm;
+		else if (element.encoding == TriMeshVertexEncodings::kScaleAndBias)
+			compression = AttributeCompressions::kSFloatToU16NormWithScaleAndBias;
+
+		if (element.dataFormat == TriMeshVertexFormats::kU8Norm)
+		{
+			compression = (compression == AttributeCompressions::kUFloatNormToU16Norm)? AttributeCompressions::kUFloatNormToU8Norm : 
+				(compression == AttributeCompressions::kSFloatNormToU16Norm)? AttributeCompressions::kSFloatNormToU8Norm : 
+				AttributeCompressions::kSFloatToU8NormWithScaleAndBias;
+		}
+
+		void* compressedData = NULL;
+		int32_t result = UnprocessedTriMeshHelper::CompressVertexAttribute(&compressedData, values, valueStride, vertexCount, valueAttribute, 
+			compression, outAttribute->scale, outAttribute->bias);
+		if (result != efwErrs::kOk)
+			return result;
+
+		if (element.encoding == TriMeshVertexEncodings::kSignedToUnsigned)
+		{
+			for (int32_t i=0; i<4; ++i)
+			{
+				outAttribute->scale[i] = 2.0f;
+				outAttribute->bias[i] = -1.0f;
+			}
+		}
+
+		// Packed normals keep the most significant bits of the 16b quantization
+		if (element.dataFormat == TriMeshVertexFormats::kX10Y11Z11)
+		{
+			const uint16_t* components = (const uint16_t*)compressedData;
+			uint32_t* packedData = (uint32_t*)memalign(kDataAlignment, vertexCount * sizeof(uint32_t) + 1);
+			for (uint32_t i=0; i<vertexCount; ++i)
+			{
+				packedData[i] = ((uint32_t)components[i*3+0] >> 6) | (((uint32_t)components[i*3+1] >> 5) << 10) | 
+					(((uint32_t)components[i*3+2] >> 5) << 21);
+			}
+			FreeAlignSafe(compressedData);
+			compressedData = packedData;
+		}
+
+		*outData = (uint8_t*)compressedData;
+		return efwErrs::kOk;
+	}
+
+	uint8_t* data = (uint8_t*)memalign(kDataAlignment, vertexCount * GetElementSize(*outAttribute) + 1);
+	for (uint32_t i=0; i<vertexCount; ++i)
+	{
+		const float* value = &attributeValues[i * valueComponents];
+		for (uint32_t j=0; j<componentCount; ++j)
+		{
+			if (element.dataFormat == TriMeshVertexFormats::kF32)
+				((float*)data)[i*componentCount + j] = value[j];
+			else if (element.dataFormat == TriMeshVertexFormats::kF16)
+				((uint16_t*)data)[i*componentCount + j] = Math::FloatToHalf(value[j]);
+			else
+			{
+				float snorm = Math::Clamp(value[j], -1.0f, 1.0f) * 32767.0f;
+				((int16_t*)data)[i*componentCount + j] = (int16_t)((snorm >= 0.0f)? snorm + 0.5f : snorm - 0.5f);
+			}
+		}
+	}
+
+	*outData = data;
+	return efwErrs::kOk;
+}
+
+
+int32_t TriMeshConverter::Convert(TriMesh** outMesh, const UnprocessedTriMesh& mesh, const TriMeshLayout& layout)
+{
+	if (outMesh == NULL || layout.elementCount > EFW_COUNTOF(layout.elements) || mesh.vertexData == NULL)
+		return efwErrs::kInvalidInput;
+	if (layout.indexFormat != TriMeshIndexFormats::k16b_CCW && layout.indexFormat != TriMeshIndexFormats::kCompressed16b_CCW)
+		return efwErrs::kInvalidInput;
+	*outMesh = NULL;
+
+	UnprocessedTriMeshChunks chunks;
+	int32_t result = UnprocessedTriMeshHelper::BuildMeshChunks(&chunks, mesh, layout.maxChunkVertices, layout.maxChunkTriangles);
+	if (result != efwErrs::kOk)
+		return result;
+
+	// Each element is encoded for every mesh vertex, then gathered into its stream for every chunk vertex
+	uint8_t* elementData[EFW_COUNTOF(layout.elements)];
+	TriMeshVertexAttribute elementAttributes[EFW_COUNTOF(layout.elements)];
+	uint32_t streamAttributeCounts[2] = { 0, 0 };
+	uint32_t streamStrides[2] = { 0, 0 };
+	memset(elementData, 0, sizeof(elementData));
+
+	for (uint32_t i=0; i<layout.elementCount && result == efwErrs::kOk; ++i)
+	{
+		const TriMeshVertexElement& element = layout.elements[i];
+		if (element.stream > TriMeshVertexStreams::kGpu || streamAttributeCounts[element.stream] == kMaxStreamAttributes)
+		{
+			result = efwErrs::kInvalidInput;
+			break;
+		}
+
+		result = EncodeVertexElement(&elementData[i], &elementAttributes[i], mesh, element);
+		if (result != efwErrs::kOk)
+			break;
+
+		// Components are aligned to their size, up to 32b
+		uint32_t alignment = Math::Min(GetFormatComponentSize(element.dataFormat), (uint32_t)sizeof(uint32_t));
+		uint32_t offset = EFW_ALIGN(alignment, streamStrides[element.stream]);
+		elementAttributes[i].dataOffset = (uint8_t)offset;
+		streamStrides[element.stream] = offset + GetElementSize(elementAttributes[i]);
+		streamAttributeCounts[element.stream]++;
+		if (streamStrides[element.stream] > 0xFF)
+			result = efwErrs::kInvalidInput;
+	}
+	for (uint32_t i=0; i<2; ++i)
+		streamStrides[i] = EFW_ALIGN(sizeof(uint32_t), streamStrides[i]);
+
+	// Chunk indices are widened to 16b, then compressed when needed
+	uint16_t* indices = NULL;
+	uint8_t* compressedIndices = NULL;
+	uint32_t indexDataSize = 0;
+	if (result == efwErrs::kOk)
+	{
+		indices = (uint16_t*)memalign(kDataAlignment, (chunks.localIndexCount + 1) * sizeof(uint16_t));
+		for (uint32_t i=0; i<chunks.localIndexCount; ++i)
+		{
+			indices[i] = (chunks.localIndexStride == sizeof(uint8_t))? ((const uint8_t*)chunks.localIndices)[i] : 
+				((const uint16_t*)chunks.localIndices)[i];
+		}
+
+		if (layout.indexFormat == TriMeshIndexFormats::kCompressed16b_CCW)
+		{
+			// Room for the byte padding each chunk to 16b
+			uint32_t maxIndexDataSize = 0;
+			for (uint32_t i=0; i<chunks.chunkCount; ++i)
+				maxIndexDataSize += EFW_ALIGN(sizeof(uint16_t), TriMeshIndexCodec::GetMaxEncodedSize(chunks.chunks[i].indexCount));
+			compressedIndices = (uint8_t*)memalign(kDataAlignment, maxIndexDataSize);
+		}
+
+		for (uint32_t i=0; i<chunks.chunkCount && result == efwErrs::kOk; ++i)
+		{
+			TriMeshChunk& chunk = chunks.chunks[i];
+			const uint16_t* chunkIndices = &indices[chunk.indexData / chunks.localIndexStride];
+			if (compressedIndices != NULL)
+			{
+				uint32_t maxChunkDataSize = TriMeshIndexCodec::GetMaxEncodedSize(chunk.indexCount);
+				result = TriMeshIndexCodec::Encode(&compressedIndices[indexDataSize], &chunk.indexDataSize, maxChunkDataSize, chunkIndices, chunk.indexCount);
+				if (result == efwErrs::kOk && (chunk.indexDataSize & 1) != 0)
+					compressedIndices[indexDataSize + chunk.indexDataSize] = 0;
+			}
+			else
+				chunk.indexDataSize = chunk.indexCount * sizeof(uint16_t);
+
+			// Offset in the final index data, and chunks keep it 16b aligned
+			chunk.indexData = indexDataSize;
+			indexDataSize += EFW_ALIGN(sizeof(uint16_t), chunk.indexDataSize);
+		}
+	}
+
+	TriMesh* triMesh = NULL;
+	if (result == efwErrs::kOk)
+	{
+		const uint32_t vertexCount = chunks.vertexIndexCount;
+		const uint32_t headerSize = EFW_ALIGN(kDataAlignment, sizeof(TriMesh) + chunks.chunkCount * sizeof(TriMeshChunk));
+		const uint32_t cpuDataSize = EFW_ALIGN(kDataAlignment, vertexCount * streamStrides[TriMeshVertexStreams::kCpu]);
+		const uint32_t gpuDataSize = EFW_ALIGN(kDataAlignment, vertexCount * streamStrides[TriMeshVertexStreams::kGpu]);
+
+		uint8_t* meshData = (uint8_t*)memalign(kDataAlignment, headerSize + cpuDataSize + gpuDataSize + indexDataSize);
+		memset(meshData, 0, headerSize + cpuDataSize + gpuDataSize + indexDataSize);
+		triMesh = (TriMesh*)meshData;
+		uint8_t* streamData[2] = { meshData + headerSize, meshData + headerSize + cpuDataSize };
+		uint8_t* indexData = meshData + headerSize + cpuDataSize + gpuDataSize;
+
+		triMesh->vertexCpuData = (uintptr_t)streamData[TriMeshVertexStreams::kCpu];
+		triMesh->vertexGpuData = (uintptr_t)streamData[TriMeshVertexStreams::kGpu];
+		triMesh->vertexCpuCount = (streamStrides[TriMeshVertexStreams::kCpu] > 0)? vertexCount : 0;
+		triMesh->vertexCpuStrideInBytes = (uint16_t)streamStrides[TriMeshVertexStreams::kCpu];
+		triMesh->vertexGpuCount = (streamStrides[TriMeshVertexStreams::kGpu] > 0)? vertexCount : 0;
+		triMesh->vertexGpuDataStrideInBytes = (uint16_t)streamStrides[TriMeshVertexStreams::kGpu];
+		triMesh->indexFormat = layout.indexFormat;
+		UnprocessedTriMeshHelper::GenerateBoundingSphere(triMesh->boundingSphere, mesh);
+
+		for (uint32_t i=0; i<layout.elementCount; ++i)
+		{
+			const uint8_t stream = layout.elements[i].stream;
+			if (stream == TriMeshVertexStreams::kCpu)
+				triMesh->vertexCpuAttributes[triMesh->vertexCpuAttributeCount++] = elementAttributes[i];
+			else
+				triMesh->vertexGpuAttributes[triMesh->vertexGpuAttributeCount++] = elementAttributes[i];
+
+			const uint32_t elementSize = GetElementSize(elementAttributes[i]);
+			uint8_t* vertex = streamData[stream] + elementAttributes[i].dataOffset;
+			for (uint32_t j=0; j<vertexCount; ++j)
+			{
+				memcpy(vertex, &elementData[i][chunks.vertexIndices[j] * elementSize], elementSize);
+				vertex += streamStrides[stream];
+			}
+		}
+
+		// Uncompressed chunk indices are already contiguous
+		EFW_ASSERT(compressedIndices != NULL || indexDataSize == chunks.localIndexCount * sizeof(uint16_t));
+		memcpy(indexData, (compressedIndices != NULL)? compressedIndices : (const uint8_t*)indices, indexDataSize);
+
+		triMesh->meshChunkCount = chunks.chunkCount;
+		for (uint32_t i=0; i<chunks.chunkCount; ++i)
+		{
+			triMesh->meshChunks[i] = chunks.chunks[i];
+			triMesh->meshChunks[i].indexData = (uintptr_t)(indexData + chunks.chunks[i].indexData);
+		}
+	}
+
+	for (uint32_t i=0; i<layout.elementCount; ++i)
+		FreeAlignSafe(elementData[i]);
+	FreeAlignSafe(indices);
+	FreeAlignSafe(compressedIndices);
+	UnprocessedTriMeshHelper::Release(&chunks);
+
+	*outMesh = triMesh;
+	return result;
+}
+
+
+void TriMeshConverter::Release(TriMesh* mesh)
+{
+	FreeAlignSafe(mesh);
+}
\ No newline at end of file
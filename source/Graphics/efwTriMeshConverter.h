@@ -0,0 +1,65 @@
+/**
+ * Copyright (C) 2012 Bruno P. Evangelista. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "Foundation/efwPlatform.h"
+#include "Graphics/efwTriMesh.h"
+#include "Graphics/efwUnprocessedTriMesh.h"
+
+namespace efw
+{
+namespace Graphics
+{
+	namespace TriMeshVertexStreams
+	{
+		const uint8_t kCpu = 0;
+		const uint8_t kGpu = 1;
+	}
+
+	// Where and how an attribute of the unprocessed mesh is stored in the runtime mesh
+	struct TriMeshVertexElement
+	{
+		uint16_t attribute;					// VertexAttributes
+		uint8_t stream;						// TriMeshVertexStreams
+		uint8_t dataFormat;					// TriMeshVertexFormats
+		uint8_t encoding;					// TriMeshVertexEncodings
+		uint8_t vertexShaderRegister;
+		uint8_t _pad[2];
+	};
+
+	struct TriMeshLayout
+	{
+		uint32_t elementCount;
+		TriMeshVertexElement elements[32];
+
+		int32_t indexFormat;				// TriMeshIndexFormats
+		uint32_t maxChunkVertices;
+		uint32_t maxChunkTriangles;
+	};
+
+	namespace TriMeshConverter
+	{
+		/**
+		 * Converts an unprocessed mesh to a runtime mesh with the given layout. Chunks are built from the mesh triangle 
+		 * order, so optimize its vertex cache first. The mesh, its chunks and all its data are a single allocation.
+		 * 
+		 * Signed to unsigned and scale and bias encodings need an unsigned normalized format, and normal encodings store 
+		 * two components.
+		 */
+		int32_t Convert(TriMesh** outMesh, const UnprocessedTriMesh& mesh, const TriMeshLayout& layout);
+		void Release(TriMesh* mesh);
+	}
+
+} // Graphics
+} // efw
\ No newline at end of file
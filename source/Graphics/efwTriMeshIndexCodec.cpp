@@ -0,0 +1,334 @@
+#include "Graphics/efwTriMeshIndexCodec.h"
+
+using namespace efw;
+using namespace efw::Graphics;
+
+/**
+ * Code bytes:
+ * 0x00-0xEF Edge (code >> 4) of the edge FIFO, and third vertex (code & 0xF): 0 is the next new vertex, 1-14 an entry of 
+ *           the vertex FIFO, and 15 a vertex reference in the data section.
+ * 0xF0      Next three new vertices.
+ * 0xFF      Three vertex references in the data section.
+ *
+ * Vertex references are varints: 0 is the next new vertex, 1-16 an entry of the vertex FIFO, and above it the zigzag 
+ * delta from the last explicit vertex. Vertices not coming from the vertex FIFO are pushed to it, and the three edges of 
+ * every triangle are pushed reversed to the edge FIFO, so triangles sharing them with the same winding find them.
+ */
+static const int32_t kFifoSize = 16;
+static const int32_t kMaxEdgeFifoCode = 14;
+static const int32_t kMaxVertexFifoCode = 14;
+static const uint8_t kThirdVertexNext = 0;
+static const uint8_t kThirdVertexReference = 15;
+static const uint8_t kCodeNewTriangle = 0xF0;
+static const uint8_t kCodeReferencedTriangle = 0xFF;
+static const uint32_t kReferenceNext = 0;
+static const uint32_t kReferenceExplicit = 1 + kFifoSize;
+
+struct IndexCodecState
+{
+	uint16_t edgeFifo[kFifoSize][2];
+	uint16_t vertexFifo[kFifoSize];
+	uint32_t edgeFifoOffset;
+	uint32_t vertexFifoOffset;
+	uint32_t nextVertex;
+	int32_t lastExplicitVertex;
+};
+
+
+static void InitState(IndexCodecState* state)
+{
+	memset(state, 0xFF, sizeof(state->edgeFifo) + sizeof(state->vertexFifo));
+	state->edgeFifoOffset = 0;
+	state->vertexFifoOffset = 0;
+	state->nextVertex = 0;
+	state->lastExplicitVertex = 0;
+}
+
+
+// FIFO entries are numbered from the most recent one
+static EFW_INLINE uint16_t* GetEdge(IndexCodecState* state, int32_t index)
+{
+	return state->edgeFifo[(state->edgeFifoOffset - 1 - index) & (kFifoSize - 1)];
+}
+
+
+static EFW_INLINE uint16_t GetVertex(const IndexCodecState* state, int32_t index)
+{
+	return state->vertexFifo[(state->vertexFifoOffset - 1 - index) & (kFifoSize - 1)];
+}
+
+
+static EFW_INLINE void PushVertex(IndexCodecState* state, uint16_t vertex)
+{
+	state->vertexFifo[state->vertexFifoOffset++ & (kFifoSize - 1)] = vertex;
+}
+
+
+static EFW_INLINE void PushTriangleEdges(IndexCodecState* state, uint16_t a, uint16_t b, uint16_t c)
+{
+	uint16_t* edge = state->edgeFifo[state->edgeFifoOffset++ & (kFifoSize - 1)];
+	edge[0] = b; edge[1] = a;
+	edge = state->edgeFifo[state->edgeFifoOffset++ & (kFifoSize - 1)];
+	edge[0] = c; edge[1] = b;
+	edge = state->edgeFifo[state->edgeFifoOffset++ & (kFifoSize - 1)];
+	edge[0] = a; edge[1] = c;
+}
+
+
+static EFW_INLINE int32_t FindVertex(const IndexCodecState* state, uint16_t vertex, int32_t maxIndex)
+{
+	for (int32_t i=0; i<=maxIndex; ++i)
+	{
+		if (GetVertex(state, i) == vertex)
+			return i;
+	}
+	return -1;
+}
+
+
+static EFW_INLINE uint8_t* WriteVarint(uint8_t* data, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		*data++ = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	*data++ = (uint8_t)value;
+	return data;
+}
+
+
+static EFW_INLINE const uint8_t* ReadVarint(const uint8_t* data, const uint8_t* dataEnd, uint32_t* outValue)
+{
+	uint32_t value = 0;
+	for (int32_t shift=0; shift<35 && data < dataEnd; shift+=7)
+	{
+		uint8_t byte = *data++;
+		value |= (uint32_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			*outValue = value;
+			return data;
+		}
+	}
+	return NULL;
+}
+
+
+static uint8_t* WriteVertexReference(uint8_t* data, IndexCodecState* state, uint16_t vertex)
+{
+	if (vertex == state->nextVertex)
+	{
+		state->nextVertex++;
+		PushVertex(state, vertex);
+		return WriteVarint(data, kReferenceNext);
+	}
+
+	int32_t fifoIndex = FindVertex(state, vertex, kFifoSize - 1);
+	if (fifoIndex >= 0)
+		return WriteVarint(data, 1 + fifoIndex);
+
+	int32_t delta = (int32_t)vertex - state->lastExplicitVertex;
+	state->lastExplicitVertex = vertex;
+	PushVertex(state, vertex);
+	return WriteVarint(data, kReferenceExplicit + (((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31)));
+}
+
+
+static const uint8_t* ReadVertexReference(const uint8_t* data, const uint8_t* dataEnd, IndexCodecState* state, uint32_t vertexCount, 
+	uint16_t* outVertex)
+{
+	uint32_t reference;
+	data = ReadVarint(data, dataEnd, &reference);
+	if (data == NULL)
+		return NULL;
+
+	if (reference == kReferenceNext)
+	{
+		*outVertex = (uint16_t)state->nextVertex++;
+		PushVertex(state, *outVertex);
+	}
+	else if (reference < kReferenceExplicit)
+		*outVertex = GetVertex(state, reference - 1);
+	else
+	{
+		uint32_t zigzag = reference - kReferenceExplicit;
+		int64_t vertex = (int64_t)state->lastExplicitVertex + ((int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1));
+		if (vertex < 0 || vertex >= (int64_t)vertexCount)
+			return NULL;
+		state->lastExplicitVertex = (int32_t)vertex;
+		*outVertex = (uint16_t)vertex;
+		PushVertex(state, *outVertex);
+	}
+	return data;
+}
+
+
+uint32_t TriMeshIndexCodec::GetMaxEncodedSize(uint32_t indexCount)
+{
+	// Vertex references of 16b indices take at most 3 bytes
+	const uint32_t triangleCount = indexCount / 3;
+	return 1 + triangleCount + triangleCount * 3 * 3;
+}
+
+
+int32_t TriMeshIndexCodec::Encode(uint8_t* outData, uint32_t* outDataSize, uint32_t maxDataSize, const uint16_t* indices, uint32_t indexCount)
+{
+	if (outData == NULL || outDataSize == NULL || (indices == NULL && indexCount > 0) || (indexCount % 3) != 0)
+		return efwErrs::kInvalidInput;
+	if (maxDataSize < GetMaxEncodedSize(indexCount))
+		return efwErrs::kInvalidInput;
+
+	const uint32_t triangleCount = indexCount / 3;
+	uint8_t* codes = outData + 1;
+	uint8_t* data = codes + triangleCount;
+	outData[0] = kVersion;
+
+	IndexCodecState state;
+	InitState(&state);
+
+	for (uint32_t i=0; i<triangleCount; ++i)
+	{
+		const uint16_t* triangle = &indices[i*3];
+
+		// Most recent edge first, rotating the triangle so the edge comes first
+		int32_t edgeIndex = -1;
+		int32_t rotation = 0;
+		for (int32_t j=0; j<=kMaxEdgeFifoCode && edgeIndex < 0; ++j)
+		{
+			const uint16_t* edge = GetEdge(&state, j);
+			for (int32_t k=0; k<3; ++k)
+			{
+				if (triangle[k] == edge[0] && triangle[(k+1)%3] == edge[1])
+				{
+					edgeIndex = j;
+					rotation = k;
+					break;
+				}
+			}
+		}
+
+		if (edgeIndex >= 0)
+		{
+			const uint16_t a = triangle[rotation];
+			const uint16_t b = triangle[(rotation+1)%3];
+			const uint16_t c = triangle[(rotation+2)%3];
+
+			uint8_t thirdVertex = kThirdVertexNext;
+			int32_t fifoIndex = FindVertex(&state, c, kMaxVertexFifoCode - 1);
+			if (c == state.nextVertex)
+			{
+				state.nextVertex++;
+				PushVertex(&state, c);
+			}
+			else if (fifoIndex >= 0)
+				thirdVertex = (uint8_t)(1 + fifoIndex);
+			else
+			{
+				thirdVertex = kThirdVertexReference;
+				data = WriteVertexReference(data, &state, c);
+			}
+
+			codes[i] = (uint8_t)((edgeIndex << 4) | thirdVertex);
+			PushTriangleEdges(&state, a, b, c);
+			continue;
+		}
+
+		rotation = -1;
+		for (int32_t k=0; k<3 && rotation < 0; ++k)
+		{
+			if (triangle[k] == state.nextVertex && triangle[(k+1)%3] == state.nextVertex + 1 && triangle[(k+2)%3] == state.nextVertex + 2)
+				rotation = k;
+		}
+
+		if (rotation >= 0)
+		{
+			codes[i] = kCodeNewTriangle;
+			for (int32_t k=0; k<3; ++k)
+				PushVertex(&state, (uint16_t)(state.nextVertex + k));
+			state.nextVertex += 3;
+			PushTriangleEdges(&state, triangle[rotation], triangle[(rotation+1)%3], triangle[(rotation+2)%3]);
+		}
+		else
+		{
+			codes[i] = kCodeReferencedTriangle;
+			for (int32_t k=0; k<3; ++k)
+				data = WriteVertexReference(data, &state, triangle[k]);
+			PushTriangleEdges(&state, triangle[0], triangle[1], triangle[2]);
+		}
+	}
+
+	*outDataSize = (uint32_t)(data - outData);
+	return efwErrs::kOk;
+}
+
+
+int32_t TriMeshIndexCodec::Decode(uint16_t* outIndices, uint32_t indexCount, uint32_t vertexCount, const uint8_t* data, uint32_t dataSize)
+{
+	if ((outIndices == NULL && indexCount > 0) || data == NULL || (indexCount % 3) != 0)
+		return efwErrs::kInvalidInput;
+
+	const uint32_t triangleCount = indexCount / 3;
+	if (dataSize < 1 + triangleCount || data[0] != kVersion)
+		return efwErrs::kCorruptedData;
+
+	const uint8_t* codes = data + 1;
+	const uint8_t* dataEnd = data + dataSize;
+	data = codes + triangleCount;
+
+	IndexCodecState state;
+	InitState(&state);
+
+	for (uint32_t i=0; i<triangleCount; ++i)
+	{
+		uint16_t* triangle = &outIndices[i*3];
+		const uint8_t code = codes[i];
+
+		if (code < kCodeNewTriangle)
+		{
+			const uint16_t* edge = GetEdge(&state, code >> 4);
+			triangle[0] = edge[0];
+			triangle[1] = edge[1];
+
+			const uint8_t thirdVertex = code & 0xF;
+			if (thirdVertex == kThirdVertexNext)
+			{
+				triangle[2] = (uint16_t)state.nextVertex++;
+				PushVertex(&state, triangle[2]);
+			}
+			else if (thirdVertex < kThirdVertexReference)
+				triangle[2] = GetVertex(&state, thirdVertex - 1);
+			else
+			{
+				data = ReadVertexReference(data, dataEnd, &state, vertexCount, &triangle[2]);
+				if (data == NULL)
+					return efwErrs::kCorruptedData;
+			}
+		}
+		else if (code == kCodeNewTriangle)
+		{
+			for (int32_t k=0; k<3; ++k)
+			{
+				triangle[k] = (uint16_t)state.nextVertex++;
+				PushVertex(&state, triangle[k]);
+			}
+		}
+		else if (code == kCodeReferencedTriangle)
+		{
+			for (int32_t k=0; k<3 && data != NULL; ++k)
+				data = ReadVertexReference(data, dataEnd, &state, vertexCount, &triangle[k]);
+			if (data == NULL)
+				return efwErrs::kCorruptedData;
+		}
+		else
+			return efwErrs::kCorruptedData;
+
+		// Catches new vertices past the chunk, and FIFO entries never written, which are 0xFFFF
+		if (state.nextVertex > vertexCount || triangle[0] >= vertexCount || triangle[1] >= vertexCount || triangle[2] >= vertexCount)
+			return efwErrs::kCorruptedData;
+
+		PushTriangleEdges(&state, triangle[0], triangle[1], triangle[2]);
+	}
+
+	return efwErrs::kOk;
+}
\ No newline at end of file
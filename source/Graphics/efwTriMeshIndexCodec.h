@@ -0,0 +1,46 @@
+/**
+ * Copyright (C) 2012 Bruno P. Evangelista. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "Foundation/efwPlatform.h"
+
+namespace efw
+{
+namespace Graphics
+{
+	/**
+	 * Codec of TriMeshIndexFormats::kCompressed16b_CCW index data, for triangle lists ordered for the vertex cache with 
+	 * vertices in first use order. Each triangle is one code byte, followed in a separate section by the varints of the 
+	 * vertices no FIFO predicts. Triangles may come out rotated, which keeps their CCW winding.
+	 */
+	namespace TriMeshIndexCodec
+	{
+		const uint8_t kVersion = 0;
+
+		uint32_t GetMaxEncodedSize(uint32_t indexCount);
+
+		/**
+		 * @param outDataSize Size of the encoded data, at most GetMaxEncodedSize(indexCount) bytes.
+		 */
+		int32_t Encode(uint8_t* outData, uint32_t* outDataSize, uint32_t maxDataSize, const uint16_t* indices, uint32_t indexCount);
+
+		/**
+		 * Fails with efwErrs::kCorruptedData when the data is truncated, has codes it doesn't know, or references vertices 
+		 * outside the chunk, so decoded indices are always below vertexCount.
+		 */
+		int32_t Decode(uint16_t* outIndices, uint32_t indexCount, uint32_t vertexCount, const uint8_t* data, uint32_t dataSize);
+	}
+
+} // Graphics
+} // efw
\ No newline at end of file
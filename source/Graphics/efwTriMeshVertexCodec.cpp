@@ -0,0 +1,298 @@
+#include "Graphics/efwTriMeshVertexCodec.h"
+#include "Math/efwMath.h"
+
+#if defined(EFW_MATH_SSE)
+#include <emmintrin.h>
+#endif
+
+using namespace efw;
+using namespace efw::Graphics;
+
+/**
+ * Block: 32b payload size, then one section per vertex byte. Sections start with the 2b modes of their groups, four per 
+ * byte, followed by the packed groups. Deltas are zigzag coded bytes, and the last group is padded with zero deltas.
+ */
+static const uint32_t kGroupSize = 16;
+static const uint32_t kMaxGroupCount = TriMeshVertexCodec::kBlockVertexCount / kGroupSize;
+static const uint32_t kBlockHeaderSize = sizeof(uint32_t);
+
+namespace GroupModes
+{
+	const uint32_t kZero = 0;
+	const uint32_t k2Bits = 1;
+	const uint32_t k4Bits = 2;
+	const uint32_t k8Bits = 3;
+}
+static const uint32_t kGroupModeDataSizes[] = { 0, 4, 8, 16 };
+
+
+static EFW_INLINE uint32_t GetGroupCount(uint32_t vertexCount)
+{
+	return (vertexCount + kGroupSize - 1) / kGroupSize;
+}
+
+
+static EFW_INLINE uint32_t GetGroupModeSize(uint32_t groupCount)
+{
+	return (groupCount + 3) / 4;
+}
+
+
+uint32_t TriMeshVertexCodec::GetMaxEncodedSize(uint32_t vertexCount, uint32_t vertexStride)
+{
+	const uint32_t fullBlockCount = vertexCount / kBlockVertexCount;
+	const uint32_t lastBlockGroupCount = GetGroupCount(vertexCount % kBlockVertexCount);
+	uint32_t size = 1 + fullBlockCount * (kBlockHeaderSize + vertexStride * (GetGroupModeSize(kMaxGroupCount) + kMaxGroupCount * kGroupSize));
+	if (lastBlockGroupCount > 0)
+		size += kBlockHeaderSize + vertexStride * (GetGroupModeSize(lastBlockGroupCount) + lastBlockGroupCount * kGroupSize);
+	return size;
+}
+
+
+static uint8_t* EncodeBlock(uint8_t* data, const uint8_t* vertexData, uint32_t vertexCount, uint32_t vertexStride, uint8_t* lastVertex)
+{
+	uint8_t* blockStart = data;
+	data += kBlockHeaderSize;
+
+	const uint32_t groupCount = GetGroupCount(vertexCount);
+	for (uint32_t k=0; k<vertexStride; ++k)
+	{
+		uint8_t* groupModes = data;
+		memset(groupModes, 0, GetGroupModeSize(groupCount));
+		data += GetGroupModeSize(groupCount);
+
+		uint8_t last = lastVertex[k];
+		for (uint32_t i=0; i<groupCount; ++i)
+		{
+			uint8_t deltas[kGroupSize];
+			uint8_t maxDelta = 0;
+			for (uint32_t j=0; j<kGroupSize; ++j)
+			{
+				const uint32_t vertex = i * kGroupSize + j;
+				uint8_t delta = 0;
+				if (vertex < vertexCount)
+				{
+					const uint8_t value = vertexData[vertex * vertexStride + k];
+					const uint8_t unsignedDelta = (uint8_t)(value - last);
+					delta = (uint8_t)((unsignedDelta << 1) ^ ((unsignedDelta & 0x80)? 0xFF : 0));
+					last = value;
+				}
+				deltas[j] = delta;
+				maxDelta = Math::Max(maxDelta, delta);
+			}
+
+			uint32_t mode = (maxDelta == 0)? GroupModes::kZero : (maxDelta < 4)? GroupModes::k2Bits : (maxDelta < 16)? GroupModes::k4Bits : GroupModes::k8Bits;
+			groupModes[i / 4] |= (uint8_t)(mode << ((i % 4) * 2));
+
+			const uint32_t dataSize = kGroupModeDataSizes[mode];
+			memset(data, 0, dataSize);
+			for (uint32_t j=0; j<kGroupSize && mode != GroupModes::kZero; ++j)
+			{
+				if (mode == GroupModes::k2Bits)
+					data[j / 4] |= (uint8_t)(deltas[j] << ((j % 4) * 2));
+				else if (mode == GroupModes::k4Bits)
+					data[j / 2] |= (uint8_t)(deltas[j] << ((j % 2) * 4));
+				else
+					data[j] = deltas[j];
+			}
+			data += dataSize;
+		}
+		lastVertex[k] = last;
+	}
+
+	const uint32_t payloadSize = (uint32_t)(data - blockStart - kBlockHeaderSize);
+	memcpy(blockStart, &payloadSize, sizeof(uint32_t));
+	return data;
+}
+
+
+int32_t TriMeshVertexCodec::Encode(uint8_t* outData, uint32_t* outDataSize, uint32_t maxDataSize, const void* vertexData, uint32_t vertexCount, 
+	uint32_t vertexStride)
+{
+	if (outData == NULL || outDataSize == NULL || (vertexData == NULL && vertexCount > 0) || vertexStride == 0 || vertexStride > kMaxVertexStride)
+		return efwErrs::kInvalidInput;
+	if (maxDataSize < GetMaxEncodedSize(vertexCount, vertexStride))
+		return efwErrs::kInvalidInput;
+
+	uint8_t lastVertex[kMaxVertexStride];
+	memset(lastVertex, 0, sizeof(lastVertex));
+
+	uint8_t* data = outData;
+	*data++ = kVersion;
+	for (uint32_t i=0; i<vertexCount; i+=kBlockVertexCount)
+	{
+		const uint32_t blockVertexCount = Math::Min(kBlockVertexCount, vertexCount - i);
+		data = EncodeBlock(data, (const uint8_t*)vertexData + i * vertexStride, blockVertexCount, vertexStride, lastVertex);
+	}
+
+	*outDataSize = (uint32_t)(data - outData);
+	return efwErrs::kOk;
+}
+
+
+#if defined(EFW_MATH_SSE)
+// Unpacks, unzigzags and prefix sums the 16 deltas of a group
+static EFW_INLINE uint8_t DecodeGroup(uint8_t* out, const uint8_t* data, uint32_t mode, uint8_t last)
+{
+	__m128i deltas;
+	if (mode == GroupModes::kZero)
+		deltas = _mm_setzero_si128();
+	else if (mode == GroupModes::k2Bits)
+	{
+		int32_t packed;
+		memcpy(&packed, data, sizeof(packed));
+		__m128i bits = _mm_cvtsi32_si128(packed);
+		const __m128i mask = _mm_set1_epi8(3);
+		__m128i deltas01 = _mm_unpacklo_epi8(_mm_and_si128(bits, mask), _mm_and_si128(_mm_srli_epi16(bits, 2), mask));
+		__m128i deltas23 = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(bits, 4), mask), _mm_and_si128(_mm_srli_epi16(bits, 6), mask));
+		deltas = _mm_unpacklo_epi16(deltas01, deltas23);
+	}
+	else if (mode == GroupModes::k4Bits)
+	{
+		__m128i bits = _mm_loadl_epi64((const __m128i*)data);
+		const __m128i mask = _mm_set1_epi8(15);
+		deltas = _mm_unpacklo_epi8(_mm_and_si128(bits, mask), _mm_and_si128(_mm_srli_epi16(bits, 4), mask));
+	}
+	else
+		deltas = _mm_loadu_si128((const __m128i*)data);
+
+	// Zigzag is (delta >> 1) ^ -(delta & 1), on bytes
+	const __m128i one = _mm_set1_epi8(1);
+	deltas = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(deltas, 1), _mm_set1_epi8(127)), _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(deltas, one)));
+
+	deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 1));
+	deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 2));
+	deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 4));
+	deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 8));
+	deltas = _mm_add_epi8(deltas, _mm_set1_epi8((char)last));
+	_mm_storeu_si128((__m128i*)out, deltas);
+
+	return out[kGroupSize - 1];
+}
+#else
+static EFW_INLINE uint8_t DecodeGroup(uint8_t* out, const uint8_t* data, uint32_t mode, uint8_t last)
+{
+	for (uint32_t j=0; j<kGroupSize; ++j)
+	{
+		uint8_t delta = 0;
+		if (mode == GroupModes::k2Bits)
+			delta = (data[j / 4] >> ((j % 4) * 2)) & 3;
+		else if (mode == GroupModes::k4Bits)
+			delta = (data[j / 2] >> ((j % 2) * 4)) & 15;
+		else if (mode == GroupModes::k8Bits)
+			delta = data[j];
+
+		last += (uint8_t)((delta >> 1) ^ -(delta & 1));
+		out[j] = last;
+	}
+	return last;
+}
+#endif
+
+
+static int32_t DecodeBlock(uint8_t* vertexData, uint32_t vertexCount, uint32_t vertexStride, const uint8_t* data, uint32_t dataSize, 
+	uint8_t* lastVertex)
+{
+	const uint8_t* dataEnd = data + dataSize;
+	const uint32_t groupCount = GetGroupCount(vertexCount);
+	const uint32_t groupModeSize = GetGroupModeSize(groupCount);
+
+	EFW_ALIGNED_TYPE(16, uint8_t) lane[TriMeshVertexCodec::kBlockVertexCount];
+	for (uint32_t k=0; k<vertexStride; ++k)
+	{
+		if ((uint32_t)(dataEnd - data) < groupModeSize)
+			return efwErrs::kCorruptedData;
+		const uint8_t* groupModes = data;
+		data += groupModeSize;
+
+		uint32_t laneDataSize = 0;
+		for (uint32_t i=0; i<groupCount; ++i)
+			laneDataSize += kGroupModeDataSizes[(groupModes[i / 4] >> ((i % 4) * 2)) & 3];
+		if ((uint32_t)(dataEnd - data) < laneDataSize)
+			return efwErrs::kCorruptedData;
+
+		uint8_t last = lastVertex[k];
+		for (uint32_t i=0; i<groupCount; ++i)
+		{
+			const uint32_t mode = (groupModes[i / 4] >> ((i % 4) * 2)) & 3;
+			last = DecodeGroup(&lane[i * kGroupSize], data, mode, last);
+			data += kGroupModeDataSizes[mode];
+		}
+
+		// Padding deltas are zero, so the last decoded value is also the last vertex value
+		lastVertex[k] = last;
+		for (uint32_t i=0; i<vertexCount; ++i)
+			vertexData[i * vertexStride + k] = lane[i];
+	}
+
+	return (data == dataEnd)? efwErrs::kOk : efwErrs::kCorruptedData;
+}
+
+
+int32_t TriMeshVertexCodec::BeginStreamDecode(StreamDecoder* decoder, void* outVertexData, uint32_t vertexCount, uint32_t vertexStride)
+{
+	if (decoder == NULL || (outVertexData == NULL && vertexCount > 0) || vertexStride == 0 || vertexStride > kMaxVertexStride)
+		return efwErrs::kInvalidInput;
+
+	decoder->vertexData = (uint8_t*)outVertexData;
+	decoder->vertexCount = vertexCount;
+	decoder->vertexStride = vertexStride;
+	decoder->decodedVertexCount = 0;
+	decoder->hasReadVersion = false;
+	memset(decoder->lastVertex, 0, sizeof(decoder->lastVertex));
+	return efwErrs::kOk;
+}
+
+
+int32_t TriMeshVertexCodec::StreamDecode(StreamDecoder* decoder, const uint8_t* data, uint32_t dataSize, uint32_t* outConsumedSize)
+{
+	if (decoder == NULL || (data == NULL && dataSize > 0) || outConsumedSize == NULL)
+		return efwErrs::kInvalidInput;
+
+	const uint8_t* dataStart = data;
+	const uint8_t* dataEnd = data + dataSize;
+	*outConsumedSize = 0;
+
+	if (!decoder->hasReadVersion && data < dataEnd)
+	{
+		if (*data++ != kVersion)
+			return efwErrs::kCorruptedData;
+		decoder->hasReadVersion = true;
+	}
+
+	while (decoder->decodedVertexCount < decoder->vertexCount && (uint32_t)(dataEnd - data) >= kBlockHeaderSize)
+	{
+		uint32_t payloadSize;
+		memcpy(&payloadSize, data, sizeof(uint32_t));
+		if ((uint32_t)(dataEnd - data) - kBlockHeaderSize < payloadSize)
+			break;
+
+		const uint32_t blockVertexCount = Math::Min(kBlockVertexCount, decoder->vertexCount - decoder->decodedVertexCount);
+		int32_t result = DecodeBlock(decoder->vertexData + decoder->decodedVertexCount * decoder->vertexStride, blockVertexCount, 
+			decoder->vertexStride, data + kBlockHeaderSize, payloadSize, decoder->lastVertex);
+		if (result != efwErrs::kOk)
+			return result;
+
+		data += kBlockHeaderSize + payloadSize;
+		decoder->decodedVertexCount += blockVertexCount;
+	}
+
+	*outConsumedSize = (uint32_t)(data - dataStart);
+	return efwErrs::kOk;
+}
+
+
+int32_t TriMeshVertexCodec::Decode(void* outVertexData, uint32_t vertexCount, uint32_t vertexStride, const uint8_t* data, uint32_t dataSize)
+{
+	StreamDecoder decoder;
+	int32_t result = BeginStreamDecode(&decoder, outVertexData, vertexCount, vertexStride);
+	if (result != efwErrs::kOk)
+		return result;
+
+	uint32_t consumedSize = 0;
+	result = StreamDecode(&decoder, data, dataSize, &consumedSize);
+	if (result != efwErrs::kOk)
+		return result;
+
+	return (consumedSize == dataSize && decoder.hasReadVersion && decoder.decodedVertexCount == vertexCount)? efwErrs::kOk : efwErrs::kCorruptedData;
+}
\ No newline at end of file
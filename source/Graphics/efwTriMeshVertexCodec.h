@@ -0,0 +1,65 @@
+/**
+ * Copyright (C) 2012 Bruno P. Evangelista. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "Foundation/efwPlatform.h"
+
+namespace efw
+{
+namespace Graphics
+{
+	/**
+	 * Lossless codec of interleaved vertex data, meant for vertices already quantized and in fetch order. Vertices are 
+	 * coded in blocks: each byte of the vertex is a lane of deltas from the previous vertex, and lanes are bit packed in 
+	 * groups of 16 deltas with 0, 2, 4 or 8 bits each. Blocks are prefixed by their size, so they can be decoded as 
+	 * they are read.
+	 */
+	namespace TriMeshVertexCodec
+	{
+		const uint8_t kVersion = 0;
+		const uint32_t kMaxVertexStride = 256;
+		const uint32_t kBlockVertexCount = 256;
+
+		uint32_t GetMaxEncodedSize(uint32_t vertexCount, uint32_t vertexStride);
+
+		/**
+		 * @param outDataSize Size of the encoded data, at most GetMaxEncodedSize(vertexCount, vertexStride) bytes.
+		 */
+		int32_t Encode(uint8_t* outData, uint32_t* outDataSize, uint32_t maxDataSize, const void* vertexData, uint32_t vertexCount, 
+			uint32_t vertexStride);
+
+		// Fails with efwErrs::kCorruptedData when the data is truncated or invalid
+		int32_t Decode(void* outVertexData, uint32_t vertexCount, uint32_t vertexStride, const uint8_t* data, uint32_t dataSize);
+
+		struct StreamDecoder
+		{
+			uint8_t* vertexData;
+			uint32_t vertexCount;
+			uint32_t vertexStride;
+			uint32_t decodedVertexCount;
+			bool hasReadVersion;
+			uint8_t lastVertex[kMaxVertexStride];
+		};
+
+		int32_t BeginStreamDecode(StreamDecoder* decoder, void* outVertexData, uint32_t vertexCount, uint32_t vertexStride);
+
+		/**
+		 * Decodes every complete block in the data. The bytes after them are not consumed, and must be passed again 
+		 * followed by the next data read. Decoding is done when decodedVertexCount reaches vertexCount.
+		 */
+		int32_t StreamDecode(StreamDecoder* decoder, const uint8_t* data, uint32_t dataSize, uint32_t* outConsumedSize);
+	}
+
+} // Graphics
+} // efw
\ No newline at end of file
@@ -1,108 +1,200 @@
+#include "Foundation/efwCpuFeatures.h"
 #include "Foundation/efwPointerTypes.h"
+#include "Foundation/efwThread.h"
 #include "Graphics/efwUnprocessedTriMeshHelper.h"
 #include "Graphics/efwUnprocessedTriMesh.h"
+#include "Math/efwBatchMath.h"
 #include "Math/efwMath.h"
 #include "Math/efwVectorMath.h"
 
 #include <algorithm>
-#include <map>
-#include <vector>
+#include <float.h>
+
+#if defined(EFW_X86)
+#include <immintrin.h>
+#endif
+
 
 using namespace efw;
 using namespace efw::Graphics;
 using namespace efw::Math;
 
-int32_t GenerateAABoundingBox(AABoundingBox* out, const float* positions, int32_t floatComponentsPerVertex, int32_t vertexCount)
+// Bounding sphere passes over the vertices, growing Ritter's sphere and then refining its center
+static const int32_t kMaxBoundingSphereGrowIterations = 16;
+static const int32_t kBoundingSphereRefineIterations = 32;
+
+static int32_t GatherPositions(Vec3Stream* outStream, const UnprocessedTriMesh* meshes, uint32_t meshCount)
+{
+	int32_t capacity = 0;
+	for (uint32_t i=0; i<meshCount; ++i)
+		capacity += EFW_ALIGN(BatchMath::kLaneCount, (int32_t)meshes[i].vertexCount);
+
+	int32_t errorCode = Vec3StreamCreate(outStream, capacity);
+	if (errorCode != efwErrs::kOk)
+		return errorCode;
+
+	// Meshes start at lane aligned offsets, and the padding between them repeats the last vertex of each mesh
+	int32_t offset = 0;
+	for (uint32_t i=0; i<meshCount; ++i)
+	{
+		const UnprocessedTriMesh& mesh = meshes[i];
+		if (mesh.vertexCount == 0)
+			continue;
+
+		const float* positions = (const float*)( (const uint8_t*)mesh.vertexData + mesh.vertexAttributes[VertexAttributes::kPosition].offset );
+		Vec3Stream meshStream = { &outStream->x[offset], &outStream->y[offset], &outStream->z[offset], 0, capacity - offset };
+		Vec3StreamGather(&meshStream, positions, mesh.vertexStride, (int32_t)mesh.vertexCount);
+
+		outStream->count = offset + (int32_t)mesh.vertexCount;
+		offset += EFW_ALIGN(BatchMath::kLaneCount, (int32_t)mesh.vertexCount);
+	}
+
+	return efwErrs::kOk;
+}
+
+
+static int32_t GenerateAABoundingBox(AABoundingBox* out, const UnprocessedTriMesh* meshes, uint32_t meshCount)
+{
+	if (out == NULL)
+		return efwErrs::kInvalidInput;
+
+	Vec3Stream positions;
+	int32_t errorCode = GatherPositions(&positions, meshes, meshCount);
+	if (errorCode != efwErrs::kOk)
+		return errorCode;
+
+	Vec3StreamMinMax(&out->min, &out->max, positions);
+	Vec3StreamRelease(&positions);
+
+	return efwErrs::kOk;
+}
+
+
+static Vec3f GetStreamElement(const Vec3Stream& stream, int32_t index)
+{
+	return Vec3f(stream.x[index], stream.y[index], stream.z[index]);
+}
+
+
+static int32_t GenerateBoundingSphere(BoundingSphere* out, const UnprocessedTriMesh* meshes, uint32_t meshCount)
 {
 	if (out == NULL)
 		return efwErrs::kInvalidInput;
 
-	if (vertexCount == 0)
+	Vec3Stream positions;
+	int32_t errorCode = GatherPositions(&positions, meshes, meshCount);
+	if (errorCode != efwErrs::kOk)
+		return errorCode;
+
+	if (positions.count == 0)
 	{
-		out->min = Vec3f::kZero;
-		out->max = Vec3f::kZero;
+		memset(out, 0, sizeof(BoundingSphere));
+		Vec3StreamRelease(&positions);
 		return efwErrs::kOk;
 	}
 
-	// Calculate bounding sphere center
-	Vec3f min = Vec3f(FLT_MAX);
-	Vec3f max = Vec3f(-FLT_MAX);
+	// Sphere centered in the bounding box, kept when the refined sphere isn't smaller
+	Vec3f min, max;
+	Vec3StreamMinMax(&min, &max, positions);
+	Vec3f center = Vec3Lerp(min, max, 0.5f);
+	float distanceSquared;
+	int32_t farthestIndex = Vec3StreamFindFarthest(&distanceSquared, positions, center);
+	Vec3f bestCenter = center;
+	float bestRadiusSquared = distanceSquared;
+
+	// Ritter's initial sphere spans the vertex farthest from the box center and the vertex farthest from it
+	const Vec3f point1 = GetStreamElement(positions, farthestIndex);
+	farthestIndex = Vec3StreamFindFarthest(&distanceSquared, positions, point1);
+	const Vec3f point2 = GetStreamElement(positions, farthestIndex);
+	center = Vec3Lerp(point1, point2, 0.5f);
+	float radius = Math::Sqrt(distanceSquared) * 0.5f;
+
+	// Grow the sphere towards the farthest vertex, which tightens it more than growing in vertex order
+	for (int32_t i=0; i<kMaxBoundingSphereGrowIterations; ++i)
+	{
+		farthestIndex = Vec3StreamFindFarthest(&distanceSquared, positions, center);
+		if (distanceSquared < bestRadiusSquared)
+		{
+			bestCenter = center;
+			bestRadiusSquared = distanceSquared;
+		}
+
+		const float distance = Math::Sqrt(distanceSquared);
+		if (distance <= radius)
+			break;
+
+		const float grownRadius = (radius + distance) * 0.5f;
+		center = Vec3Lerp(center, GetStreamElement(positions, farthestIndex), (grownRadius - radius) / distance);
+		radius = grownRadius;
+	}
 
-	for (int32_t i=0; i<vertexCount; ++i)
+	// Badoiu-Clarkson refinement, stepping the center towards the farthest vertex by decreasing amounts. It converges 
+	// to the minimum sphere, but not monotonically, so the smallest sphere seen is kept.
+	center = bestCenter;
+	for (int32_t i=0; i<kBoundingSphereRefineIterations; ++i)
 	{
-		Vec3f position = Vec3f(positions);
-		min = Vec3Min(min, position);
-		max = Vec3Max(max, position);
-		positions += floatComponentsPerVertex;
+		farthestIndex = Vec3StreamFindFarthest(&distanceSquared, positions, center);
+		if (distanceSquared < bestRadiusSquared)
+		{
+			bestCenter = center;
+			bestRadiusSquared = distanceSquared;
+		}
+
+		center = Vec3Lerp(center, GetStreamElement(positions, farthestIndex), 1.0f / (i + 2));
 	}
+	Vec3StreamRelease(&positions);
 
-	out->min = min;
-	out->max = max;
+	// Radius is the distance to the farthest vertex, so every vertex is inside the sphere
+	Vec3GetFloats(out->center, bestCenter);
+	out->radius = Math::Sqrt(bestRadiusSquared);
+
+	EFW_ASSERT(out->center[0] == out->center[0] && 
+		out->center[1] == out->center[1] && 
+		out->center[2] == out->center[2] && 
+		out->radius == out->radius);
+	EFW_ASSERT(out->radius != FLT_MAX);
 
 	return efwErrs::kOk;
 }
 
+
 int32_t UnprocessedTriMeshHelper::GenerateAABoundingBox(AABoundingBox* out, const UnprocessedTriMesh& mesh)
 {
-	float* positions = (float*)( (uint8_t*)mesh.vertexData + mesh.vertexAttributes[VertexAttributes::kPosition].offset );
-	int32_t floatComponentsPerVertex = mesh.vertexStride/sizeof(float);
-
-	return ::GenerateAABoundingBox(out, positions, floatComponentsPerVertex, mesh.vertexCount);
+	return ::GenerateAABoundingBox(out, &mesh, 1);
 }
 
 
-void UnprocessedTriMeshHelper::GenerateBoundingSphere(float* outBoudingSphere, const UnprocessedTriMesh& mesh)
+int32_t UnprocessedTriMeshHelper::GenerateAABoundingBox(AABoundingBox* out, const UnprocessedTriModel& model)
 {
-	if (outBoudingSphere == NULL)
-		return;
+	return ::GenerateAABoundingBox(out, model.meshes, model.meshCount);
+}
 
-	if (mesh.vertexCount == 0)
-	{
-		outBoudingSphere[0] = outBoudingSphere[1] = outBoudingSphere[2] = outBoudingSphere[3] = 0;
-		return;
-	}
 
-	float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
-	float maxX = -FLT_MAX, maxY = -FLT_MAX, maxZ = -FLT_MAX;
+int32_t UnprocessedTriMeshHelper::GenerateBoundingSphere(BoundingSphere* outBoudingSphere, const UnprocessedTriMesh& mesh)
+{
+	return ::GenerateBoundingSphere(outBoudingSphere, &mesh, 1);
+}
 
-	int32_t vertexStride = mesh.vertexStride;
-	float* positions = (float*)( (uint8_t*)mesh.vertexData + mesh.vertexAttributes[VertexAttributes::kPosition].offset );
-	//EFW_ASSERT(vertexStride % sizeof(float) == 0);
 
-	//EFW_ASSERT(mesh.vertexAttributes[VertexAttributes::kPosition].componentCount == 3);
-	for (uint32_t i=0; i<mesh.vertexCount; ++i)
-	{
-		if (positions[0] > maxX) maxX = positions[0];
-		if (positions[1] > maxY) maxY = positions[1];
-		if (positions[2] > maxZ) maxZ = positions[2];
-		if (positions[0] < minX) minX = positions[0];
-		if (positions[1] < minY) minY = positions[1];
-		if (positions[2] < minZ) minZ = positions[2];
-		positions += vertexStride/sizeof(float);
-	}
-	outBoudingSphere[0] = (minX+maxX) * 0.5f;
-	outBoudingSphere[1] = (minY+maxY) * 0.5f;
-	outBoudingSphere[2] = (minZ+maxZ) * 0.5f;
+int32_t UnprocessedTriMeshHelper::GenerateBoundingSphere(BoundingSphere* outBoudingSphere, const UnprocessedTriModel& model)
+{
+	return ::GenerateBoundingSphere(outBoudingSphere, model.meshes, model.meshCount);
+}
 
-	float distanceSquared = 0;
-	positions = (float*)( (uint8_t*)mesh.vertexData + mesh.vertexAttributes[VertexAttributes::kPosition].offset );
-	for (uint32_t i=0; i<mesh.vertexCount; ++i)
-	{
-		float distX = positions[0] - outBoudingSphere[0];
-		float distY = positions[1] - outBoudingSphere[1];
-		float distZ = positions[2] - outBoudingSphere[2];
-		distanceSquared = Math::Max(distanceSquared, distX*distX+distY*distY+distZ*distZ);
-		positions += vertexStride/sizeof(float);
-	}
 
-	// Calculate bounding sphere radius
-	outBoudingSphere[3] = Math::Sqrt(distanceSquared);
+void UnprocessedTriMeshHelper::GenerateBoundingSphere(float* outBoudingSphere, const UnprocessedTriMesh& mesh)
+{
+	if (outBoudingSphere == NULL)
+		return;
 
-	EFW_ASSERT(outBoudingSphere[0] == outBoudingSphere[0] && 
-		outBoudingSphere[1] == outBoudingSphere[1] && 
-		outBoudingSphere[2] == outBoudingSphere[2] && 
-		outBoudingSphere[3] == outBoudingSphere[3]);
-	EFW_ASSERT(outBoudingSphere[3] != FLT_MAX);
+	BoundingSphere boundingSphere;
+	if (::GenerateBoundingSphere(&boundingSphere, &mesh, 1) != efwErrs::kOk)
+		memset(&boundingSphere, 0, sizeof(BoundingSphere));
+
+	outBoudingSphere[0] = boundingSphere.center[0];
+	outBoudingSphere[1] = boundingSphere.center[1];
+	outBoudingSphere[2] = boundingSphere.center[2];
+	outBoudingSphere[3] = boundingSphere.radius;
 }
 
 
@@ -150,175 +242,465 @@ void UnprocessedTriMeshHelper::MergeBoundingSphere(float* outBoudingSphere, cons
 		outBoudingSphere[3] == outBoudingSphere[3]);
 }
 
-bool DuplicatedVerticesSort(const std::vector<int32_t>& a, const std::vector<int32_t>& b)
+// Cells of the weld grid are at least this fraction of the mesh extent, so cell coordinates always fit in 21 bits
+static const int32_t kMaxWeldCellsPerAxis = 1 << 20;
+static const uint32_t kUnassignedVertex = 0xFFFFFFFF;
+static const int32_t kMaxWeldNeighborBuckets = 27;
+
+/**
+ * Flat spatial hash of the vertex positions, with cells the size of the merge threshold so every vertex closer than 
+ * the threshold is in one of the 27 cells around a vertex. Vertices are sorted by bucket into slots, and a bucket holds 
+ * the vertices of every cell hashing to it. Positions are copied in slot order, so vertices of a cell are contiguous.
+ */
+struct VertexWeldGrid
 {
-	return (a.size()>b.size());
+	const float* normals;
+	const float* uvs;
+	int32_t vertexComponents;
+
+	float threshold;
+	float thresholdSquared;
+	float minPosition[3];
+	float invCellSize;
+	int32_t cellCounts[3];
+
+	uint32_t bucketMask;
+	uint32_t* bucketStarts;
+	uint32_t* slotVertices;					// Vertex index of each slot
+	float* slotPositions;
+};
+
+
+static EFW_INLINE int32_t GetWeldCell(const VertexWeldGrid& grid, float value, int32_t axis)
+{
+	float cell = (value - grid.minPosition[axis]) * grid.invCellSize;
+	if (!(cell > 0.0f))
+		return 0;
+	return Math::Min((int32_t)cell, grid.cellCounts[axis] - 1);
 }
 
-int32_t UnprocessedTriMeshHelper::MergeDuplicatedVertices(UnprocessedTriMesh* mesh, float positionDeltaThreashold, int32_t mergeDuplicateFlags)
+
+static EFW_INLINE uint32_t GetWeldBucket(const VertexWeldGrid& grid, int32_t x, int32_t y, int32_t z)
 {
-	if (mesh == NULL)
-		return efwErrs::kInvalidInput;
+	uint64_t key = (uint64_t)x | ((uint64_t)y << 21) | ((uint64_t)z << 42);
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	return (uint32_t)key & grid.bucketMask;
+}
 
-	const int32_t kOctreeAxisPartions = 32;
-	const int32_t kOctreePartitions = kOctreeAxisPartions*kOctreeAxisPartions*kOctreeAxisPartions;
 
-	AABoundingBox boundingBox;
-	GenerateAABoundingBox(&boundingBox, *mesh);
-	Vec3f boundingBoxSize = boundingBox.max - boundingBox.min;
-	boundingBoxSize = Vec3Max(boundingBoxSize * Vec3f(1.01f), Vec3f(1.0f));
-	//Vec3f invOctreePartitionSize = Vec3f( Vec3f(1.0f) / (boundingBoxSize/Vec3f(kOctreeAxisPartions)) );
-	Vec3f invOctreePartitionSize = Vec3f((float)kOctreeAxisPartions)/boundingBoxSize;
+static EFW_INLINE bool CanMergeVertices(const VertexWeldGrid& grid, uint32_t slot1, uint32_t slot2)
+{
+	const float* position1 = &grid.slotPositions[slot1 * 3];
+	const float* position2 = &grid.slotPositions[slot2 * 3];
+	float distX = position1[0] - position2[0];
+	float distY = position1[1] - position2[1];
+	float distZ = position1[2] - position2[2];
+	if (!(distX*distX + distY*distY + distZ*distZ < grid.thresholdSquared))
+		return false;
+
+	// TODO Add pass tangent and binormal
+	const uint32_t index1 = grid.slotVertices[slot1];
+	const uint32_t index2 = grid.slotVertices[slot2];
+	if (grid.normals != NULL)
+	{
+		const float* normal1 = &grid.normals[index1 * grid.vertexComponents];
+		const float* normal2 = &grid.normals[index2 * grid.vertexComponents];
+		if (Math::Abs(normal1[0]-normal2[0]) > Math::kEpsilon || Math::Abs(normal1[1]-normal2[1]) > Math::kEpsilon || 
+			Math::Abs(normal1[2]-normal2[2]) > Math::kEpsilon)
+			return false;
+	}
+	if (grid.uvs != NULL)
+	{
+		const float* uv1 = &grid.uvs[index1 * grid.vertexComponents];
+		const float* uv2 = &grid.uvs[index2 * grid.vertexComponents];
+		if (Math::Abs(uv1[0]-uv2[0]) > Math::kEpsilon || Math::Abs(uv1[1]-uv2[1]) > Math::kEpsilon)
+			return false;
+	}
+
+	return true;
+}
 
-	std::vector<int32_t>* octree = (std::vector<int32_t>*)memalign(16, kOctreePartitions*sizeof(std::vector<int32_t>));
-	memset(octree, 0, kOctreePartitions*sizeof(std::vector<int32_t>));
-	//for (int32_t i=0; i<kOctreePartitions; ++i)
-	//	octree[i] = std::vector<int32_t>();
 
-	int32_t vertexComponents = mesh->vertexStride/sizeof(float);
-	float* positions = (float*)( (uint8_t*)mesh->vertexData + mesh->vertexAttributes[VertexAttributes::kPosition].offset );
-	float* normals = (mesh->vertexAttributes[VertexAttributes::kNormal].componentCount == 0 || (mergeDuplicateFlags & MergeVertexFlags::kTangentPlane_Exact) == 0)? NULL :
-		(float*)( (uint8_t*)mesh->vertexData + mesh->vertexAttributes[VertexAttributes::kNormal].offset );
-	float* uvs = (mesh->vertexAttributes[VertexAttributes::kUv0].componentCount == 0 || (mergeDuplicateFlags & MergeVertexFlags::kUvw0_Exact) == 0)? NULL :
-		(float*)( (uint8_t*)mesh->vertexData + mesh->vertexAttributes[VertexAttributes::kUv0].offset );
+/**
+ * Gets the buckets of the cells a vertex closer than the threshold can be in, at most kMaxWeldNeighborBuckets. 
+ * Neighbor cells may share a bucket, which is only returned once, in cell order.
+ */
+static int32_t GetNeighborBuckets(const VertexWeldGrid& grid, uint32_t slot, uint32_t* outBuckets)
+{
+	// The threshold range may round into a fourth cell, but cells are larger than the threshold so the 3 cells around 
+	// the vertex cell are always enough
+	const float* position = &grid.slotPositions[slot * 3];
+	int32_t minCell[3], maxCell[3];
+	for (int32_t i=0; i<3; ++i)
+	{
+		const int32_t cell = GetWeldCell(grid, position[i], i);
+		minCell[i] = Math::Max(GetWeldCell(grid, position[i] - grid.threshold, i), cell - 1);
+		maxCell[i] = Math::Min(GetWeldCell(grid, position[i] + grid.threshold, i), cell + 1);
+	}
 
-	// Split vertex indices into octree-buckets
-	for (uint32_t i=0; i<mesh->vertexCount; ++i)
+	int32_t bucketCount = 0;
+	for (int32_t z=minCell[2]; z<=maxCell[2]; ++z)
+	for (int32_t y=minCell[1]; y<=maxCell[1]; ++y)
+	for (int32_t x=minCell[0]; x<=maxCell[0]; ++x)
 	{
-		Vec3f position = Vec3f( &positions[i*vertexComponents] );
-
-		Vec3f deltaVec = position - boundingBox.min;
-		deltaVec *= invOctreePartitionSize;
-
-		Vec3f neighborsVec = Vec3Floor(deltaVec + Vec3f(0.5f));
-		deltaVec = Vec3Floor(deltaVec);
-
-		float deltas[3];
-		Vec3GetFloats(deltas, deltaVec);
-		int32_t partitionIndex = (int32_t)deltas[0] + (int32_t)deltas[1] * kOctreeAxisPartions + (int32_t)deltas[2] * kOctreeAxisPartions*kOctreeAxisPartions;
-		octree[partitionIndex].push_back(i);
-
-		// Get neighbor index
-		neighborsVec -= deltaVec;
-		neighborsVec = neighborsVec*Vec3f(2.0f) -Vec3f(1.0f);
-		neighborsVec += deltaVec;
-		float neighbors[3];
-		Vec3GetFloats(neighbors, neighborsVec);
-
-		int32_t partitionIndexNeighborX = (int32_t)neighbors[0] + (int32_t)deltas[1] * kOctreeAxisPartions + (int32_t)deltas[2] * kOctreeAxisPartions*kOctreeAxisPartions;
-		int32_t partitionIndexNeighborY = (int32_t)deltas[0] + (int32_t)neighbors[1] * kOctreeAxisPartions + (int32_t)deltas[2] * kOctreeAxisPartions*kOctreeAxisPartions;
-		int32_t partitionIndexNeighborZ = (int32_t)deltas[0] + (int32_t)deltas[1] * kOctreeAxisPartions + (int32_t)neighbors[2] * kOctreeAxisPartions*kOctreeAxisPartions;
-		int32_t partitionIndexNeighborXY = (int32_t)neighbors[0] + (int32_t)neighbors[1] * kOctreeAxisPartions + (int32_t)deltas[2] * kOctreeAxisPartions*kOctreeAxisPartions;
-		int32_t partitionIndexNeighborXZ = (int32_t)neighbors[0] + (int32_t)deltas[1] * kOctreeAxisPartions + (int32_t)neighbors[2] * kOctreeAxisPartions*kOctreeAxisPartions;
-		int32_t partitionIndexNeighborYZ = (int32_t)deltas[0] + (int32_t)neighbors[1] * kOctreeAxisPartions + (int32_t)neighbors[2] * kOctreeAxisPartions*kOctreeAxisPartions;
-		int32_t partitionIndexNeighborXYZ = (int32_t)neighbors[0] + (int32_t)neighbors[1] * kOctreeAxisPartions + (int32_t)neighbors[2] * kOctreeAxisPartions*kOctreeAxisPartions;
-
-		bool passX = (neighbors[0] >=0 && neighbors[0] < kOctreeAxisPartions);
-		bool passY = (neighbors[1] >=0 && neighbors[1] < kOctreeAxisPartions);
-		bool passZ = (neighbors[2] >=0 && neighbors[2] < kOctreeAxisPartions);
-		if (passX) octree[partitionIndexNeighborX].push_back(i);
-		if (passY) octree[partitionIndexNeighborY].push_back(i);
-		if (passZ) octree[partitionIndexNeighborZ].push_back(i);
-		if (passX&passY) octree[partitionIndexNeighborXY].push_back(i);
-		if (passX&passZ) octree[partitionIndexNeighborXZ].push_back(i);
-		if (passY&passZ) octree[partitionIndexNeighborYZ].push_back(i);
-		if (passX&passY&passZ) octree[partitionIndexNeighborXYZ].push_back(i);
-	}
-
-	// For each vertex, store an array of indices of other vertices that are near and can be merged
-	std::vector<std::vector<int32_t>> duplicates;
-	duplicates.resize(mesh->vertexCount);
-	for (int32_t i=0; i<kOctreePartitions; ++i)
-	{
-		for (uint32_t j=0; j<octree[i].size(); ++j)
-		{
-			int32_t testIndex = octree[i][j];
-			duplicates[testIndex].push_back( testIndex );
-			Vec3f testPosition = Vec3f( &positions[testIndex*vertexComponents] );
-			float* testNormal = (normals != NULL)? &normals[testIndex*vertexComponents] : NULL;
-			float* testUv0 = (uvs != NULL)? &uvs[testIndex*vertexComponents] : NULL;
-
-			for (uint32_t k=j+1; k<octree[i].size(); ++k)
-			{
-				int32_t index = octree[i][k];
-				Vec3f position = Vec3f( &positions[index*vertexComponents] );
-				float* normal = (normals != NULL)? &normals[index*vertexComponents] : NULL;
-				float* uv0 = (uvs != NULL)? &uvs[index*vertexComponents] : NULL;
-				
-				// TODO Add pass tangent and binormal
-				Vec3f distanceSquared = Vec3LengthSquared(position - testPosition);
-				bool passPosition = (distanceSquared.X() < (positionDeltaThreashold*positionDeltaThreashold));
-				bool passNormal = (normals == NULL || 
-					(Math::Abs(testNormal[0]-normal[0]) <= Math::kEpsilon && Math::Abs(testNormal[1]-normal[1]) <= Math::kEpsilon && Math::Abs(testNormal[2]-normal[2]) <= Math::kEpsilon) );
-				bool passUv0 = (uvs == NULL || (Math::Abs(testUv0[0] - uv0[0]) <= Math::kEpsilon && 
-					Math::Abs(testUv0[1] - uv0[1]) <= Math::kEpsilon) );
-				
-				if (passPosition && passNormal && passUv0)
-				{
-					duplicates[testIndex].push_back(index);
-					duplicates[index].push_back(testIndex);
-				}
-			}
+		uint32_t bucket = GetWeldBucket(grid, x, y, z);
+		bool isVisited = false;
+		for (int32_t i=0; i<bucketCount && !isVisited; ++i)
+			isVisited = (outBuckets[i] == bucket);
+		if (!isVisited)
+			outBuckets[bucketCount++] = bucket;
+	}
+	EFW_ASSERT(bucketCount <= kMaxWeldNeighborBuckets);
+
+	return bucketCount;
+}
+
+
+/**
+ * Welding runs in passes over ranges of slots, plain slices of the slot array. Every pass only writes to its own range 
+ * and reads other ranges through the results of previous passes, so the outcome doesn't depend on how slots are split.
+ */
+struct VertexWeldJob
+{
+	const VertexWeldGrid* grid;
+	const float* positions;
+	const float* vertexData;
+	uint32_t vertexCount;
+	int32_t rangeCount;
+
+	uint32_t* vertexBuckets;
+	uint32_t* slotMergeCounts;
+	const uint32_t* slotRanks;
+	uint32_t* slotLeaders;
+	uint32_t* nextSlotLeaders;
+	volatile int32_t unresolvedCount;
+	const uint32_t* leaderSlots;
+	uint32_t leaderCount;
+	float* newVertexData;
+};
+
+
+static EFW_INLINE void GetWeldJobRange(const VertexWeldJob& job, uint32_t itemCount, int32_t rangeIndex, uint32_t* outStart, uint32_t* outEnd)
+{
+	*outStart = (uint32_t)(((uint64_t)itemCount * rangeIndex) / job.rangeCount);
+	*outEnd = (uint32_t)(((uint64_t)itemCount * (rangeIndex + 1)) / job.rangeCount);
+}
+
+
+static void HashWeldVertices(void* userData, int32_t rangeIndex)
+{
+	const VertexWeldJob& job = *(const VertexWeldJob*)userData;
+	const VertexWeldGrid& grid = *job.grid;
+	uint32_t start, end;
+	GetWeldJobRange(job, job.vertexCount, rangeIndex, &start, &end);
+
+	for (uint32_t i=start; i<end; ++i)
+	{
+		const float* position = &job.positions[i * grid.vertexComponents];
+		job.vertexBuckets[i] = GetWeldBucket(grid, GetWeldCell(grid, position[0], 0), GetWeldCell(grid, position[1], 1), 
+			GetWeldCell(grid, position[2], 2));
+	}
+}
+
+
+// Counts the vertices each vertex can be merged with, including itself
+static void CountWeldDuplicates(void* userData, int32_t rangeIndex)
+{
+	const VertexWeldJob& job = *(const VertexWeldJob*)userData;
+	const VertexWeldGrid& grid = *job.grid;
+	uint32_t start, end;
+	GetWeldJobRange(job, job.vertexCount, rangeIndex, &start, &end);
+
+	uint32_t buckets[kMaxWeldNeighborBuckets];
+	for (uint32_t slot=start; slot<end; ++slot)
+	{
+		uint32_t mergeCount = 0;
+		int32_t bucketCount = GetNeighborBuckets(grid, slot, buckets);
+		for (int32_t i=0; i<bucketCount; ++i)
+		{
+			for (uint32_t otherSlot=grid.bucketStarts[buckets[i]]; otherSlot<grid.bucketStarts[buckets[i]+1]; ++otherSlot)
+				mergeCount += CanMergeVertices(grid, slot, otherSlot)? 1 : 0;
 		}
+		job.slotMergeCounts[slot] = mergeCount;
 	}
-	EFW_SAFE_ALIGNED_FREE(octree);
+}
 
-	// Sort duplicates based on count
-	std::sort(duplicates.begin(), duplicates.end(), DuplicatedVerticesSort);
 
-	bool* usedTable = (bool*)memalign(16, mesh->vertexCount * sizeof(bool));
-	memset(usedTable, 0, sizeof(bool) * mesh->vertexCount);
-	std::map<uint32_t, uint32_t> indexMap = std::map<uint32_t, uint32_t>();
-	
-	// Create new empty vertex list
-	uint32_t newVertexCount = 0;
-	float* newVertexData = (float*)memalign(16, mesh->vertexCount * mesh->vertexStride);
-	for (int32_t i=0; i<vertexComponents; ++i)
-		newVertexData[i] = 0.0f;
+/**
+ * Vertices are merged greedily in rank order, each leader taking every mergeable vertex not taken yet. So a vertex leads 
+ * unless one of its lower ranked mergeable vertices leads, and then joins the lowest ranked of those. 
+ * Returns kUnassignedVertex while any lower ranked mergeable vertex has no leader yet.
+ */
+static EFW_INLINE uint32_t ResolveWeldLeader(const VertexWeldJob& job, uint32_t slot, const uint32_t* slotLeaders)
+{
+	const VertexWeldGrid& grid = *job.grid;
+	const uint32_t rank = job.slotRanks[slot];
+	uint32_t leader = slot;
 
-	for (uint32_t i=0; i<duplicates.size(); ++i)
+	uint32_t buckets[kMaxWeldNeighborBuckets];
+	int32_t bucketCount = GetNeighborBuckets(grid, slot, buckets);
+	for (int32_t i=0; i<bucketCount; ++i)
 	{
-		int32_t mergeCount = 0;
-		
-		for (uint32_t j=0; j<duplicates[i].size(); ++j)
+		for (uint32_t otherSlot=grid.bucketStarts[buckets[i]]; otherSlot<grid.bucketStarts[buckets[i]+1]; ++otherSlot)
 		{
-			int vertexIndex = duplicates[i][j];
-			if (usedTable[vertexIndex])
+			if (job.slotRanks[otherSlot] >= rank || !CanMergeVertices(grid, slot, otherSlot))
 				continue;
 
-			// Add data from current vertex to the global one
-			float* meshVertexData = (float*)mesh->vertexData;
-			for (int32_t k=0; k<vertexComponents; ++k)
+			const uint32_t otherLeader = slotLeaders[otherSlot];
+			if (otherLeader == kUnassignedVertex)
+				return kUnassignedVertex;
+			if (otherLeader == otherSlot && job.slotRanks[otherSlot] < job.slotRanks[leader])
+				leader = otherSlot;
+		}
+	}
+	return leader;
+}
+
+
+// One pass resolving leaders, from the leaders of the previous pass. The greedy merge has a single outcome, so passes 
+// only change how many vertices are resolved at a time, never their leaders.
+static void FindWeldLeaders(void* userData, int32_t rangeIndex)
+{
+	VertexWeldJob& job = *(VertexWeldJob*)userData;
+	uint32_t start, end;
+	GetWeldJobRange(job, job.vertexCount, rangeIndex, &start, &end);
+
+	int32_t unresolvedCount = 0;
+	for (uint32_t slot=start; slot<end; ++slot)
+	{
+		uint32_t leader = job.slotLeaders[slot];
+		if (leader == kUnassignedVertex)
+		{
+			leader = ResolveWeldLeader(job, slot, job.slotLeaders);
+			unresolvedCount += (leader == kUnassignedVertex)? 1 : 0;
+		}
+		job.nextSlotLeaders[slot] = leader;
+	}
+
+	if (unresolvedCount > 0)
+		Atomic::Add(&job.unresolvedCount, unresolvedCount);
+}
+
+
+// Averages the vertices taken by each leader, adding them in the order the greedy merge visits them
+static void AverageWeldedVertices(void* userData, int32_t rangeIndex)
+{
+	const VertexWeldJob& job = *(const VertexWeldJob*)userData;
+	const VertexWeldGrid& grid = *job.grid;
+	const int32_t vertexComponents = grid.vertexComponents;
+	uint32_t start, end;
+	GetWeldJobRange(job, job.leaderCount, rangeIndex, &start, &end);
+
+	uint32_t buckets[kMaxWeldNeighborBuckets];
+	for (uint32_t leaderIndex=start; leaderIndex<end; ++leaderIndex)
+	{
+		const uint32_t leaderSlot = job.leaderSlots[leaderIndex];
+		float* newVertex = &job.newVertexData[leaderIndex * vertexComponents];
+		for (int32_t k=0; k<vertexComponents; ++k)
+			newVertex[k] = 0.0f;
+
+		uint32_t mergeCount = 0;
+		int32_t bucketCount = GetNeighborBuckets(grid, leaderSlot, buckets);
+		for (int32_t i=0; i<bucketCount; ++i)
+		{
+			for (uint32_t otherSlot=grid.bucketStarts[buckets[i]]; otherSlot<grid.bucketStarts[buckets[i]+1]; ++otherSlot)
 			{
-				// TODO Improve this to handle average unique 
-				newVertexData[newVertexCount*vertexComponents+k] += meshVertexData[vertexIndex*vertexComponents+k];
-			}
+				if (job.slotLeaders[otherSlot] != leaderSlot)
+					continue;
 
-			// Create remap for index
-			indexMap.insert( std::pair<uint32_t, uint32_t>(vertexIndex, newVertexCount) );
-			
-			usedTable[vertexIndex] = true;
-			mergeCount++;
+				mergeCount++;
+				const float* vertex = &job.vertexData[grid.slotVertices[otherSlot] * vertexComponents];
+				for (int32_t k=0; k<vertexComponents; ++k)
+				{
+					// TODO Improve this to handle average unique 
+					newVertex[k] += vertex[k];
+				}
+			}
 		}
 
-		if (mergeCount > 0)
+		for (int32_t k=0; k<vertexComponents; ++k)
+			newVertex[k] /= mergeCount;
+	}
+}
+
+
+int32_t UnprocessedTriMeshHelper::MergeDuplicatedVertices(UnprocessedTriMesh* mesh, float positionDeltaThreashold, int32_t mergeDuplicateFlags, 
+	int32_t threadCount)
+{
+	if (mesh == NULL)
+		return efwErrs::kInvalidInput;
+
+	// Positions closer than a non positive threshold don't exist
+	const uint32_t vertexCount = mesh->vertexCount;
+	if (vertexCount == 0 || !(positionDeltaThreashold > 0.0f))
+		return efwErrs::kOk;
+
+	AABoundingBox boundingBox;
+	GenerateAABoundingBox(&boundingBox, *mesh);
+	float minPosition[3], maxPosition[3];
+	Vec3GetFloats(minPosition, boundingBox.min);
+	Vec3GetFloats(maxPosition, boundingBox.max);
+
+	int32_t vertexComponents = mesh->vertexStride/sizeof(float);
+	float* vertexData = (float*)mesh->vertexData;
+	float* positions = (float*)( (uint8_t*)mesh->vertexData + mesh->vertexAttributes[VertexAttributes::kPosition].offset );
+
+	VertexWeldGrid grid;
+	grid.normals = (mesh->vertexAttributes[VertexAttributes::kNormal].componentCount == 0 || (mergeDuplicateFlags & MergeVertexFlags::kTangentPlane_Exact) == 0)? NULL :
+		(float*)( (uint8_t*)mesh->vertexData + mesh->vertexAttributes[VertexAttributes::kNormal].offset );
+	grid.uvs = (mesh->vertexAttributes[VertexAttributes::kUv0].componentCount == 0 || (mergeDuplicateFlags & MergeVertexFlags::kUvw0_Exact) == 0)? NULL :
+		(float*)( (uint8_t*)mesh->vertexData + mesh->vertexAttributes[VertexAttributes::kUv0].offset );
+	grid.vertexComponents = vertexComponents;
+	grid.threshold = positionDeltaThreashold;
+	grid.thresholdSquared = positionDeltaThreashold * positionDeltaThreashold;
+
+	// Cells can't be smaller than the threshold, but are made larger on huge extents to keep the cell count bounded.
+	// Cell coordinates are rounded by up to a few FLT_EPSILON of the cell count, so cells are grown by that much to keep 
+	// vertices closer than the threshold in neighbor cells.
+	float maxExtent = Math::Max(Math::Max(maxPosition[0]-minPosition[0], maxPosition[1]-minPosition[1]), maxPosition[2]-minPosition[2]);
+	float cellSize = Math::Max(positionDeltaThreashold, maxExtent / (kMaxWeldCellsPerAxis - 1));
+	const float cellRoundingError = 4.0f * FLT_EPSILON * (maxExtent / cellSize + 1.0f);
+	cellSize /= (1.0f - cellRoundingError);
+	grid.invCellSize = 1.0f / cellSize;
+	for (int32_t i=0; i<3; ++i)
+	{
+		grid.minPosition[i] = minPosition[i];
+		grid.cellCounts[i] = Math::Min((int32_t)((maxPosition[i]-minPosition[i]) * grid.invCellSize) + 1, kMaxWeldCellsPerAxis);
+	}
+
+	uint32_t bucketCount = 1024;
+	while (bucketCount < vertexCount * 2 && bucketCount < 0x80000000)
+		bucketCount *= 2;
+	grid.bucketMask = bucketCount - 1;
+
+	// All the memory is allocated upfront
+	grid.bucketStarts = (uint32_t*)memalign(16, (bucketCount + 1) * sizeof(uint32_t));
+	grid.slotVertices = (uint32_t*)memalign(16, vertexCount * sizeof(uint32_t));
+	grid.slotPositions = (float*)memalign(16, vertexCount * 3 * sizeof(float));
+	uint32_t* slotOrder = (uint32_t*)memalign(16, vertexCount * sizeof(uint32_t));
+	uint32_t* slotMergeCounts = (uint32_t*)memalign(16, vertexCount * sizeof(uint32_t));
+	uint32_t* slotLeaders = (uint32_t*)memalign(16, vertexCount * sizeof(uint32_t));
+	float* newVertexData = (float*)memalign(16, vertexCount * mesh->vertexStride);
+
+	// Small meshes aren't worth waking up threads
+	const uint32_t kMinVerticesPerRange = 16 * 1024;
+	const int32_t kRangesPerThread = 4;
+	if (threadCount <= 0)
+		threadCount = Thread::GetHardwareThreadCount();
+
+	VertexWeldJob job;
+	job.grid = &grid;
+	job.positions = positions;
+	job.vertexData = vertexData;
+	job.vertexCount = vertexCount;
+	job.rangeCount = (int32_t)Math::Min((uint64_t)threadCount * kRangesPerThread, (uint64_t)vertexCount / kMinVerticesPerRange + 1);
+	job.vertexBuckets = slotOrder;
+	job.slotMergeCounts = slotMergeCounts;
+	job.slotRanks = slotMergeCounts;
+	job.slotLeaders = slotLeaders;
+	job.nextSlotLeaders = NULL;
+	job.unresolvedCount = 0;
+	job.leaderSlots = slotOrder;
+	job.leaderCount = 0;
+	job.newVertexData = newVertexData;
+
+	// Sort vertices by bucket, the slot order temporarily stores the bucket of each vertex
+	Thread::ParallelFor(job.rangeCount, HashWeldVertices, &job, threadCount);
+	memset(grid.bucketStarts, 0, (bucketCount + 1) * sizeof(uint32_t));
+	for (uint32_t i=0; i<vertexCount; ++i)
+		grid.bucketStarts[slotOrder[i]+1]++;
+	for (uint32_t i=0; i<bucketCount; ++i)
+		grid.bucketStarts[i+1] += grid.bucketStarts[i];
+	for (uint32_t i=0; i<vertexCount; ++i)
+	{
+		uint32_t slot = grid.bucketStarts[slotOrder[i]]++;
+		grid.slotVertices[slot] = i;
+		memcpy(&grid.slotPositions[slot * 3], &positions[i * vertexComponents], 3 * sizeof(float));
+	}
+	for (uint32_t i=bucketCount; i>0; --i)
+		grid.bucketStarts[i] = grid.bucketStarts[i-1];
+	grid.bucketStarts[0] = 0;
+
+	Thread::ParallelFor(job.rangeCount, CountWeldDuplicates, &job, threadCount);
+	uint32_t maxMergeCount = 0;
+	for (uint32_t i=0; i<vertexCount; ++i)
+		maxMergeCount = Math::Max(maxMergeCount, slotMergeCounts[i]);
+
+	// Vertices with more duplicates are merged first, ties keep the slot order
+	uint32_t* countStarts = (uint32_t*)memalign(16, (maxMergeCount + 2) * sizeof(uint32_t));
+	memset(countStarts, 0, (maxMergeCount + 2) * sizeof(uint32_t));
+	for (uint32_t i=0; i<vertexCount; ++i)
+		countStarts[maxMergeCount - slotMergeCounts[i] + 1]++;
+	for (uint32_t i=0; i<=maxMergeCount; ++i)
+		countStarts[i+1] += countStarts[i];
+	for (uint32_t i=0; i<vertexCount; ++i)
+		slotOrder[ countStarts[maxMergeCount - slotMergeCounts[i]]++ ] = i;
+	EFW_SAFE_ALIGNED_FREE(countStarts);
+
+	// Merge counts aren't needed anymore, and hold the rank of each slot
+	uint32_t* slotRanks = slotMergeCounts;
+	for (uint32_t i=0; i<vertexCount; ++i)
+		slotRanks[slotOrder[i]] = i;
+
+	// Leaders are resolved in passes, the new vertex data isn't used yet and holds the leaders of every other pass.
+	// Overlapping clusters can chain up, so whatever is left after a few passes is resolved serially in rank order.
+	const int32_t kMaxWeldLeaderPasses = 4;
+	memset(slotLeaders, 0xFF, vertexCount * sizeof(uint32_t));
+	job.nextSlotLeaders = (uint32_t*)newVertexData;
+	for (int32_t pass=0; pass<kMaxWeldLeaderPasses; ++pass)
+	{
+		job.unresolvedCount = 0;
+		Thread::ParallelFor(job.rangeCount, FindWeldLeaders, &job, threadCount);
+
+		uint32_t* passLeaders = job.nextSlotLeaders;
+		job.nextSlotLeaders = job.slotLeaders;
+		job.slotLeaders = passLeaders;
+		if (job.unresolvedCount == 0)
+			break;
+	}
+	if (job.slotLeaders != slotLeaders)
+		memcpy(slotLeaders, job.slotLeaders, vertexCount * sizeof(uint32_t));
+	job.slotLeaders = slotLeaders;
+
+	for (uint32_t i=0; i<vertexCount && job.unresolvedCount > 0; ++i)
+	{
+		const uint32_t slot = slotOrder[i];
+		if (slotLeaders[slot] == kUnassignedVertex)
+			slotLeaders[slot] = ResolveWeldLeader(job, slot, slotLeaders);
+	}
+
+	// New vertices are numbered in rank order, ranks now hold the new vertex of each leader
+	uint32_t* leaderNewVertices = slotRanks;
+	memset(leaderNewVertices, 0xFF, vertexCount * sizeof(uint32_t));
+	for (uint32_t i=0; i<vertexCount; ++i)
+		leaderNewVertices[slotLeaders[i]] = 0;
+	uint32_t newVertexCount = 0;
+	for (uint32_t i=0; i<vertexCount; ++i)
+	{
+		uint32_t slot = slotOrder[i];
+		if (leaderNewVertices[slot] != kUnassignedVertex)
 		{
-			for (int32_t k=0; k<vertexComponents; ++k)
-				newVertexData[newVertexCount*vertexComponents+k] /= mergeCount;
-			newVertexCount++;
+			leaderNewVertices[slot] = newVertexCount;
+			slotOrder[newVertexCount++] = slot;
 		}
 	}
-	duplicates.clear();
-	EFW_SAFE_ALIGNED_FREE(usedTable);
 
-	static uint32_t totalCount = 0;
-	static uint32_t totalDCount = 0;
-	totalCount += mesh->vertexCount;
-	totalDCount += mesh->vertexCount - newVertexCount;
+	job.leaderCount = newVertexCount;
+	job.rangeCount = (int32_t)Math::Min((uint64_t)threadCount * kRangesPerThread, (uint64_t)newVertexCount / kMinVerticesPerRange + 1);
+	Thread::ParallelFor(job.rangeCount, AverageWeldedVertices, &job, threadCount);
 
-	int32_t duplicatedVertexCount = mesh->vertexCount - newVertexCount;
-	printf("VCount: %d  - Duplications: %d\r\n", mesh->vertexCount, duplicatedVertexCount);
-	//printf("VCount: %d  - Duplications: %d\r\n", totalCount, totalDCount);
+	// Slot order is free again, and holds the remap of each vertex
+	uint32_t* remap = slotOrder;
+	for (uint32_t i=0; i<vertexCount; ++i)
+		remap[grid.slotVertices[i]] = leaderNewVertices[slotLeaders[i]];
+
+	EFW_SAFE_ALIGNED_FREE(grid.bucketStarts);
+	EFW_SAFE_ALIGNED_FREE(grid.slotVertices);
+	EFW_SAFE_ALIGNED_FREE(grid.slotPositions);
+	EFW_SAFE_ALIGNED_FREE(slotMergeCounts);
+	EFW_SAFE_ALIGNED_FREE(slotLeaders);
 
 	// Replace old vertex data with new one
 	if (newVertexCount != mesh->vertexCount)
@@ -333,20 +715,891 @@ int32_t UnprocessedTriMeshHelper::MergeDuplicatedVertices(UnprocessedTriMesh* me
 		// Adjust index list
 		uint32_t* indices = (uint32_t*)mesh->indexData;
 		for (uint32_t i=0; i<mesh->indexCount; ++i)
+			indices[i] = remap[indices[i]];
+	}
+
+	EFW_SAFE_ALIGNED_FREE(remap);
+	EFW_SAFE_ALIGNED_FREE(newVertexData);
+
+	return efwErrs::kOk;
+}
+
+
+/**
+ * Simulates a FIFO post-transform cache with timestamps: a vertex is cached when fewer than cacheSize vertices were
+ * transformed after it. Advancing the time past cacheSize flushes the cache.
+ */
+static uint32_t CountVertexCacheMisses(const uint32_t* indices, uint32_t indexCount, uint32_t* cacheTimeStamps, uint32_t* time,
+	int32_t cacheSize)
+{
+	uint32_t missCount = 0;
+	for (uint32_t i=0; i<indexCount; ++i)
+	{
+		if (*time - cacheTimeStamps[indices[i]] > (uint32_t)cacheSize)
 		{
-			uint32_t currentIndex = indices[i];
-			indices[i] = indexMap[currentIndex];
+			cacheTimeStamps[indices[i]] = (*time)++;
+			missCount++;
 		}
 	}
+	return missCount;
+}
 
-	EFW_SAFE_ALIGNED_FREE(newVertexData);
+
+static void GetVertexCacheStats(VertexCacheStats* outStats, const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount,
+	int32_t cacheSize, uint32_t* cacheTimeStamps)
+{
+	memset(cacheTimeStamps, 0, vertexCount * sizeof(uint32_t));
+	uint32_t time = cacheSize + 1;
+	uint32_t missCount = CountVertexCacheMisses(indices, indexCount, cacheTimeStamps, &time, cacheSize);
+
+	// Only referenced vertices got a timestamp
+	uint32_t usedVertexCount = 0;
+	for (uint32_t i=0; i<vertexCount; ++i)
+		usedVertexCount += (cacheTimeStamps[i] != 0)? 1 : 0;
+
+	outStats->acmr = (indexCount > 0)? (float)missCount / (indexCount / 3) : 0.0f;
+	outStats->atvr = (usedVertexCount > 0)? (float)missCount / usedVertexCount : 0.0f;
+}
+
+
+static int32_t ValidateTriangleIndices(const UnprocessedTriMesh& mesh)
+{
+	if (mesh.indexStride != sizeof(uint32_t) || (mesh.indexCount % 3) != 0 || (mesh.indexCount > 0 && mesh.indexData == NULL))
+		return efwErrs::kInvalidInput;
+
+	const uint32_t* indices = (const uint32_t*)mesh.indexData;
+	for (uint32_t i=0; i<mesh.indexCount; ++i)
+	{
+		if (indices[i] >= mesh.vertexCount)
+			return efwErrs::kInvalidInput;
+	}
+	return efwErrs::kOk;
+}
+
+
+int32_t UnprocessedTriMeshHelper::AnalyzeVertexCache(VertexCacheStats* outStats, const UnprocessedTriMesh& mesh, int32_t cacheSize)
+{
+	if (outStats == NULL || cacheSize <= 0)
+		return efwErrs::kInvalidInput;
+
+	int32_t result = ValidateTriangleIndices(mesh);
+	if (result != efwErrs::kOk)
+		return result;
+
+	uint32_t* cacheTimeStamps = (uint32_t*)memalign(16, (mesh.vertexCount + 1) * sizeof(uint32_t));
+	GetVertexCacheStats(outStats, (const uint32_t*)mesh.indexData, mesh.indexCount, mesh.vertexCount, cacheSize, cacheTimeStamps);
+	EFW_SAFE_ALIGNED_FREE(cacheTimeStamps);
 
 	return efwErrs::kOk;
 }
 
 
+struct VertexCacheCluster
+{
+	uint32_t firstTriangle;
+	uint32_t triangleCount;
+	float centroid[3];
+	float normal[3];
+	float sortKey;
+};
+
+
+// Clusters facing away from the mesh center are drawn first, as they are more likely to occlude others
+static bool CompareVertexCacheClusters(const VertexCacheCluster& cluster1, const VertexCacheCluster& cluster2)
+{
+	if (cluster1.sortKey != cluster2.sortKey)
+		return cluster1.sortKey > cluster2.sortKey;
+	return cluster1.firstTriangle < cluster2.firstTriangle;
+}
+
+
+/**
+ * Splits the clusters Tipsify ends at dead ends wherever the ACMR of the split part is within the threshold of the
+ * cluster ACMR, then sorts them with the view independent overdraw measure of Sander et al.
+ */
+static void SortTrianglesForOverdraw(uint32_t* outIndices, const uint32_t* indices, uint32_t triangleCount, const uint32_t* hardBoundaries,
+	uint32_t hardBoundaryCount, const UnprocessedTriMesh& mesh, int32_t cacheSize, float overdrawThreshold, uint32_t* cacheTimeStamps)
+{
+	const float* positions = (const float*)( (const uint8_t*)mesh.vertexData + mesh.vertexAttributes[VertexAttributes::kPosition].offset );
+	const int32_t vertexComponents = mesh.vertexStride/sizeof(float);
+
+	VertexCacheCluster* clusters = (VertexCacheCluster*)memalign(16, triangleCount * sizeof(VertexCacheCluster));
+	uint32_t clusterCount = 0;
+
+	memset(cacheTimeStamps, 0, mesh.vertexCount * sizeof(uint32_t));
+	uint32_t time = cacheSize + 1;
+	for (uint32_t i=0; i<hardBoundaryCount; ++i)
+	{
+		const uint32_t start = hardBoundaries[i];
+		const uint32_t end = (i+1 < hardBoundaryCount)? hardBoundaries[i+1] : triangleCount;
+
+		time += cacheSize + 1;
+		float maxMissesPerTriangle = overdrawThreshold *
+			CountVertexCacheMisses(&indices[start*3], (end-start)*3, cacheTimeStamps, &time, cacheSize) / (end-start);
+
+		uint32_t clusterStart = start;
+		uint32_t missCount = 0;
+		time += cacheSize + 1;
+		for (uint32_t j=start; j<end; ++j)
+		{
+			missCount += CountVertexCacheMisses(&indices[j*3], 3, cacheTimeStamps, &time, cacheSize);
+			if (j+1 == end || missCount <= maxMissesPerTriangle * (j+1 - clusterStart))
+			{
+				clusters[clusterCount].firstTriangle = clusterStart;
+				clusters[clusterCount].triangleCount = j+1 - clusterStart;
+				clusterCount++;
+
+				clusterStart = j+1;
+				missCount = 0;
+				time += cacheSize + 1;
+			}
+		}
+	}
+
+	// Centroids are weighted by the triangle areas, and normals are the sum of the unnormalized triangle normals
+	float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+	for (uint32_t i=0; i<clusterCount; ++i)
+	{
+		VertexCacheCluster& cluster = clusters[i];
+		float clusterArea = 0.0f;
+		for (int32_t k=0; k<3; ++k)
+			cluster.centroid[k] = cluster.normal[k] = 0.0f;
+
+		for (uint32_t j=cluster.firstTriangle; j<cluster.firstTriangle + cluster.triangleCount; ++j)
+		{
+			const float* p0 = &positions[indices[j*3+0] * vertexComponents];
+			const float* p1 = &positions[indices[j*3+1] * vertexComponents];
+			const float* p2 = &positions[indices[j*3+2] * vertexComponents];
+			float edge1[3] = { p1[0]-p0[0], p1[1]-p0[1], p1[2]-p0[2] };
+			float edge2[3] = { p2[0]-p0[0], p2[1]-p0[1], p2[2]-p0[2] };
+			float normal[3] = { edge1[1]*edge2[2] - edge1[2]*edge2[1], edge1[2]*edge2[0] - edge1[0]*edge2[2], edge1[0]*edge2[1] - edge1[1]*edge2[0] };
+			float area = Math::Sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+
+			for (int32_t k=0; k<3; ++k)
+			{
+				cluster.centroid[k] += (p0[k] + p1[k] + p2[k]) * area;
+				cluster.normal[k] += normal[k];
+			}
+			clusterArea += area;
+		}
+
+		for (int32_t k=0; k<3; ++k)
+		{
+			meshCentroid[k] += cluster.centroid[k];
+			cluster.centroid[k] = (clusterArea > 0.0f)? cluster.centroid[k] / (3.0f * clusterArea) : 0.0f;
+		}
+		meshArea += clusterArea;
+	}
+
+	for (int32_t k=0; k<3; ++k)
+		meshCentroid[k] = (meshArea > 0.0f)? meshCentroid[k] / (3.0f * meshArea) : 0.0f;
+
+	for (uint32_t i=0; i<clusterCount; ++i)
+	{
+		VertexCacheCluster& cluster = clusters[i];
+		float normalLength = Math::Sqrt(cluster.normal[0]*cluster.normal[0] + cluster.normal[1]*cluster.normal[1] + cluster.normal[2]*cluster.normal[2]);
+		cluster.sortKey = 0.0f;
+		if (normalLength > 0.0f)
+		{
+			for (int32_t k=0; k<3; ++k)
+				cluster.sortKey += (cluster.centroid[k] - meshCentroid[k]) * cluster.normal[k] / normalLength;
+		}
+	}
+
+	std::sort(clusters, clusters + clusterCount, CompareVertexCacheClusters);
+
+	for (uint32_t i=0; i<clusterCount; ++i)
+	{
+		memcpy(outIndices, &indices[clusters[i].firstTriangle * 3], clusters[i].triangleCount * 3 * sizeof(uint32_t));
+		outIndices += clusters[i].triangleCount * 3;
+	}
+
+	EFW_SAFE_ALIGNED_FREE(clusters);
+}
+
+
+// Triangles adjacent to each vertex are ranges of a flat array. Returns the most triangles adjacent to a vertex.
+static uint32_t BuildTriangleAdjacency(uint32_t** outStarts, uint32_t** outTriangles, const uint32_t* indices, uint32_t triangleCount, 
+	uint32_t vertexCount)
+{
+	uint32_t* starts = (uint32_t*)memalign(16, (vertexCount + 1) * sizeof(uint32_t));
+	uint32_t* triangles = (uint32_t*)memalign(16, (triangleCount * 3 + 1) * sizeof(uint32_t));
+	memset(starts, 0, (vertexCount + 1) * sizeof(uint32_t));
+	for (uint32_t i=0; i<triangleCount * 3; ++i)
+		starts[indices[i]+1]++;
+
+	uint32_t maxAdjacentTriangles = 0;
+	for (uint32_t i=0; i<vertexCount; ++i)
+	{
+		maxAdjacentTriangles = Math::Max(maxAdjacentTriangles, starts[i+1]);
+		starts[i+1] += starts[i];
+	}
+	for (uint32_t i=0; i<triangleCount * 3; ++i)
+		triangles[starts[indices[i]]++] = i / 3;
+	for (uint32_t i=vertexCount; i>0; --i)
+		starts[i] = starts[i-1];
+	starts[0] = 0;
+
+	*outStarts = starts;
+	*outTriangles = triangles;
+	return maxAdjacentTriangles;
+}
+
+
+/**
+ * Tipsify, from Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw". Triangles are emitted
+ * in fans around a vertex, and the next fan vertex is the one that stays cached the longest after emitting its fan.
+ * Dead ends start a new hard cluster, returned in outHardBoundaries as their first triangle.
+ */
+static uint32_t TipsifyTriangles(uint32_t* outIndices, uint32_t* outHardBoundaries, const uint32_t* indices, uint32_t triangleCount,
+	uint32_t vertexCount, int32_t cacheSize, uint32_t* cacheTimeStamps)
+{
+	uint32_t* adjacencyStarts = NULL;
+	uint32_t* adjacentTriangles = NULL;
+	uint32_t maxAdjacentTriangles = BuildTriangleAdjacency(&adjacencyStarts, &adjacentTriangles, indices, triangleCount, vertexCount);
+
+	uint32_t* liveTriangleCounts = (uint32_t*)memalign(16, vertexCount * sizeof(uint32_t));
+	for (uint32_t i=0; i<vertexCount; ++i)
+		liveTriangleCounts[i] = adjacencyStarts[i+1] - adjacencyStarts[i];
+
+	uint8_t* isTriangleEmitted = (uint8_t*)memalign(16, triangleCount);
+	memset(isTriangleEmitted, 0, triangleCount);
+	uint32_t* deadEndStack = (uint32_t*)memalign(16, triangleCount * 3 * sizeof(uint32_t));
+	uint32_t* candidates = (uint32_t*)memalign(16, maxAdjacentTriangles * 3 * sizeof(uint32_t));
+	uint32_t deadEndCount = 0;
+
+	memset(cacheTimeStamps, 0, vertexCount * sizeof(uint32_t));
+	uint32_t time = cacheSize + 1;
+	uint32_t nextScanVertex = 0;
+	uint32_t emittedIndexCount = 0;
+	uint32_t hardBoundaryCount = 0;
+
+	uint32_t fanVertex = kUnassignedVertex;
+	bool isDeadEnd = true;
+	for (;;)
+	{
+		// Dead ends restart from the most recent vertex with triangles left, or the next one in the mesh
+		if (isDeadEnd)
+		{
+			fanVertex = kUnassignedVertex;
+			while (deadEndCount > 0 && fanVertex == kUnassignedVertex)
+			{
+				uint32_t vertex = deadEndStack[--deadEndCount];
+				if (liveTriangleCounts[vertex] > 0)
+					fanVertex = vertex;
+			}
+			while (nextScanVertex < vertexCount && fanVertex == kUnassignedVertex)
+			{
+				if (liveTriangleCounts[nextScanVertex] > 0)
+					fanVertex = nextScanVertex;
+				nextScanVertex++;
+			}
+			if (fanVertex == kUnassignedVertex)
+				break;
+
+			outHardBoundaries[hardBoundaryCount++] = emittedIndexCount / 3;
+		}
+
+		uint32_t candidateCount = 0;
+		for (uint32_t i=adjacencyStarts[fanVertex]; i<adjacencyStarts[fanVertex+1]; ++i)
+		{
+			const uint32_t triangle = adjacentTriangles[i];
+			if (isTriangleEmitted[triangle])
+				continue;
+			isTriangleEmitted[triangle] = 1;
+
+			for (int32_t j=0; j<3; ++j)
+			{
+				const uint32_t vertex = indices[triangle*3 + j];
+				outIndices[emittedIndexCount++] = vertex;
+				deadEndStack[deadEndCount++] = vertex;
+				candidates[candidateCount++] = vertex;
+				liveTriangleCounts[vertex]--;
+				if (time - cacheTimeStamps[vertex] > (uint32_t)cacheSize)
+					cacheTimeStamps[vertex] = time++;
+			}
+		}
+
+		// Candidates that would still be cached after emitting their fan are preferred, oldest first
+		uint32_t nextVertex = kUnassignedVertex;
+		int64_t bestPriority = -1;
+		for (uint32_t i=0; i<candidateCount; ++i)
+		{
+			const uint32_t vertex = candidates[i];
+			if (liveTriangleCounts[vertex] == 0)
+				continue;
+
+			int64_t priority = 0;
+			if ((int64_t)(time - cacheTimeStamps[vertex]) + 2 * (int64_t)liveTriangleCounts[vertex] <= cacheSize)
+				priority = time - cacheTimeStamps[vertex];
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				nextVertex = vertex;
+			}
+		}
+
+		isDeadEnd = (nextVertex == kUnassignedVertex);
+		fanVertex = nextVertex;
+	}
+
+	EFW_SAFE_ALIGNED_FREE(adjacencyStarts);
+	EFW_SAFE_ALIGNED_FREE(adjacentTriangles);
+	EFW_SAFE_ALIGNED_FREE(liveTriangleCounts);
+	EFW_SAFE_ALIGNED_FREE(isTriangleEmitted);
+	EFW_SAFE_ALIGNED_FREE(deadEndStack);
+	EFW_SAFE_ALIGNED_FREE(candidates);
+
+	return hardBoundaryCount;
+}
+
+
+int32_t UnprocessedTriMeshHelper::OptimizeVertexCache(UnprocessedTriMesh* mesh, int32_t cacheSize, float overdrawThreshold,
+	VertexCacheStats* outStatsBefore, VertexCacheStats* outStatsAfter)
+{
+	if (mesh == NULL || cacheSize <= 0)
+		return efwErrs::kInvalidInput;
+
+	int32_t result = ValidateTriangleIndices(*mesh);
+	if (result != efwErrs::kOk)
+		return result;
+
+	const uint32_t triangleCount = mesh->indexCount / 3;
+	uint32_t* indices = (uint32_t*)mesh->indexData;
+	uint32_t* cacheTimeStamps = (uint32_t*)memalign(16, (mesh->vertexCount + 1) * sizeof(uint32_t));
+
+	if (outStatsBefore != NULL)
+		GetVertexCacheStats(outStatsBefore, indices, mesh->indexCount, mesh->vertexCount, cacheSize, cacheTimeStamps);
+
+	if (triangleCount > 0)
+	{
+		uint32_t* newIndices = (uint32_t*)memalign(16, mesh->indexCount * sizeof(uint32_t));
+		uint32_t* hardBoundaries = (uint32_t*)memalign(16, triangleCount * sizeof(uint32_t));
+		uint32_t hardBoundaryCount = TipsifyTriangles(newIndices, hardBoundaries, indices, triangleCount, mesh->vertexCount, cacheSize,
+			cacheTimeStamps);
+
+		// Cluster sorting needs positions
+		if (overdrawThreshold > 0.0f && mesh->vertexAttributes[VertexAttributes::kPosition].componentCount >= 3)
+			SortTrianglesForOverdraw(indices, newIndices, triangleCount, hardBoundaries, hardBoundaryCount, *mesh, cacheSize,
+				Math::Max(overdrawThreshold, 1.0f), cacheTimeStamps);
+		else
+			memcpy(indices, newIndices, mesh->indexCount * sizeof(uint32_t));
+
+		EFW_SAFE_ALIGNED_FREE(newIndices);
+		EFW_SAFE_ALIGNED_FREE(hardBoundaries);
+	}
+
+	if (outStatsAfter != NULL)
+		GetVertexCacheStats(outStatsAfter, indices, mesh->indexCount, mesh->vertexCount, cacheSize, cacheTimeStamps);
+
+	EFW_SAFE_ALIGNED_FREE(cacheTimeStamps);
+	return efwErrs::kOk;
+}
+
+
+int32_t UnprocessedTriMeshHelper::OptimizeVertexFetch(UnprocessedTriMesh* mesh)
+{
+	if (mesh == NULL)
+		return efwErrs::kInvalidInput;
+
+	int32_t result = ValidateTriangleIndices(*mesh);
+	if (result != efwErrs::kOk)
+		return result;
+
+	// Vertices are numbered in the order indices first reference them
+	uint32_t* remap = (uint32_t*)memalign(16, (mesh->vertexCount + 1) * sizeof(uint32_t));
+	memset(remap, 0xFF, mesh->vertexCount * sizeof(uint32_t));
+	uint32_t* indices = (uint32_t*)mesh->indexData;
+	uint32_t newVertexCount = 0;
+	for (uint32_t i=0; i<mesh->indexCount; ++i)
+	{
+		if (remap[indices[i]] == kUnassignedVertex)
+			remap[indices[i]] = newVertexCount++;
+		indices[i] = remap[indices[i]];
+	}
+
+	// Unreferenced vertices are never fetched, so they are dropped
+	const uint32_t vertexStride = mesh->vertexStride;
+	uint8_t* vertexData = (uint8_t*)mesh->vertexData;
+	uint8_t* newVertexData = (uint8_t*)memalign(16, newVertexCount * vertexStride);
+	for (uint32_t i=0; i<mesh->vertexCount; ++i)
+	{
+		if (remap[i] != kUnassignedVertex)
+			memcpy(&newVertexData[remap[i] * vertexStride], &vertexData[i * vertexStride], vertexStride);
+	}
+
+	EFW_SAFE_ALIGNED_FREE(mesh->vertexData);
+	mesh->vertexData = newVertexData;
+	mesh->vertexCount = newVertexCount;
+
+	EFW_SAFE_ALIGNED_FREE(remap);
+	return efwErrs::kOk;
+}
+
+
+/**
+ * Bounds of a chunk for culling. The sphere is centered on the chunk bounding box like the mesh bounding sphere, and 
+ * the normal cone is disabled when its normals spread more than ~84 degrees from the axis.
+ */
+static void GenerateChunkBounds(TriMeshChunk* chunk, const float* positions, int32_t vertexComponents, const uint32_t* chunkVertices, 
+	const uint32_t* indices, const uint32_t* chunkTriangles, uint32_t chunkTriangleCount)
+{
+	float minPosition[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float maxPosition[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32_t i=0; i<chunk->vertexCount; ++i)
+	{
+		const float* position = &positions[chunkVertices[i] * vertexComponents];
+		for (int32_t k=0; k<3; ++k)
+		{
+			minPosition[k] = Math::Min(minPosition[k], position[k]);
+			maxPosition[k] = Math::Max(maxPosition[k], position[k]);
+		}
+	}
+
+	float distanceSquared = 0.0f;
+	for (int32_t k=0; k<3; ++k)
+		chunk->boundingSphere[k] = (minPosition[k] + maxPosition[k]) * 0.5f;
+	for (uint32_t i=0; i<chunk->vertexCount; ++i)
+	{
+		const float* position = &positions[chunkVertices[i] * vertexComponents];
+		float distX = position[0] - chunk->boundingSphere[0];
+		float distY = position[1] - chunk->boundingSphere[1];
+		float distZ = position[2] - chunk->boundingSphere[2];
+		distanceSquared = Math::Max(distanceSquared, distX*distX+distY*distY+distZ*distZ);
+	}
+	chunk->boundingSphere[3] = Math::Sqrt(distanceSquared);
+
+	// Cone axis is the average triangle normal, and the cone must hold the normal furthest from it
+	float axis[3] = { 0.0f, 0.0f, 0.0f };
+	for (int32_t pass=0; pass<2; ++pass)
+	{
+		float minDot = 1.0f;
+		for (uint32_t i=0; i<chunkTriangleCount; ++i)
+		{
+			const float* p0 = &positions[indices[chunkTriangles[i]*3+0] * vertexComponents];
+			const float* p1 = &positions[indices[chunkTriangles[i]*3+1] * vertexComponents];
+			const float* p2 = &positions[indices[chunkTriangles[i]*3+2] * vertexComponents];
+			float edge1[3] = { p1[0]-p0[0], p1[1]-p0[1], p1[2]-p0[2] };
+			float edge2[3] = { p2[0]-p0[0], p2[1]-p0[1], p2[2]-p0[2] };
+			float normal[3] = { edge1[1]*edge2[2] - edge1[2]*edge2[1], edge1[2]*edge2[0] - edge1[0]*edge2[2], edge1[0]*edge2[1] - edge1[1]*edge2[0] };
+			float length = Math::Sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+
+			// Degenerate triangles are never visible
+			if (length == 0.0f)
+				continue;
+
+			if (pass == 0)
+			{
+				for (int32_t k=0; k<3; ++k)
+					axis[k] += normal[k] / length;
+			}
+			else
+				minDot = Math::Min(minDot, (normal[0]*axis[0] + normal[1]*axis[1] + normal[2]*axis[2]) / length);
+		}
+
+		if (pass == 0)
+		{
+			float length = Math::Sqrt(axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2]);
+			for (int32_t k=0; k<3; ++k)
+				axis[k] = (length > 0.0f)? axis[k] / length : 0.0f;
+		}
+		else
+		{
+			for (int32_t k=0; k<3; ++k)
+				chunk->normalCone[k] = axis[k];
+			chunk->normalCone[3] = (minDot > 0.1f)? Math::Sqrt(1.0f - minDot*minDot) : 1.0f;
+		}
+	}
+}
+
+
+// Chunks only search for triangles around their most recent vertices, so large chunks stay linear
+static const uint32_t kMaxChunkSearchVertices = 32;
+
+int32_t UnprocessedTriMeshHelper::BuildMeshChunks(UnprocessedTriMeshChunks* outChunks, const UnprocessedTriMesh& mesh, uint32_t maxVertices, 
+	uint32_t maxTriangles)
+{
+	if (outChunks == NULL || maxVertices < 3 || maxVertices > MeshChunkLimits::kMaxVertices || maxTriangles == 0 || 
+		mesh.vertexAttributes[VertexAttributes::kPosition].componentCount < 3)
+		return efwErrs::kInvalidInput;
+	memset(outChunks, 0, sizeof(UnprocessedTriMeshChunks));
+
+	int32_t result = ValidateTriangleIndices(mesh);
+	if (result != efwErrs::kOk)
+		return result;
+
+	const float* positions = (const float*)( (const uint8_t*)mesh.vertexData + mesh.vertexAttributes[VertexAttributes::kPosition].offset );
+	const int32_t vertexComponents = mesh.vertexStride/sizeof(float);
+	const uint32_t* indices = (const uint32_t*)mesh.indexData;
+	const uint32_t triangleCount = mesh.indexCount / 3;
+	const uint32_t localIndexStride = (maxVertices <= 256)? sizeof(uint8_t) : sizeof(uint16_t);
+
+	// Sized for the worst case of one triangle per chunk, and shrunk at the end
+	TriMeshChunk* chunks = (TriMeshChunk*)memalign(16, (triangleCount + 1) * sizeof(TriMeshChunk));
+	uint32_t* vertexIndices = (uint32_t*)memalign(16, (mesh.indexCount + 1) * sizeof(uint32_t));
+	uint8_t* localIndices = (uint8_t*)memalign(16, (mesh.indexCount + 1) * localIndexStride);
+	uint32_t chunkCount = 0;
+	uint32_t vertexIndexCount = 0;
+	uint32_t localIndexCount = 0;
+
+	uint32_t* adjacencyStarts = NULL;
+	uint32_t* adjacentTriangles = NULL;
+	BuildTriangleAdjacency(&adjacencyStarts, &adjacentTriangles, indices, triangleCount, mesh.vertexCount);
+
+	// Local index of each mesh vertex in the current chunk
+	uint32_t* chunkVertexSlots = (uint32_t*)memalign(16, (mesh.vertexCount + 1) * sizeof(uint32_t));
+	memset(chunkVertexSlots, 0xFF, mesh.vertexCount * sizeof(uint32_t));
+	uint32_t* chunkTriangles = (uint32_t*)memalign(16, maxTriangles * sizeof(uint32_t));
+	uint8_t* isTriangleEmitted = (uint8_t*)memalign(16, triangleCount + 1);
+	memset(isTriangleEmitted, 0, triangleCount);
+
+	uint32_t nextSeedTriangle = 0;
+	for (;;)
+	{
+		while (nextSeedTriangle < triangleCount && isTriangleEmitted[nextSeedTriangle])
+			nextSeedTriangle++;
+		if (nextSeedTriangle == triangleCount)
+			break;
+
+		TriMeshChunk& chunk = chunks[chunkCount++];
+		memset(&chunk, 0, sizeof(TriMeshChunk));
+		chunk.indexData = localIndexCount * localIndexStride;
+		chunk.vertexOffset = vertexIndexCount;
+		chunk.primitiveType = TriMeshPrimitiveTypes::kTriangleList;
+		uint32_t chunkTriangleCount = 0;
+
+		uint32_t triangle = nextSeedTriangle;
+		while (triangle != kUnassignedVertex)
+		{
+			isTriangleEmitted[triangle] = 1;
+			chunkTriangles[chunkTriangleCount++] = triangle;
+			for (int32_t j=0; j<3; ++j)
+			{
+				const uint32_t vertex = indices[triangle*3 + j];
+				if (chunkVertexSlots[vertex] == kUnassignedVertex)
+				{
+					chunkVertexSlots[vertex] = chunk.vertexCount++;
+					vertexIndices[vertexIndexCount++] = vertex;
+				}
+
+				if (localIndexStride == sizeof(uint8_t))
+					localIndices[localIndexCount++] = (uint8_t)chunkVertexSlots[vertex];
+				else
+					((uint16_t*)localIndices)[localIndexCount++] = (uint16_t)chunkVertexSlots[vertex];
+			}
+			if (chunkTriangleCount == maxTriangles)
+				break;
+
+			// Next is the triangle around the chunk adding the fewest vertices, or the next one in the mesh if it fits
+			triangle = kUnassignedVertex;
+			uint32_t bestNewVertexCount = 4;
+			const uint32_t searchStart = (vertexIndexCount - chunk.vertexOffset > kMaxChunkSearchVertices)? 
+				vertexIndexCount - kMaxChunkSearchVertices : chunk.vertexOffset;
+			for (uint32_t j=searchStart; j<vertexIndexCount && bestNewVertexCount > 0; ++j)
+			{
+				const uint32_t vertex = vertexIndices[j];
+				for (uint32_t k=adjacencyStarts[vertex]; k<adjacencyStarts[vertex+1]; ++k)
+				{
+					const uint32_t candidate = adjacentTriangles[k];
+					if (isTriangleEmitted[candidate])
+						continue;
+
+					uint32_t newVertexCount = 0;
+					for (int32_t l=0; l<3; ++l)
+						newVertexCount += (chunkVertexSlots[indices[candidate*3 + l]] == kUnassignedVertex)? 1 : 0;
+					if (newVertexCount < bestNewVertexCount && chunk.vertexCount + newVertexCount <= maxVertices)
+					{
+						bestNewVertexCount = newVertexCount;
+						triangle = candidate;
+					}
+				}
+			}
+
+			while (nextSeedTriangle < triangleCount && isTriangleEmitted[nextSeedTriangle])
+				nextSeedTriangle++;
+			if (triangle == kUnassignedVertex && nextSeedTriangle < triangleCount)
+			{
+				uint32_t newVertexCount = 0;
+				for (int32_t l=0; l<3; ++l)
+					newVertexCount += (chunkVertexSlots[indices[nextSeedTriangle*3 + l]] == kUnassignedVertex)? 1 : 0;
+				if (chunk.vertexCount + newVertexCount <= maxVertices)
+					triangle = nextSeedTriangle;
+			}
+		}
+
+		chunk.indexCount = chunkTriangleCount * 3;
+		GenerateChunkBounds(&chunk, positions, vertexComponents, &vertexIndices[chunk.vertexOffset], indices, chunkTriangles, chunkTriangleCount);
+
+		for (uint32_t i=chunk.vertexOffset; i<vertexIndexCount; ++i)
+			chunkVertexSlots[vertexIndices[i]] = kUnassignedVertex;
+	}
+
+	outChunks->chunkCount = chunkCount;
+	outChunks->vertexIndexCount = vertexIndexCount;
+	outChunks->localIndexCount = localIndexCount;
+	outChunks->localIndexStride = localIndexStride;
+	outChunks->chunks = (TriMeshChunk*)memalign(16, (chunkCount + 1) * sizeof(TriMeshChunk));
+	outChunks->vertexIndices = (uint32_t*)memalign(16, (vertexIndexCount + 1) * sizeof(uint32_t));
+	outChunks->localIndices = memalign(16, (localIndexCount + 1) * localIndexStride);
+	memcpy(outChunks->chunks, chunks, chunkCount * sizeof(TriMeshChunk));
+	memcpy(outChunks->vertexIndices, vertexIndices, vertexIndexCount * sizeof(uint32_t));
+	memcpy(outChunks->localIndices, localIndices, localIndexCount * localIndexStride);
+
+	EFW_SAFE_ALIGNED_FREE(chunks);
+	EFW_SAFE_ALIGNED_FREE(vertexIndices);
+	EFW_SAFE_ALIGNED_FREE(localIndices);
+	EFW_SAFE_ALIGNED_FREE(adjacencyStarts);
+	EFW_SAFE_ALIGNED_FREE(adjacentTriangles);
+	EFW_SAFE_ALIGNED_FREE(chunkVertexSlots);
+	EFW_SAFE_ALIGNED_FREE(chunkTriangles);
+	EFW_SAFE_ALIGNED_FREE(isTriangleEmitted);
+
+	return efwErrs::kOk;
+}
+
+
+void UnprocessedTriMeshHelper::Release(UnprocessedTriMeshChunks* chunks)
+{
+	if (chunks == NULL)
+		return;
+
+	EFW_SAFE_ALIGNED_FREE(chunks->chunks);
+	EFW_SAFE_ALIGNED_FREE(chunks->vertexIndices);
+	EFW_SAFE_ALIGNED_FREE(chunks->localIndices);
+	memset(chunks, 0, sizeof(UnprocessedTriMeshChunks));
+}
+
+
+#if defined(EFW_X86)
+// Kernels return the number of vertices they processed, the scalar loops finish the rest
+EFW_TARGET_ISA("sse4.1")
+static int32_t ScanVertexAttributeRangeSSE41(float minValue[4], float maxValue[4], const float* input, int32_t inputComponentsPerVertex, 
+	int32_t simdVertexCount)
+{
+	__m128 simdMin = _mm_loadu_ps(minValue);
+	__m128 simdMax = _mm_loadu_ps(maxValue);
+	int32_t i = 0;
+	for (; i+1<simdVertexCount; i+=2)
+	{
+		__m128 value0 = _mm_loadu_ps(&input[i*inputComponentsPerVertex]);
+		__m128 value1 = _mm_loadu_ps(&input[(i+1)*inputComponentsPerVertex]);
+		simdMin = _mm_min_ps(simdMin, _mm_min_ps(value0, value1));
+		simdMax = _mm_max_ps(simdMax, _mm_max_ps(value0, value1));
+	}
+
+	_mm_storeu_ps(minValue, simdMin);
+	_mm_storeu_ps(maxValue, simdMax);
+	return i;
+}
+
+
+EFW_TARGET_ISA("avx2")
+static int32_t ScanVertexAttributeRangeAVX2(float minValue[4], float maxValue[4], const float* input, int32_t inputComponentsPerVertex, 
+	int32_t simdVertexCount)
+{
+	// Each register holds two vertices, one per 128b lane
+	const __m128 min4 = _mm_loadu_ps(minValue);
+	const __m128 max4 = _mm_loadu_ps(maxValue);
+	__m256 simdMin = _mm256_insertf128_ps(_mm256_castps128_ps256(min4), min4, 1);
+	__m256 simdMax = _mm256_insertf128_ps(_mm256_castps128_ps256(max4), max4, 1);
+	int32_t i = 0;
+	for (; i+3<simdVertexCount; i+=4)
+	{
+		__m256 value01 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&input[i*inputComponentsPerVertex])), 
+			_mm_loadu_ps(&input[(i+1)*inputComponentsPerVertex]), 1);
+		__m256 value23 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&input[(i+2)*inputComponentsPerVertex])), 
+			_mm_loadu_ps(&input[(i+3)*inputComponentsPerVertex]), 1);
+		simdMin = _mm256_min_ps(simdMin, _mm256_min_ps(value01, value23));
+		simdMax = _mm256_max_ps(simdMax, _mm256_max_ps(value01, value23));
+	}
+
+	_mm_storeu_ps(minValue, _mm_min_ps(_mm256_castps256_ps128(simdMin), _mm256_extractf128_ps(simdMin, 1)));
+	_mm_storeu_ps(maxValue, _mm_max_ps(_mm256_castps256_ps128(simdMax), _mm256_extractf128_ps(simdMax, 1)));
+	return i;
+}
+#endif
+
+
+/**
+ * Scans the per-component range of a vertex attribute. The first simdVertexCount vertices may be read 4 floats at a time.
+ */
+static void ScanVertexAttributeRange(float minValue[4], float maxValue[4], const float* input, int32_t componentCount, 
+	int32_t inputComponentsPerVertex, int32_t vertexCount, int32_t simdVertexCount)
+{
+	int32_t i = 0;
+#if defined(EFW_X86)
+	// Kernels track all 4 components, the ones past the attribute are dropped
+	float simdMinValue[4] = {FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX};
+	float simdMaxValue[4] = {-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX};
+	const int32_t simdTier = Cpu::GetSimdTier();
+	if (simdTier >= SimdTiers::kAVX2)
+		i = ScanVertexAttributeRangeAVX2(simdMinValue, simdMaxValue, input, inputComponentsPerVertex, simdVertexCount);
+	else if (simdTier >= SimdTiers::kSSE41)
+		i = ScanVertexAttributeRangeSSE41(simdMinValue, simdMaxValue, input, inputComponentsPerVertex, simdVertexCount);
+
+	for (int32_t j=0; j<componentCount; j++)
+	{
+		minValue[j] = (minValue[j]>simdMinValue[j])? simdMinValue[j] : minValue[j];
+		maxValue[j] = (maxValue[j]>simdMaxValue[j])? maxValue[j] : simdMaxValue[j];
+	}
+#else
+	EFW_UNUSED(simdVertexCount);
+#endif
+
+	for (; i<vertexCount; i++)
+	{
+		for (int32_t j=0; j<componentCount; j++)
+		{
+			float value = input[i*inputComponentsPerVertex+j];
+			minValue[j] = (minValue[j]>value)? value : minValue[j];
+			maxValue[j] = (maxValue[j]>value)? maxValue[j] : value;
+		}
+	}
+}
+
+
+// Quantization constants padded to 4 components
+struct VertexQuantizeParams
+{
+	EFW_ALIGNED_TYPE(16, float) scale[4];
+	EFW_ALIGNED_TYPE(16, float) bias[4];
+	float conversionScale;
+	float conversionBias;
+	float unormMax;
+};
+
+
+#if defined(EFW_X86)
+// Stores write 4 components per vertex, so callers leave the last vertices to the scalar loop
+EFW_TARGET_ISA("sse4.1")
+static int32_t QuantizeVertexAttributeSSE41(void* output, int32_t outputComponentSize, const float* input, int32_t outputComponentsPerVertex, 
+	int32_t inputComponentsPerVertex, int32_t simdVertexCount, const VertexQuantizeParams& params)
+{
+	const __m128 simdScale = _mm_load_ps(params.scale);
+	const __m128 simdBias = _mm_load_ps(params.bias);
+	const __m128 simdConversionScale = _mm_set1_ps(params.conversionScale);
+	const __m128 simdConversionBias = _mm_set1_ps(params.conversionBias);
+	const __m128 simdUnormMax = _mm_set1_ps(params.unormMax);
+
+	int32_t i = 0;
+	for (; i<simdVertexCount; i++)
+	{
+		__m128 value = _mm_loadu_ps(&input[i*inputComponentsPerVertex]);
+		__m128 valueWithScaleBias = _mm_div_ps(_mm_sub_ps(value, simdBias), simdScale);
+		__m128 finalValue = _mm_add_ps(_mm_mul_ps(valueWithScaleBias, simdConversionScale), simdConversionBias);
+		__m128i unormValue = _mm_cvttps_epi32(_mm_mul_ps(finalValue, simdUnormMax));
+
+		if (outputComponentSize == sizeof(uint8_t))
+		{
+			__m128i packed = _mm_packus_epi16(_mm_packs_epi32(unormValue, unormValue), _mm_setzero_si128());
+			int32_t packedValue = _mm_cvtsi128_si32(packed);
+			memcpy(&((uint8_t*)output)[i*outputComponentsPerVertex], &packedValue, sizeof(packedValue));
+		}
+		else
+		{
+			__m128i packed = _mm_packus_epi32(unormValue, unormValue);
+			_mm_storel_epi64((__m128i*)&((uint16_t*)output)[i*outputComponentsPerVertex], packed);
+		}
+	}
+	return i;
+}
+
+
+EFW_TARGET_ISA("avx2")
+static int32_t QuantizeVertexAttributeAVX2(void* output, int32_t outputComponentSize, const float* input, int32_t outputComponentsPerVertex, 
+	int32_t inputComponentsPerVertex, int32_t simdVertexCount, const VertexQuantizeParams& params)
+{
+	// Each register holds two vertices, one per 128b lane, and the packs work within lanes
+	const __m256 simdScale = _mm256_broadcast_ps((const __m128*)params.scale);
+	const __m256 simdBias = _mm256_broadcast_ps((const __m128*)params.bias);
+	const __m256 simdConversionScale = _mm256_set1_ps(params.conversionScale);
+	const __m256 simdConversionBias = _mm256_set1_ps(params.conversionBias);
+	const __m256 simdUnormMax = _mm256_set1_ps(params.unormMax);
+
+	int32_t i = 0;
+	for (; i+1<simdVertexCount; i+=2)
+	{
+		__m256 value = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&input[i*inputComponentsPerVertex])), 
+			_mm_loadu_ps(&input[(i+1)*inputComponentsPerVertex]), 1);
+		__m256 valueWithScaleBias = _mm256_div_ps(_mm256_sub_ps(value, simdBias), simdScale);
+		__m256 finalValue = _mm256_add_ps(_mm256_mul_ps(valueWithScaleBias, simdConversionScale), simdConversionBias);
+		__m256i unormValue = _mm256_cvttps_epi32(_mm256_mul_ps(finalValue, simdUnormMax));
+
+		// Vertices are stored in order, so the second one overwrites the padding components of the first
+		if (outputComponentSize == sizeof(uint8_t))
+		{
+			__m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(unormValue, unormValue), _mm256_setzero_si256());
+			int32_t packedValue0 = _mm_cvtsi128_si32(_mm256_castsi256_si128(packed));
+			int32_t packedValue1 = _mm_cvtsi128_si32(_mm256_extracti128_si256(packed, 1));
+			memcpy(&((uint8_t*)output)[i*outputComponentsPerVertex], &packedValue0, sizeof(packedValue0));
+			memcpy(&((uint8_t*)output)[(i+1)*outputComponentsPerVertex], &packedValue1, sizeof(packedValue1));
+		}
+		else
+		{
+			__m256i packed = _mm256_packus_epi32(unormValue, unormValue);
+			_mm_storel_epi64((__m128i*)&((uint16_t*)output)[i*outputComponentsPerVertex], _mm256_castsi256_si128(packed));
+			_mm_storel_epi64((__m128i*)&((uint16_t*)output)[(i+1)*outputComponentsPerVertex], _mm256_extracti128_si256(packed, 1));
+		}
+	}
+	return i;
+}
+#endif
+
+
+/**
+ * Quantizes a vertex attribute to 8b or 16b unsigned normalized values. The SIMD kernels run the same operations as the 
+ * scalar loop, so every tier produces the same output.
+ */
+static void QuantizeVertexAttribute(void* output, int32_t outputComponentSize, const float* input, int32_t outputComponentsPerVertex, 
+	int32_t inputComponentsPerVertex, int32_t vertexCount, int32_t simdVertexCount, const float scale[4], const float bias[4], 
+	float conversionScale, float conversionBias)
+{
+	VertexQuantizeParams params;
+	for (int32_t j=0; j<4; j++)
+	{
+		params.scale[j] = (j < outputComponentsPerVertex)? scale[j] : 1.0f;
+		params.bias[j] = (j < outputComponentsPerVertex)? bias[j] : 0.0f;
+	}
+	params.conversionScale = conversionScale;
+	params.conversionBias = conversionBias;
+	params.unormMax = (outputComponentSize == sizeof(uint8_t))? (float)UINT8_MAX : (float)UINT16_MAX;
+
+	int32_t i = 0;
+#if defined(EFW_X86)
+	// Stores write 4 components, so the last vertices are left to the scalar loop
+	int32_t overwrittenVertices = (4 - outputComponentsPerVertex + outputComponentsPerVertex - 1) / outputComponentsPerVertex;
+	simdVertexCount = Math::Min(simdVertexCount, vertexCount - overwrittenVertices);
+
+	const int32_t simdTier = Cpu::GetSimdTier();
+	if (simdTier >= SimdTiers::kAVX2)
+		i = QuantizeVertexAttributeAVX2(output, outputComponentSize, input, outputComponentsPerVertex, inputComponentsPerVertex, simdVertexCount, params);
+	else if (simdTier >= SimdTiers::kSSE41)
+		i = QuantizeVertexAttributeSSE41(output, outputComponentSize, input, outputComponentsPerVertex, inputComponentsPerVertex, simdVertexCount, params);
+#else
+	EFW_UNUSED(simdVertexCount);
+#endif
+
+	for (; i<vertexCount; i++)
+	{
+		for (int32_t j=0; j<outputComponentsPerVertex; j++)
+		{
+			float value = input[i*inputComponentsPerVertex+j];
+			float valueWithScaleBias = (value-params.bias[j])/params.scale[j];
+			float finalValue = (valueWithScaleBias * params.conversionScale + params.conversionBias);
+			EFW_ASSERT( finalValue >= 0.0f && finalValue <= 1.0f );
+
+			if (outputComponentSize == sizeof(uint8_t))
+				((uint8_t*)output)[i*outputComponentsPerVertex+j] = (uint8_t)(finalValue * params.unormMax);
+			else
+				((uint16_t*)output)[i*outputComponentsPerVertex+j] = (uint16_t)(finalValue * params.unormMax);
+		}
+	}
+}
+
+
 int32_t InternalCompressVertexAttribute(void* output, const float* input, int32_t outputComponentsPerVertex, int32_t inputComponentsPerVertex, int32_t vertexCount,
-	int32_t attributeCompression, float scale[4], float bias[4])
+	int32_t simdVertexCount, int32_t attributeCompression, float scale[4], float bias[4])
 {
 	EFW_ASSERT(output != NULL && input != NULL);
 	EFW_ASSERT(outputComponentsPerVertex <= inputComponentsPerVertex);
@@ -370,34 +1623,14 @@ int32_t InternalCompressVertexAttribute(void* output, const float* input, int32_
 	if (attributeCompression == AttributeCompressions::kSFloatNormToU8Norm || attributeCompression == AttributeCompressions::kUFloatNormToU8Norm ||
 		attributeCompression == AttributeCompressions::kSFloatToU8NormWithScaleAndBias || attributeCompression == AttributeCompressions::kUFloatToU8NormWithScaleAndBias)
 	{
-		for (int32_t i=0; i<vertexCount; i++)
-		{
-			for (int32_t j=0; j<outputComponentsPerVertex; j++)
-			{
-				float value = input[i*inputComponentsPerVertex+j];
-				float valueWithScaleBias = (value-bias[j])/scale[j];
-				float finalValue = (valueWithScaleBias * conversionScale + conversionBias);
-				EFW_ASSERT( finalValue >= 0.0f && finalValue <= 1.0f );
-
-				((uint8_t*)output)[i*outputComponentsPerVertex+j] = (uint8_t)(finalValue * UINT8_MAX);
-			}
-		}
+		QuantizeVertexAttribute(output, sizeof(uint8_t), input, outputComponentsPerVertex, inputComponentsPerVertex, vertexCount, simdVertexCount, 
+			scale, bias, conversionScale, conversionBias);
 	}
 	else if (attributeCompression == AttributeCompressions::kSFloatNormToU16Norm || attributeCompression == AttributeCompressions::kUFloatNormToU16Norm ||
 		attributeCompression == AttributeCompressions::kSFloatToU16NormWithScaleAndBias || attributeCompression == AttributeCompressions::kUFloatToU16NormWithScaleAndBias )
 	{
-		for (int32_t i=0; i<vertexCount; i++)
-		{
-			for (int32_t j=0; j<outputComponentsPerVertex; j++)
-			{
-				float value = input[i*inputComponentsPerVertex+j];
-				float valueWithScaleBias = (value-bias[j])/scale[j];
-				float finalValue = (valueWithScaleBias * conversionScale + conversionBias);
-				EFW_ASSERT( finalValue >= 0.0f && finalValue <= 1.0f );
-
-				((uint16_t*)output)[i*outputComponentsPerVertex+j] = (uint16_t)(finalValue * UINT16_MAX);
-			}
-		}
+		QuantizeVertexAttribute(output, sizeof(uint16_t), input, outputComponentsPerVertex, inputComponentsPerVertex, vertexCount, simdVertexCount, 
+			scale, bias, conversionScale, conversionBias);
 	}
 	else
 	{
@@ -425,6 +1658,10 @@ int32_t UnprocessedTriMeshHelper::CompressVertexAttribute(void** outData, const
 	float* vertexData = (float*)( (uint8_t*)inputVertexData + attribute.offset );
 	void* newAttributeData = memalign(16, sizeof(uint16_t)*attribute.componentCount*vertexCount);
 
+	// Vertices that can be read 4 components at a time without going past the vertex data
+	int32_t simdOverreadSize = attribute.offset + 4*sizeof(float) - vertexStride;
+	int32_t simdVertexCount = vertexCount - ((simdOverreadSize > 0)? (simdOverreadSize + vertexStride - 1) / vertexStride : 0);
+
 	bool useScaleAndBias = (attributeCompression == AttributeCompressions::kSFloatToU8NormWithScaleAndBias
 			|| attributeCompression == AttributeCompressions::kSFloatToU16NormWithScaleAndBias
 			|| attributeCompression == AttributeCompressions::kUFloatToU8NormWithScaleAndBias
@@ -440,15 +1677,7 @@ int32_t UnprocessedTriMeshHelper::CompressVertexAttribute(void** outData, const
 		maxValue[0] = maxValue[1] = maxValue[2] = maxValue[3] = -FLT_MAX;
 		
 		// Get the min and max value for each component
-		for (int32_t i=0; i<vertexCount; i++)
-		{
-			for (int32_t j=0; j<attribute.componentCount; j++)
-			{
-				float value = vertexData[i*vertexDataComponents+j];
-				minValue[j] = (minValue[j]>value)? value : minValue[j];
-				maxValue[j] = (maxValue[j]>value)? maxValue[j] : value;
-			}
-		}
+		ScanVertexAttributeRange(minValue, maxValue, vertexData, attribute.componentCount, vertexDataComponents, vertexCount, simdVertexCount);
 
 		// Get the length for each component
 		for (int32_t i=0; i<attribute.componentCount; i++)
@@ -466,7 +1695,7 @@ int32_t UnprocessedTriMeshHelper::CompressVertexAttribute(void** outData, const
 	}
 
 	int32_t result = InternalCompressVertexAttribute(newAttributeData, vertexData, attribute.componentCount, vertexDataComponents, vertexCount, 
-		attributeCompression, scale, bias);
+		simdVertexCount, attributeCompression, scale, bias);
 	
 	*outData = newAttributeData;
 	if (useScaleAndBias && outPerComponentBias != NULL && outPerComponentScale != NULL)
@@ -14,6 +14,7 @@
 #pragma once
 
 #include "Foundation/efwPlatform.h"
+#include "Graphics/efwTriMesh.h"
 #include "Graphics/efwUnprocessedTriMesh.h"
 
 #include "Math/efwVectorMath.h"
@@ -80,14 +81,91 @@ namespace Graphics
 		const int32_t kUvw0_AveragaUniques				= 1<<6;
 	}
 
+	namespace VertexCache
+	{
+		const int32_t kDefaultCacheSize = 16;
+	}
+
+	struct VertexCacheStats
+	{
+		float acmr;								// Average cache miss ratio, transformed vertices per triangle
+		float atvr;								// Average transformed vertex ratio, transformed vertices per vertex
+	};
+
+	namespace MeshChunkLimits
+	{
+		const uint32_t kDefaultMaxVertices = 64;
+		const uint32_t kDefaultMaxTriangles = 124;
+		const uint32_t kMaxVertices = 0xFFFF;
+	}
+
+	/**
+	 * Mesh split in chunks. Chunk vertices are ranges of the vertex indices, which index the mesh vertices, and chunk 
+	 * indices are local to their range: 8b when chunks have up to 256 vertices, 16b otherwise.
+	 */
+	struct UnprocessedTriMeshChunks
+	{
+		uint32_t chunkCount;
+		uint32_t vertexIndexCount;
+		uint32_t localIndexCount;
+		uint32_t localIndexStride;
+		TriMeshChunk* chunks;
+		uint32_t* vertexIndices;
+		void* localIndices;
+	};
+
 
 	namespace UnprocessedTriMeshHelper
 	{
 		int32_t GenerateAABoundingBox(AABoundingBox* outBoudingBox, const UnprocessedTriMesh& mesh);
+		int32_t GenerateAABoundingBox(AABoundingBox* outBoudingBox, const UnprocessedTriModel& model);
+
+		/**
+		 * Generates a bounding sphere with Ritter's algorithm, growing it towards the farthest vertex, and refines its 
+		 * center with Badoiu-Clarkson iterations. The sphere centered in the bounding box is returned instead when it's 
+		 * smaller. Model spheres bound the vertices of all meshes.
+		 */
+		int32_t GenerateBoundingSphere(BoundingSphere* outBoudingSphere, const UnprocessedTriMesh& mesh);
+		int32_t GenerateBoundingSphere(BoundingSphere* outBoudingSphere, const UnprocessedTriModel& model);
 		void GenerateBoundingSphere(float* outBoudingSphere, const UnprocessedTriMesh& mesh);
 		void MergeBoundingSphere(float* outBoudingSphere, const float* boudingSphere1, const float* boudingSphere2);
 
-		int32_t MergeDuplicatedVertices(UnprocessedTriMesh* mesh, float positionDeltaThreashold, int32_t mergeDuplicateFlags);
+		/**
+		 * Merges vertices closer than the threshold, replacing them by their average.
+		 * 
+		 * @param threadCount Number of threads welding the mesh, or 0 to use one per hardware thread. Extra threads come 
+		 * from the WorkerPool, which must be initialized. 
+		 * Welding in parallel gives the same mesh as welding serially.
+		 */
+		int32_t MergeDuplicatedVertices(UnprocessedTriMesh* mesh, float positionDeltaThreashold, int32_t mergeDuplicateFlags, int32_t threadCount = 1);
+
+		/**
+		 * Simulates a FIFO post-transform vertex cache over the mesh triangles.
+		 */
+		int32_t AnalyzeVertexCache(VertexCacheStats* outStats, const UnprocessedTriMesh& mesh, int32_t cacheSize = VertexCache::kDefaultCacheSize);
+
+		/**
+		 * Reorders the mesh triangles for the post-transform vertex cache with Tipsify. Vertices are left untouched.
+		 * 
+		 * @param overdrawThreshold Zero to disable overdraw optimization. Otherwise triangles are clustered and clusters 
+		 * sorted to reduce overdraw, letting the ACMR of each cluster grow up to this factor (e.g. 1.05).
+		 */
+		int32_t OptimizeVertexCache(UnprocessedTriMesh* mesh, int32_t cacheSize = VertexCache::kDefaultCacheSize, float overdrawThreshold = 0.0f, 
+			VertexCacheStats* outStatsBefore = NULL, VertexCacheStats* outStatsAfter = NULL);
+
+		/**
+		 * Reorders vertices in the order triangles first use them, and remaps the indices to match. Run it after the 
+		 * triangles are reordered. Vertices no triangle uses are removed.
+		 */
+		int32_t OptimizeVertexFetch(UnprocessedTriMesh* mesh);
+
+		/**
+		 * Splits the mesh in chunks of adjacent triangles with bounded vertex and triangle counts, each with a bounding 
+		 * sphere and normal cone for culling. Chunks follow the triangle order, so optimize the vertex cache first.
+		 */
+		int32_t BuildMeshChunks(UnprocessedTriMeshChunks* outChunks, const UnprocessedTriMesh& mesh, 
+			uint32_t maxVertices = MeshChunkLimits::kDefaultMaxVertices, uint32_t maxTriangles = MeshChunkLimits::kDefaultMaxTriangles);
+		void Release(UnprocessedTriMeshChunks* chunks);
 
 		int32_t CompressVertexAttribute(void** outData, const float* inputVertexData, int32_t vertexStride, int32_t vertexCount, UnprocessedTriMeshVertexAttribute attribute, 
 			AttributeCompression compressionType, float* outPerComponentScale = NULL, float* outPerComponentBias = NULL);
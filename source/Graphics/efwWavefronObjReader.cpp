@@ -1,13 +1,14 @@
 #include "Graphics/efwWavefrontObjReader.h"
 
 #include <vector>
-#include <map>
 
 #include "Foundation/efwMemory.h"
 #include "Foundation/efwConsole.h"
 #include "Foundation/efwFileReader.h"
 #include "Foundation/efwPathHelper.h"
+#include "Foundation/efwResourceTable.h"
 #include "Foundation/efwStringHelper.h"
+#include "Foundation/efwThread.h"
 #include "Graphics/efwTextureReader.h"
 #include "Graphics/efwUnprocessedTriMesh.h"
 #include "Math/efwMath.h"
@@ -32,6 +33,155 @@ struct WavefrontObjVertexAttributes
 	vector<WavefrontObjVertexAttribute> uvs;
 };
 
+// Attribute indices of one vertex, 32b each. Face indices are parsed up to 9 digits, so models may have up to 999999999 
+// attributes of each kind. Missing attributes are kMissingVertexIndex.
+struct WavefrontObjVertexKey
+{
+	uint32_t position;
+	uint32_t normal;
+	uint32_t uv;
+};
+
+const uint32_t kMissingVertexIndex = 0xFFFFFFFF;
+
+
+/**
+ * Open-addressing (linear probing) map from a vertex key to its interleaved vertex index.
+ * Slots are only valid when their generation matches the map generation, so Reset doesn't touch the storage, 
+ * which is reused by every group in the file.
+ */
+class VertexIndexMap : NonCopyable
+{
+public:
+	VertexIndexMap() : mEntries(NULL), mCapacity(0), mCount(0), mGeneration(1) {}
+	~VertexIndexMap() { EFW_SAFE_ALIGNED_FREE(mEntries); }
+
+	void Reset()
+	{
+		mCount = 0;
+		mGeneration++;
+
+		// Generation wrapped, stale slots would become valid again
+		if (mGeneration == 0)
+		{
+			if (mEntries != NULL)
+				memset(mEntries, 0, mCapacity * sizeof(Entry));
+			mGeneration = 1;
+		}
+	}
+
+	// Returns the index of the key, inserting it with the next free index when not found
+	int32_t FindOrInsert(const WavefrontObjVertexKey& key, bool* outInserted)
+	{
+		if ((uint64_t)(mCount + 1) * 4 > (uint64_t)mCapacity * 3)
+			Grow();
+
+		const uint32_t mask = mCapacity - 1;
+		uint32_t slot = Hash(key) & mask;
+		while (mEntries[slot].generation == mGeneration)
+		{
+			const WavefrontObjVertexKey& entryKey = mEntries[slot].key;
+			if (entryKey.position == key.position && entryKey.normal == key.normal && entryKey.uv == key.uv)
+			{
+				*outInserted = false;
+				return mEntries[slot].value;
+			}
+			slot = (slot + 1) & mask;
+		}
+
+		mEntries[slot].key = key;
+		mEntries[slot].value = mCount;
+		mEntries[slot].generation = mGeneration;
+		*outInserted = true;
+		return mCount++;
+	}
+
+private:
+	struct Entry
+	{
+		WavefrontObjVertexKey key;
+		int32_t value;
+		uint32_t generation;
+	};
+
+	Entry* mEntries;
+	uint32_t mCapacity;
+	int32_t mCount;
+	uint32_t mGeneration;
+
+	static EFW_INLINE uint32_t Hash(const WavefrontObjVertexKey& vertexKey)
+	{
+		uint64_t key = (((uint64_t)vertexKey.normal << 32) | vertexKey.position) ^ ((uint64_t)vertexKey.uv * 0x9e3779b97f4a7c15ULL);
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		return (uint32_t)key;
+	}
+
+	void Grow()
+	{
+		const uint32_t kMinCapacity = 4096;
+		uint32_t newCapacity = (mCapacity > 0)? mCapacity * 2 : kMinCapacity;
+		Entry* newEntries = (Entry*)memalign(64, newCapacity * sizeof(Entry));
+		memset(newEntries, 0, newCapacity * sizeof(Entry));
+
+		// Only entries of the current generation are kept, and they all become generation 1
+		const uint32_t newMask = newCapacity - 1;
+		for (uint32_t i=0; i<mCapacity; ++i)
+		{
+			if (mEntries[i].generation != mGeneration)
+				continue;
+
+			uint32_t slot = Hash(mEntries[i].key) & newMask;
+			while (newEntries[slot].generation != 0)
+				slot = (slot + 1) & newMask;
+			newEntries[slot] = mEntries[i];
+			newEntries[slot].generation = 1;
+		}
+
+		EFW_SAFE_ALIGNED_FREE(mEntries);
+		mEntries = newEntries;
+		mCapacity = newCapacity;
+		mGeneration = 1;
+	}
+};
+
+
+// Reads the whole file through the custom read function, or maps it when none is provided
+static int32_t OpenFileData(MappedFile* outFileData, const char* fullFilePath, WavefrontObjReader::ReadFileFunc_t readFileFunc, int32_t requiredAlignment)
+{
+	if (readFileFunc == NULL)
+		return FileReader::Map(outFileData, fullFilePath, FileMapHints::kSequential, requiredAlignment);
+
+	memset(outFileData, 0, sizeof(MappedFile));
+	void* fileData = NULL;
+	uint64_t fileDataSize = 0;
+	int32_t result = (*readFileFunc)(&fileData, &fileDataSize, fullFilePath, requiredAlignment);
+	if (result != efwErrs::kOk || fileData == NULL)
+	{
+		EFW_SAFE_ALIGNED_FREE(fileData);
+		return (result != efwErrs::kOk)? result : efwErrs::kInvalidInput;
+	}
+
+	// Parsers rely on the zeroed padding of mapped views, so the data is copied as FileReader does when it can't map
+	size_t allocationSize = (size_t)fileDataSize + FileReader::kMappedFilePadding;
+	uint8_t* paddedData = (uint8_t*)memalign(requiredAlignment, allocationSize);
+	if (paddedData == NULL)
+	{
+		freealign(fileData);
+		return efwErrs::kOperationFailed;
+	}
+	memcpy(paddedData, fileData, (size_t)fileDataSize);
+	memset(paddedData + fileDataSize, 0, FileReader::kMappedFilePadding);
+	freealign(fileData);
+
+	outFileData->data = paddedData;
+	outFileData->size = fileDataSize;
+	outFileData->mappedAddress = paddedData;
+	outFileData->mappedSize = allocationSize;
+	return efwErrs::kOk;
+}
+
 
 void WavefrontObjReader::Release(UnprocessedTriModel* model)
 {
@@ -39,11 +189,18 @@ void WavefrontObjReader::Release(UnprocessedTriModel* model)
 		return;
 
 	for (uint32_t i=0; i < model->meshCount; ++i)
-	{
-		EFW_SAFE_ALIGNED_FREE(model->meshes[i].customUserData);
-		EFW_SAFE_ALIGNED_FREE(model->meshes[i].vertexData);
-		EFW_SAFE_ALIGNED_FREE(model->meshes[i].indexData);
-	}
+		Release(&model->meshes[i]);
+}
+
+
+void WavefrontObjReader::Release(UnprocessedTriMesh* mesh)
+{
+	if (mesh == NULL)
+		return;
+
+	EFW_SAFE_ALIGNED_FREE(mesh->customUserData);
+	EFW_SAFE_ALIGNED_FREE(mesh->vertexData);
+	EFW_SAFE_ALIGNED_FREE(mesh->indexData);
 }
 
 
@@ -60,144 +217,167 @@ void WavefrontObjReader::Release(UnprocessedMaterialLib* materialLib)
 }
 
 
-int32_t ParseVertexAttribute(WavefrontObjVertexAttributes* outVertexAttributes, const TokenArray* tokenArray)
+/**
+ * Parses a "v", "vn" or "vt" line, reading directly from the file data. Texture coordinates may have 2 or 3 components.
+ * 
+ * @param str Start of the line keyword.
+ * @param strEnd End of the line (the '\n' or the end of the file data).
+ */
+int32_t ParseVertexAttribute(WavefrontObjVertexAttributes* outVertexAttributes, const char* str, const char* strEnd)
 {
-	if (tokenArray->count < 4)
+	vector<WavefrontObjVertexAttribute>* pushArray = NULL;
+	int32_t requiredComponentCount = 3;
+	switch(str[1])
 	{
+	case ' ':
+	case '\t':
+		pushArray = &outVertexAttributes->positions;
+		str += 1;
+		break;
+	case 't':
+		pushArray = &outVertexAttributes->uvs;
+		requiredComponentCount = 2;
+		str += 2;
+		break;
+	case 'n':
+		pushArray = &outVertexAttributes->normals;
+		str += 2;
+		break;
+
+		// Not handled
+	default:
 		//Console::WriteLine("Line %06d: [SKIPPED] Invalid or not supported data!", gModelInputLineCount);
 		return efwErrs::kInvalidInput;
 	}
-	else if (tokenArray->count > 4)
-	{
-		Console::WriteLine("Line %06d: Too many tokens in line! Part of the data in being discarded!", gModelInputLineCount);
-	}
-
-	const char* token = StringHelper::GetTokenAt(tokenArray, 0);
 
-	vector<WavefrontObjVertexAttribute>* pushArray = NULL;
-	if (token[0] == 'v')
+	const int32_t kMaxComponentCount = 3;
+	float components[kMaxComponentCount] = { 0.0f, 0.0f, 0.0f };
+	int32_t componentCount = 0;
+	while (true)
 	{
-		switch(token[1])
-		{
-		case '\0':
-			pushArray = &outVertexAttributes->positions;
-			break;
-		case 't':
-			pushArray = &outVertexAttributes->uvs;
+		while (str < strEnd && (*str == ' ' || *str == '\t' || *str == '\r'))
+			str++;
+		if (str == strEnd)
 			break;
-		case 'n':
-			pushArray = &outVertexAttributes->normals;
+
+		if (componentCount == kMaxComponentCount)
+		{
+			Console::WriteLine("Line %06d: Too many tokens in line! Part of the data in being discarded!", gModelInputLineCount);
 			break;
+		}
 
-			// Not handled
-		default:
+		int32_t readCount = StringHelper::ParseFloat(&components[componentCount], str, strEnd);
+		str += readCount;
+		if (readCount == 0 || (str < strEnd && *str != ' ' && *str != '\t' && *str != '\r'))
+		{
 			//Console::WriteLine("Line %06d: [SKIPPED] Invalid or not supported data!", gModelInputLineCount);
 			return efwErrs::kInvalidInput;
 		}
+		componentCount++;
+	}
+
+	if (componentCount < requiredComponentCount)
+	{
+		//Console::WriteLine("Line %06d: [SKIPPED] Invalid or not supported data!", gModelInputLineCount);
+		return efwErrs::kInvalidInput;
 	}
 
 	WavefrontObjVertexAttribute attr;
-	attr.x = (float)atof( StringHelper::GetTokenAt(tokenArray, 1) );
-	attr.y = (float)atof( StringHelper::GetTokenAt(tokenArray, 2) );
-	attr.z = (float)atof( StringHelper::GetTokenAt(tokenArray, 3) );
+	attr.x = components[0];
+	attr.y = components[1];
+	attr.z = components[2];
 	pushArray->push_back( attr );
 
 	return efwErrs::kOk;
 }
 
 
-int32_t ParseFace(vector<int32_t>* outIndexData, vector<uint64_t>* currentVertexIndexToAttributes, 
-	map<uint64_t, int32_t>* currentVertexAttributesToIndex, const WavefrontObjVertexAttributes& vertexAttributes, const TokenArray* tokenArray)
+const int32_t kMaxVerticesPerFace = 4;
+const int32_t kFaceIndicesPerVertex = 3;
+
+// Parses one OBJ index as written in the file (1-based, or negative to index backwards from the last attribute)
+static EFW_INLINE bool ParseFaceIndex(int32_t* outIndex, const char** str, const char* strEnd)
 {
-	// Only supports faces with 3 or 4 vertices
-	if (tokenArray->count < 4 || tokenArray->count > 5)
+	const char* current = *str;
+	bool isNegative = (current < strEnd && *current == '-');
+	if (isNegative)
+		current++;
+
+	// Bound the digits so the value fits an int32_t, longer indices end the face and it's skipped
+	const char* digitsStart = current;
+	int32_t value = 0;
+	while (current < strEnd && (uint8_t)(*current - '0') <= 9 && current - digitsStart < 9)
 	{
-		//Console::WriteLine("Line %06d: [SKIPPED] \"%d\" is not supported as the number of faces!", gModelInputLineCount, tokenArray->count);
-		return efwErrs::kInvalidInput;
+		value = value * 10 + (*current - '0');
+		current++;
 	}
+	*str = current;
 
-	// Get the position, texture and normal tokens for each face index
-	const int32_t kMaxVerticesPerFace = 4;
-	const int32_t kMaxAttributesPerVertex = 3;
-	TokenArray* faceVertexAttributes;
-	StringHelper::CreateTokenArray(&faceVertexAttributes, sizeof(Token32), kMaxAttributesPerVertex);
+	if (current == digitsStart || value == 0)
+		return false;
 
-	int32_t faceVertexIndices[kMaxVerticesPerFace];
-	int32_t faceVertexCount = tokenArray->count - 1;
-	for (int32_t i=0; i<faceVertexCount; i++)
-	{
-		const char* kObjTriMeshFaceDemiliters = "/";
-		StringHelper::GetTokens(faceVertexAttributes, StringHelper::GetTokenAt(tokenArray, i+1), kObjTriMeshFaceDemiliters, true);
-		if (faceVertexAttributes->count == 0)
-		{
-			// TODO: Error
-			continue;
-		}
-
-		const int32_t kInvalidIndex = -1;
-		const char* positionToken = StringHelper::GetTokenAt(faceVertexAttributes, 0);
-		const char* uvToken = StringHelper::GetTokenAt(faceVertexAttributes, 1);
-		const char* normalToken = StringHelper::GetTokenAt(faceVertexAttributes, 2);
-		size_t positionIndex = atoi( positionToken ) - 1;
-		size_t uvIndex = (faceVertexAttributes->count > 1 && uvToken[0] != '\0')? atoi(uvToken) - 1 : kInvalidIndex;
-		size_t normalIndex = (faceVertexAttributes->count > 2 && normalToken[0] != '\0')? atoi(normalToken) - 1 : kInvalidIndex;
+	*outIndex = (isNegative)? -value : value;
+	return true;
+}
 
-		// It's much better to validate the face parsing at this point than later
-		const uint32_t kLastIndex = 0xFFFFFFFF;
-		const uint32_t kVertexIndexMask = (1 << 21) - 1;
-		bool positionOutOfBounds = !( positionIndex <= kVertexIndexMask && positionIndex < vertexAttributes.positions.size() );
-		bool indexOutOfBounds = !( (uvIndex == kLastIndex) || (uvIndex <= kVertexIndexMask && uvIndex < vertexAttributes.uvs.size()) );
-		bool normalOutOfBounds = !( (normalIndex == kLastIndex) || (normalIndex <= kVertexIndexMask && normalIndex < vertexAttributes.normals.size()) );
-		if (positionOutOfBounds || indexOutOfBounds || normalOutOfBounds)
-		{
-			//Console::WriteLine("Line %06d: [SKIPPED] Indexing out of bounds attributes!", gModelInputLineCount);
-			continue;
-		}
 
-		// Use 21bits for each vertex attribute index
-		uint64_t vertexGuid = 
-			((uint64_t)(uvIndex & kVertexIndexMask) << 42) | 
-			((uint64_t)(normalIndex & kVertexIndexMask) << 21) | 
-			(positionIndex & kVertexIndexMask);
+/**
+ * Parses the corners of one face line, reading directly from the file data.
+ * Each corner is "p", "p/t", "p//n" or "p/t/n". Indices are kept as written in the file, and missing ones are 0.
+ * 
+ * @param outFaceIndices Position, uv and normal index of each corner, at least kMaxVerticesPerFace * kFaceIndicesPerVertex.
+ * @param str First character after the "f" keyword.
+ * @param strEnd End of the line (the '\n' or the end of the file data).
+ * @return Number of corners, or 0 when the face is invalid or not supported.
+ */
+static int32_t ParseFaceCorners(int32_t* outFaceIndices, const char* str, const char* strEnd)
+{
+	int32_t faceVertexCount = 0;
+	while (true)
+	{
+		while (str < strEnd && (*str == ' ' || *str == '\t' || *str == '\r'))
+			str++;
+		if (str == strEnd)
+			break;
 
-		// 
-		int32_t interleavedVertexIndex = kInvalidIndex;
-		map<uint64_t, int32_t>::iterator it = currentVertexAttributesToIndex->find(vertexGuid);
-		if (it == currentVertexAttributesToIndex->end())
+		// Only supports faces with 3 or 4 vertices
+		if (faceVertexCount == kMaxVerticesPerFace)
 		{
-			interleavedVertexIndex = currentVertexAttributesToIndex->size();
-			currentVertexAttributesToIndex->insert( pair<uint64_t,int32_t>(vertexGuid, interleavedVertexIndex) );
-			currentVertexIndexToAttributes->push_back(vertexGuid);
+			//Console::WriteLine("Line %06d: [SKIPPED] Faces with more than %d vertices are not supported!", gModelInputLineCount, kMaxVerticesPerFace);
+			return 0;
 		}
-		else
+
+		int32_t* faceIndices = &outFaceIndices[faceVertexCount * kFaceIndicesPerVertex];
+		faceIndices[0] = faceIndices[1] = faceIndices[2] = 0;
+		bool isValid = ParseFaceIndex(&faceIndices[0], &str, strEnd);
+		if (isValid && str < strEnd && *str == '/')
 		{
-			interleavedVertexIndex = it->second;
+			str++;
+			if (str < strEnd && *str != '/')
+				isValid = ParseFaceIndex(&faceIndices[1], &str, strEnd);
+			if (isValid && str < strEnd && *str == '/')
+			{
+				str++;
+				isValid = ParseFaceIndex(&faceIndices[2], &str, strEnd);
+			}
 		}
 
-		faceVertexIndices[i] = interleavedVertexIndex;
-	}
-
-	// Append indices
-	if (faceVertexCount == 3)
-	{
-		int32_t indices[] = { 2, 1, 0 };
-		for (int32_t i=0; i<EFW_COUNTOF(indices); i++)
+		bool isTerminated = (str == strEnd || *str == ' ' || *str == '\t' || *str == '\r');
+		if (!isValid || !isTerminated)
 		{
-			outIndexData->push_back( faceVertexIndices[ indices[i] ] );
+			//Console::WriteLine("Line %06d: [SKIPPED] Invalid face indices!", gModelInputLineCount);
+			return 0;
 		}
+		faceVertexCount++;
 	}
-	else if (faceVertexCount == 4)
+
+	if (faceVertexCount < 3)
 	{
-		int32_t indices[] = { 2, 1, 0, 2, 0, 3 };
-		for (int32_t i=0; i<EFW_COUNTOF(indices); i++)
-		{
-			outIndexData->push_back( faceVertexIndices[ indices[i] ] );
-		}
+		//Console::WriteLine("Line %06d: [SKIPPED] \"%d\" is not supported as the number of faces!", gModelInputLineCount, faceVertexCount);
+		return 0;
 	}
 
-	StringHelper::DestroyTokenArray(&faceVertexAttributes);
-
-	return efwErrs::kOk;
+	return faceVertexCount;
 }
 
 
@@ -242,7 +422,7 @@ int32_t FillMeshVertexAttributes(UnprocessedTriMesh* outMesh, const WavefrontObj
 
 
 int32_t GenerateMesh(UnprocessedTriMesh* outMesh, Guid meshGuid, Guid materialRefGuid, const WavefrontObjVertexAttributes& vertexAttributes, 
-	const vector<uint64_t>& vertexList, const vector<int32_t>& indexData)
+	const vector<WavefrontObjVertexKey>& vertexList, const vector<int32_t>& indexData)
 {
 	if (outMesh == NULL)
 	{
@@ -276,26 +456,28 @@ int32_t GenerateMesh(UnprocessedTriMesh* outMesh, Guid meshGuid, Guid materialRe
 	int32_t dataIndex = 0;
 	for (int32_t i=0; i<vertexListCount; ++i)
 	{
-		const uint32_t kIndexMask = (1 << 21) - 1;
-		uint64_t vertexGuid = vertexList[i];
-		int32_t positionIndex = vertexGuid & kIndexMask;
-		int32_t normalIndex = (vertexGuid >> 21) & kIndexMask;
-		int32_t uvIndex = (vertexGuid >> 42) & kIndexMask;
+		const WavefrontObjVertexKey& vertexKey = vertexList[i];
+		const uint32_t positionIndex = vertexKey.position;
+		const uint32_t normalIndex = vertexKey.normal;
+		const uint32_t uvIndex = vertexKey.uv;
 
 		meshVertexData[dataIndex++] = vertexAttributes.positions[positionIndex].x;
 		meshVertexData[dataIndex++] = vertexAttributes.positions[positionIndex].y;
 		meshVertexData[dataIndex++] = vertexAttributes.positions[positionIndex].z;
 
+		// Faces may skip attributes other faces have, those are zero filled
 		if (hasNormals)
 		{
-			meshVertexData[dataIndex++] = vertexAttributes.normals[normalIndex].x;
-			meshVertexData[dataIndex++] = vertexAttributes.normals[normalIndex].y;
-			meshVertexData[dataIndex++] = vertexAttributes.normals[normalIndex].z;
+			const bool hasNormal = (normalIndex != kMissingVertexIndex && normalIndex < vertexAttributes.normals.size());
+			meshVertexData[dataIndex++] = (hasNormal)? vertexAttributes.normals[normalIndex].x : 0.0f;
+			meshVertexData[dataIndex++] = (hasNormal)? vertexAttributes.normals[normalIndex].y : 0.0f;
+			meshVertexData[dataIndex++] = (hasNormal)? vertexAttributes.normals[normalIndex].z : 0.0f;
 		}
 		if (hasUvs)
 		{
-			meshVertexData[dataIndex++] = vertexAttributes.uvs[uvIndex].x;
-			meshVertexData[dataIndex++] = vertexAttributes.uvs[uvIndex].y;
+			const bool hasUv = (uvIndex != kMissingVertexIndex && uvIndex < vertexAttributes.uvs.size());
+			meshVertexData[dataIndex++] = (hasUv)? vertexAttributes.uvs[uvIndex].x : 0.0f;
+			meshVertexData[dataIndex++] = (hasUv)? vertexAttributes.uvs[uvIndex].y : 0.0f;
 		}
 
 		EFW_ASSERT((dataIndex * sizeof(float)) <= (size_t)(vertexListCount * outMesh->vertexStride));
@@ -323,7 +505,7 @@ void DebugPrintVerticesInfo(const WavefrontObjVertexAttributes& vertexAttributes
 }
 
 
-void DebugPrintFacesInfo(const vector<uint64_t>& currentVertexIndexToAttributes)
+void DebugPrintFacesInfo(const vector<WavefrontObjVertexKey>& currentVertexIndexToAttributes)
 {
 	// TODO
 	//int32_t previousMeshIndex = meshes.size() - 1;
@@ -356,13 +538,11 @@ int32_t WavefrontObjReader::ReadMaterialLib(UnprocessedMaterialLib** outMaterial
 	if (outMaterial == NULL || fullFilePath == NULL)
 		return efwErrs::kInvalidInput;
 
-	if (readFileFunc == NULL)
-		readFileFunc = FileReader::ReadAll;
-
 	const int32_t kRequiredAlignment = 1024;
-	void* materialFileData = NULL;
-	uint64_t materialFileDataSize = 0;
-	(*readFileFunc)(&materialFileData, &materialFileDataSize, fullFilePath, kRequiredAlignment);
+	MappedFile materialFile;
+	OpenFileData(&materialFile, fullFilePath, readFileFunc, kRequiredAlignment);
+	const char* materialFileData = (const char*)materialFile.data;
+	uint64_t materialFileDataSize = materialFile.size;
 	
 	vector<UnprocessedMaterial> materials;
 	materials.reserve(1024);
@@ -375,7 +555,7 @@ int32_t WavefrontObjReader::ReadMaterialLib(UnprocessedMaterialLib** outMaterial
 	int32_t fileDataIndex = 0;
 	while (fileDataIndex < materialFileDataSize)
 	{
-		int32_t readedBytes = StringHelper::GetLineTokens(tokenArray, &((char*)materialFileData)[fileDataIndex], kMaterialDelimiters);
+		int32_t readedBytes = StringHelper::GetLineTokens(tokenArray, &materialFileData[fileDataIndex], kMaterialDelimiters);
 		fileDataIndex += readedBytes;
 		gMaterialInputLineCount++;
 
@@ -440,7 +620,7 @@ int32_t WavefrontObjReader::ReadMaterialLib(UnprocessedMaterialLib** outMaterial
 	}
 	// Release data
 	StringHelper::DestroyTokenArray(&tokenArray);
-	EFW_SAFE_ALIGNED_FREE(materialFileData);
+	FileReader::Unmap(&materialFile);
 
 	UnprocessedMaterialLib* materialLib = NULL;
 	int32_t materialCount = materials.size();
@@ -457,60 +637,370 @@ int32_t WavefrontObjReader::ReadMaterialLib(UnprocessedMaterialLib** outMaterial
 }
 
 
-int32_t WavefrontObjReader::ReadModelAndMaterials(UnprocessedTriModel** outModel, UnprocessedMaterialLib** outMaterialLib, const char* fullFilePath, ReadFileFunc_t readFileFunc)
+// Parsing state of one model, shared by the serial and the parallel readers
+struct WavefrontObjModelState
 {
-	if (fullFilePath == NULL || outModel == NULL || outMaterialLib == NULL)
-		return efwErrs::kInvalidInput;
-
-	// Get file directory
-	char currentDirectoryPath[Path::kMaxDirectoryLength];
-	PathHelper::GetDirectory(currentDirectoryPath, Path::kMaxDirectoryLength, fullFilePath);
-
-	// Read OBJ file data
-	const int32_t kRequiredAlignment = 1024;
-	void* objFileData = NULL;
-	uint64_t objFileDataSize = 0;
-	(*readFileFunc)(&objFileData, &objFileDataSize, fullFilePath, kRequiredAlignment);
-
-	TokenArray* tokenArray = NULL;
-	StringHelper::CreateTokenArray(&tokenArray, sizeof(Token32), 8);
-
-	// Vertex attributes are (NEVER erased and always appended)
+	// Vertex attributes are always appended, and only erased by the stream reader, when asked to, once their group closes
 	WavefrontObjVertexAttributes vertexAttributes;
+	// Number of positions, normals and uvs erased from the start of the vertex attributes
+	int64_t vertexAttributeBases[3];
+	// Number of positions, normals and uvs when the last face of the current mesh was added
+	size_t lastFaceAttributeCounts[3];
 	// Index data for the current mesh
 	vector<int32_t> currentIndexData;
 	// List of all vertices for the current mesh (erased for each new group/mesh found)
 	// Each element maps the vertex index to its attributes
-	vector<uint64_t> currentVertexIndexToAttributes;
+	vector<WavefrontObjVertexKey> currentVertexIndexToAttributes;
 	// Each element maps attributes of one vertex to its index
-	map<uint64_t, int32_t> currentVertexAttributesToIndex;
+	VertexIndexMap currentVertexAttributesToIndex;
 	// Stores the GUID of the current mesh
 	Guid currentMeshGuid;
-	currentMeshGuid.initFromRandomSeed();
 	// Stores the GUID of the last referenced material
 	Guid lastReferencedMaterialGuid;
-	memset(&lastReferencedMaterialGuid, 0, sizeof(Guid));
 
 	vector<UnprocessedTriMesh> meshes;
-	UnprocessedMaterialLib* materialLib = NULL;
+	UnprocessedMaterialLib* materialLib;
+	// Maps each material GUID to its index in the material lib
+	ResourceTable materialTable;
+
+	const char* directoryPath;
+	WavefrontObjReader::ReadFileFunc_t readFileFunc;
+
+	// Stream reader only, meshes are handed to the callback instead of being stored
+	WavefrontObjReader::ReadMeshCallback_t meshCallback;
+	void* meshCallbackUserData;
+	int32_t streamFlags;
+	// Stops the read, set by the mesh callback or by faces referencing dropped vertex attributes
+	int32_t streamResult;
+	// Faces indexing out of bounds attributes
+	uint32_t skippedFaceCount;
+};
+
+
+static void InitializeModelState(WavefrontObjModelState* state, const char* directoryPath, WavefrontObjReader::ReadFileFunc_t readFileFunc)
+{
+	state->currentMeshGuid.initFromRandomSeed();
+	memset(&state->lastReferencedMaterialGuid, 0, sizeof(Guid));
+	state->materialLib = NULL;
+	state->directoryPath = directoryPath;
+	state->readFileFunc = readFileFunc;
+	memset(state->vertexAttributeBases, 0, sizeof(state->vertexAttributeBases));
+	memset(state->lastFaceAttributeCounts, 0, sizeof(state->lastFaceAttributeCounts));
+	state->meshCallback = NULL;
+	state->meshCallbackUserData = NULL;
+	state->streamFlags = WavefrontObjReader::StreamFlags::kNone;
+	state->streamResult = efwErrs::kOk;
+	state->skippedFaceCount = 0;
 
 	// Reserve some initial memory
 	const uint32_t kVertexAttributesReserveSize = 64 * 1024;
-	vertexAttributes.positions.reserve(kVertexAttributesReserveSize);
-	vertexAttributes.normals.reserve(kVertexAttributesReserveSize);
-	vertexAttributes.uvs.reserve(kVertexAttributesReserveSize);
-	currentVertexIndexToAttributes.reserve(kVertexAttributesReserveSize);
+	state->vertexAttributes.positions.reserve(kVertexAttributesReserveSize);
+	state->vertexAttributes.normals.reserve(kVertexAttributesReserveSize);
+	state->vertexAttributes.uvs.reserve(kVertexAttributesReserveSize);
+	state->currentVertexIndexToAttributes.reserve(kVertexAttributesReserveSize);
 	const uint32_t kMeshesReserveSize = 64;
-	meshes.reserve(kMeshesReserveSize);
+	state->meshes.reserve(kMeshesReserveSize);
+}
 
-	// Reset global line counter
-	gModelInputLineCount = 0;
 
-	int32_t fileDataIndex = 0;
-	while (fileDataIndex < objFileDataSize)
+// Resolves the face indices against the attributes read so far, and appends the face to the current mesh
+static int32_t AddFace(WavefrontObjModelState* state, const int32_t* faceIndices, int32_t faceVertexCount)
+{
+	const int64_t kInvalidIndex = -1;
+	WavefrontObjVertexKey faceVertexKeys[kMaxVerticesPerFace];
+
+	// Use 32bits for each vertex attribute index, missing attributes are stored as kMissingVertexIndex
+	const int64_t kMaxVertexIndex = (int64_t)kMissingVertexIndex;
+	const int64_t positionCount = (int64_t)state->vertexAttributes.positions.size();
+	const int64_t uvCount = (int64_t)state->vertexAttributes.uvs.size();
+	const int64_t normalCount = (int64_t)state->vertexAttributes.normals.size();
+
+	// Indices are resolved against the attributes that weren't erased, erased ones end up out of bounds
+	const int64_t* bases = state->vertexAttributeBases;
+	for (int32_t i=0; i<faceVertexCount; i++)
+	{
+		const int32_t* vertexIndices = &faceIndices[i * kFaceIndicesPerVertex];
+		const bool hasUv = (vertexIndices[1] != 0);
+		const bool hasNormal = (vertexIndices[2] != 0);
+		int64_t positionIndex = (vertexIndices[0] > 0)? vertexIndices[0] - 1 - bases[0] : positionCount + vertexIndices[0];
+		int64_t uvIndex = (!hasUv)? kInvalidIndex : 
+			(vertexIndices[1] > 0)? vertexIndices[1] - 1 - bases[2] : uvCount + vertexIndices[1];
+		int64_t normalIndex = (!hasNormal)? kInvalidIndex : 
+			(vertexIndices[2] > 0)? vertexIndices[2] - 1 - bases[1] : normalCount + vertexIndices[2];
+
+		// Dropped attributes resolve right below zero. The file doesn't suit kDropGroupVertexAttributes, and skipping 
+		// its faces would silently lose geometry, so the whole read fails.
+		bool positionDropped = (positionIndex < 0 && positionIndex >= -bases[0]);
+		bool uvDropped = (hasUv && uvIndex < 0 && uvIndex >= -bases[2]);
+		bool normalDropped = (hasNormal && normalIndex < 0 && normalIndex >= -bases[1]);
+		if (positionDropped || uvDropped || normalDropped)
+		{
+			state->streamResult = efwErrs::kCorruptedData;
+			return efwErrs::kCorruptedData;
+		}
+
+		// It's much better to validate the face parsing at this point than later
+		bool positionOutOfBounds = !(positionIndex >= 0 && positionIndex < positionCount && positionIndex < kMaxVertexIndex);
+		bool uvOutOfBounds = hasUv && !(uvIndex >= 0 && uvIndex < uvCount && uvIndex < kMaxVertexIndex);
+		bool normalOutOfBounds = hasNormal && !(normalIndex >= 0 && normalIndex < normalCount && normalIndex < kMaxVertexIndex);
+		if (positionOutOfBounds || uvOutOfBounds || normalOutOfBounds)
+		{
+			//Console::WriteLine("Line %06d: [SKIPPED] Indexing out of bounds attributes!", gModelInputLineCount);
+			state->skippedFaceCount++;
+			return efwErrs::kInvalidInput;
+		}
+
+		faceVertexKeys[i].position = (uint32_t)positionIndex;
+		faceVertexKeys[i].normal = (!hasNormal)? kMissingVertexIndex : (uint32_t)normalIndex;
+		faceVertexKeys[i].uv = (!hasUv)? kMissingVertexIndex : (uint32_t)uvIndex;
+	}
+
+	// 
+	int32_t faceVertexIndices[kMaxVerticesPerFace];
+	for (int32_t i=0; i<faceVertexCount; i++)
+	{
+		bool isNewVertex;
+		faceVertexIndices[i] = state->currentVertexAttributesToIndex.FindOrInsert(faceVertexKeys[i], &isNewVertex);
+		if (isNewVertex)
+			state->currentVertexIndexToAttributes.push_back(faceVertexKeys[i]);
+	}
+
+	// Append indices
+	if (faceVertexCount == 3)
+	{
+		int32_t indices[] = { 2, 1, 0 };
+		for (uint32_t i=0; i<EFW_COUNTOF(indices); i++)
+		{
+			state->currentIndexData.push_back( faceVertexIndices[ indices[i] ] );
+		}
+	}
+	else if (faceVertexCount == 4)
+	{
+		int32_t indices[] = { 2, 1, 0, 2, 0, 3 };
+		for (uint32_t i=0; i<EFW_COUNTOF(indices); i++)
+		{
+			state->currentIndexData.push_back( faceVertexIndices[ indices[i] ] );
+		}
+	}
+
+	state->lastFaceAttributeCounts[0] = (size_t)positionCount;
+	state->lastFaceAttributeCounts[1] = (size_t)normalCount;
+	state->lastFaceAttributeCounts[2] = (size_t)uvCount;
+
+	return efwErrs::kOk;
+}
+
+
+// Erases the attributes written up to the last face of the closed mesh, the ones after it belong to the next group
+static void EraseMeshVertexAttributes(WavefrontObjModelState* state)
+{
+	vector<WavefrontObjVertexAttribute>* attributeArrays[] = { 
+		&state->vertexAttributes.positions, &state->vertexAttributes.normals, &state->vertexAttributes.uvs };
+
+	for (uint32_t i=0; i<EFW_COUNTOF(attributeArrays); ++i)
+	{
+		const size_t eraseCount = state->lastFaceAttributeCounts[i];
+		attributeArrays[i]->erase(attributeArrays[i]->begin(), attributeArrays[i]->begin() + eraseCount);
+		state->vertexAttributeBases[i] += eraseCount;
+		state->lastFaceAttributeCounts[i] = 0;
+	}
+}
+
+
+// Generates a mesh from the faces read since the last group, if there are any
+static void FinishMesh(WavefrontObjModelState* state)
+{
+	if (state->currentIndexData.size() > 0 && state->meshCallback != NULL)
+	{
+		DebugPrintFacesInfo(state->currentVertexIndexToAttributes);
+
+		UnprocessedTriMesh mesh;
+		GenerateMesh(&mesh, state->currentMeshGuid, state->lastReferencedMaterialGuid, state->vertexAttributes, 
+			state->currentVertexIndexToAttributes, state->currentIndexData);
+		DebugPrintMeshInfo(mesh);
+
+		// Reset guids
+		state->currentMeshGuid.initFromRandomSeed();
+		memset(&state->lastReferencedMaterialGuid, 0, sizeof(state->lastReferencedMaterialGuid));
+
+		state->streamResult = (*state->meshCallback)(&mesh, state->materialLib, state->meshCallbackUserData);
+		if ((state->streamFlags & WavefrontObjReader::StreamFlags::kDropGroupVertexAttributes) != 0)
+			EraseMeshVertexAttributes(state);
+	}
+	else if (state->currentIndexData.size() > 0)
+	{
+		DebugPrintFacesInfo(state->currentVertexIndexToAttributes);
+
+		int32_t meshIndex = state->meshes.size();
+		state->meshes.resize(state->meshes.size() + 1);
+		GenerateMesh(&state->meshes[meshIndex], state->currentMeshGuid, state->lastReferencedMaterialGuid, state->vertexAttributes, 
+			state->currentVertexIndexToAttributes, state->currentIndexData);
+		
+		// Reset guids
+		state->currentMeshGuid.initFromRandomSeed();
+		memset(&state->lastReferencedMaterialGuid, 0, sizeof(state->lastReferencedMaterialGuid));
+
+		DebugPrintMeshInfo(state->meshes[meshIndex]);
+	}
+
+	// Clear previous data
+	state->currentVertexIndexToAttributes.clear();
+	state->currentVertexAttributesToIndex.Reset();
+	state->currentIndexData.clear();
+}
+
+
+// Handles every line but faces
+static void ParseModelLine(WavefrontObjModelState* state, const TokenArray* tokenArray)
+{
+	const char* tokenKey = StringHelper::GetTokenAt(tokenArray, 0);
+	const char* tokenValue = StringHelper::GetTokenAt(tokenArray, 1);
+
+	char firstSymbol = tokenKey[0];
+	switch (firstSymbol)
+	{
+		// Group (everything from this point until the next group or EOF belongs to this group
+	case 'g':
+		{
+			// Checks whether there are index information from a previous mesh before starting a new group.
+			FinishMesh(state);
+
+			// Read new mesh name
+			if (tokenArray->count > 1)
+			{
+				const char* meshName = StringHelper::GetTokenAt(tokenArray, 1);
+				state->currentMeshGuid.initFromName(meshName);
+			}
+
+			// Print vertices up to this point
+			DebugPrintVerticesInfo(state->vertexAttributes);
+		}
+		break;
+
+		// Material Library (mtlib)
+	case 'm':
+		{
+			if (tokenArray->count > 1 && (strcmp(tokenKey, "mtllib") == 0))
+			{
+				const char* materialFileName = StringHelper::GetTokenAt(tokenArray, 1);
+				char materialFullFilePath[Path::kMaxFullPathLength];
+				PathHelper::Combine(materialFullFilePath, Path::kMaxFullPathLength, state->directoryPath, materialFileName);
+
+				WavefrontObjReader::ReadMaterialLib(&state->materialLib, materialFullFilePath, state->readFileFunc);
+
+				// Duplicated material names keep the first material, as a linear search would
+				state->materialTable.Clear();
+				for (int32_t i=0; state->materialLib != NULL && i<state->materialLib->materialCount; ++i)
+					state->materialTable.Insert(state->materialLib->materials[i].guid.hash64, (uintptr_t)i);
+			}
+			else
+			{
+				//Console::WriteLine("Line %06d: [SKIPPED] \"%s\" is missing a second argument!", gModelInputLineCount, 
+				//	StringHelper::GetTokenAt(tokenArray, 0) );
+			}
+		}
+		break;
+
+		// Material (usemtl)
+	case 'u':
+		{
+			if (state->materialLib != NULL &&
+				tokenArray->count > 1 && (strcmp(tokenKey, "usemtl") == 0))
+			{
+				state->lastReferencedMaterialGuid.initFromName(tokenValue);
+
+				bool materialFound = (state->materialTable.Find(state->lastReferencedMaterialGuid.hash64) != NULL);
+				if (!materialFound)
+				{
+					Console::WriteLine("Line %06d: [SKIPPED] \"%s\" material was not found!", gModelInputLineCount, tokenValue);
+				}
+			}
+			else
+			{
+				// TODO There was no material lib or the material name was invalid
+			}
+		}
+		break;
+
+		// Comments - IGNORED
+	case '#':
+		break;
+
+		// Unhandled symbold
+	default:
+		{
+			//Console::WriteLine("Line %06d: [SKIPPED] \"%s\" is not supported!", gModelInputLineCount, 
+			//	StringHelper::GetTokenAt(tokenArray, 0) );
+		}
+		break;
+	}
+}
+
+
+namespace ObjLineTypes
+{
+	enum ObjLineType
 	{
+		kFace,
+		kVertexAttribute,		// "v", "vn" or "vt"
+		kOther
+	};
+}
+
+
+// Returns the first non blank character of the line, and the line type
+static EFW_INLINE const char* GetLineStart(int32_t* outLineType, const char* line)
+{
+	while (*line == ' ' || *line == '\t')
+		line++;
+
+	*outLineType = ObjLineTypes::kOther;
+	if (line[0] == 'f' && (line[1] == ' ' || line[1] == '\t'))
+		*outLineType = ObjLineTypes::kFace;
+	else if (line[0] == 'v' && (line[1] == ' ' || line[1] == '\t' || 
+		((line[1] == 'n' || line[1] == 't') && (line[2] == ' ' || line[2] == '\t'))))
+		*outLineType = ObjLineTypes::kVertexAttribute;
+
+	return line;
+}
+
+
+static int32_t ReadModelSerial(WavefrontObjModelState* state, const char* objFileData, uint64_t objFileDataSize)
+{
+	TokenArray* tokenArray = NULL;
+	StringHelper::CreateTokenArray(&tokenArray, sizeof(Token32), 8);
+
+	uint64_t fileDataIndex = 0;
+	while (fileDataIndex < objFileDataSize && state->streamResult == efwErrs::kOk)
+	{
+		// Faces and vertex attributes are parsed straight from the file data, they are most of the lines and tokenizing them is costly
+		const char* line = &objFileData[fileDataIndex];
+		int32_t lineType;
+		const char* lineStart = GetLineStart(&lineType, line);
+		if (lineType != ObjLineTypes::kOther)
+		{
+			const char* lineEnd = (const char*)memchr(lineStart, '\n', (size_t)(objFileDataSize - (lineStart - objFileData)));
+			if (lineEnd == NULL)
+				lineEnd = objFileData + objFileDataSize;
+			fileDataIndex += (lineEnd - line) + 1;
+			gModelInputLineCount++;
+
+			if (lineType == ObjLineTypes::kFace)
+			{
+				int32_t faceIndices[kMaxVerticesPerFace * kFaceIndicesPerVertex];
+				int32_t faceVertexCount = ParseFaceCorners(faceIndices, lineStart+1, lineEnd);
+				if (faceVertexCount > 0)
+					AddFace(state, faceIndices, faceVertexCount);
+			}
+			else
+			{
+				ParseVertexAttribute(&state->vertexAttributes, lineStart, lineEnd);
+			}
+			continue;
+		}
+
 		const char* kObjFormatDemiliters = " \t";
-		int32_t readedBytes = StringHelper::GetLineTokens(tokenArray, &((char*)objFileData)[fileDataIndex], kObjFormatDemiliters);
+		int32_t readedBytes = StringHelper::GetLineTokens(tokenArray, &objFileData[fileDataIndex], kObjFormatDemiliters);
 		fileDataIndex += readedBytes;
 		gModelInputLineCount++;
 
@@ -521,156 +1011,347 @@ int32_t WavefrontObjReader::ReadModelAndMaterials(UnprocessedTriModel** outModel
 		if (tokenArray->count == 0)
 			continue;
 
-		const char* tokenKey = StringHelper::GetTokenAt(tokenArray, 0);
-		const char* tokenValue = StringHelper::GetTokenAt(tokenArray, 1);
+		ParseModelLine(state, tokenArray);
+	}
 
-		char firstSymbol = tokenKey[0];
-		switch (firstSymbol)
-		{
-			// Vertex attribute
-		case 'v':
-			ParseVertexAttribute(&vertexAttributes, tokenArray);
-			break;
+	StringHelper::DestroyTokenArray(&tokenArray);
+	return efwErrs::kOk;
+}
 
-			// Face (index vertices attributes per face)
-		case 'f':
-			ParseFace(&currentIndexData, &currentVertexIndexToAttributes, &currentVertexAttributesToIndex, vertexAttributes, tokenArray);
-			break;
 
-			// Group (everything from this point until the next group or EOF belongs to this group
-		case 'g':
-			{
-				// Checks whether there are index information from a previous mesh before starting a new group.
-				if (currentIndexData.size() > 0)
-				{
-					DebugPrintFacesInfo(currentVertexIndexToAttributes);
+namespace ObjChunkRecords
+{
+	enum ObjChunkRecord
+	{
+		kFace,						// Followed by the file indices of each corner, the corner count is in the record high bits
+		kVertexAttributeCount,		// Followed by the chunk position, normal and uv counts at this point
+		kLine						// Followed by the line offset in the chunk and the line number in the chunk
+	};
+}
 
-					int32_t meshIndex = meshes.size();
-					meshes.resize(meshes.size() + 1);
-					GenerateMesh(&meshes[meshIndex], currentMeshGuid, lastReferencedMaterialGuid, vertexAttributes, currentVertexIndexToAttributes, currentIndexData);
-					
-					// Reset guids
-					currentMeshGuid.initFromRandomSeed();
-					memset(&lastReferencedMaterialGuid, 0, sizeof(lastReferencedMaterialGuid));
 
-					DebugPrintMeshInfo(meshes[meshIndex]);
-				}
+/**
+ * Part of an OBJ file parsed on its own thread. Vertex attributes are parsed in full, while faces and all other lines are
+ * stored as records in file order, to be resolved against the attributes of the previous chunks in the reconcile pass.
+ */
+struct WavefrontObjChunk
+{
+	const char* data;
+	const char* dataEnd;
 
-				// Clear previous data
-				currentVertexIndexToAttributes.clear();
-				currentVertexAttributesToIndex.clear();
-				currentIndexData.clear();
+	WavefrontObjVertexAttributes vertexAttributes;
+	vector<int32_t> records;
+	int32_t lineCount;
+};
 
-				// Read new mesh name
-				if (tokenArray->count > 1)
-				{
-					const char* meshName = StringHelper::GetTokenAt(tokenArray, 1);
-					currentMeshGuid.initFromName(meshName);
-				}
 
-				// Print vertices up to this point
-				DebugPrintVerticesInfo(vertexAttributes);
-			}
-			break;
+static EFW_INLINE void PushAttributeCountRecord(WavefrontObjChunk* chunk, uint64_t* inOutAttributeCount)
+{
+	const WavefrontObjVertexAttributes& vertexAttributes = chunk->vertexAttributes;
+	uint64_t attributeCount = vertexAttributes.positions.size() + vertexAttributes.normals.size() + vertexAttributes.uvs.size();
+	if (attributeCount == *inOutAttributeCount)
+		return;
 
-			// Material Library (mtlib)
-		case 'm':
-			{
-				if (tokenArray->count > 1 && (strcmp(tokenKey, "mtllib") == 0))
-				{
-					const char* materialFileName = StringHelper::GetTokenAt(tokenArray, 1);
-					char materialFullFilePath[Path::kMaxFullPathLength];
-					PathHelper::Combine(materialFullFilePath, Path::kMaxFullPathLength, currentDirectoryPath, materialFileName);
+	chunk->records.push_back(ObjChunkRecords::kVertexAttributeCount);
+	chunk->records.push_back((int32_t)vertexAttributes.positions.size());
+	chunk->records.push_back((int32_t)vertexAttributes.normals.size());
+	chunk->records.push_back((int32_t)vertexAttributes.uvs.size());
+	*inOutAttributeCount = attributeCount;
+}
 
-					ReadMaterialLib(&materialLib, materialFullFilePath, readFileFunc);
-				}
-				else
-				{
-					//Console::WriteLine("Line %06d: [SKIPPED] \"%s\" is missing a second argument!", gModelInputLineCount, 
-					//	StringHelper::GetTokenAt(tokenArray, 0) );
-				}
+
+static void ParseChunk(void* userData, int32_t chunkIndex)
+{
+	WavefrontObjChunk* chunk = &((WavefrontObjChunk*)userData)[chunkIndex];
+
+	uint64_t attributeCount = 0;
+	const char* line = chunk->data;
+	while (line < chunk->dataEnd)
+	{
+		const char* lineEnd = (const char*)memchr(line, '\n', chunk->dataEnd - line);
+		if (lineEnd == NULL)
+			lineEnd = chunk->dataEnd;
+		chunk->lineCount++;
+
+		int32_t lineType;
+		const char* lineStart = GetLineStart(&lineType, line);
+		if (lineType == ObjLineTypes::kFace)
+		{
+			int32_t faceIndices[kMaxVerticesPerFace * kFaceIndicesPerVertex];
+			int32_t faceVertexCount = ParseFaceCorners(faceIndices, lineStart+1, lineEnd);
+			if (faceVertexCount > 0)
+			{
+				PushAttributeCountRecord(chunk, &attributeCount);
+				chunk->records.push_back(ObjChunkRecords::kFace | (faceVertexCount << 8));
+				chunk->records.insert(chunk->records.end(), faceIndices, faceIndices + faceVertexCount * kFaceIndicesPerVertex);
 			}
-			break;
+		}
+		else if (lineType == ObjLineTypes::kVertexAttribute)
+		{
+			// Vertex attributes don't depend on anything read before them
+			ParseVertexAttribute(&chunk->vertexAttributes, lineStart, lineEnd);
+		}
+		else if (lineStart < lineEnd && lineStart[0] != '#' && lineStart[0] != '\r')
+		{
+			PushAttributeCountRecord(chunk, &attributeCount);
+			chunk->records.push_back(ObjChunkRecords::kLine);
+			chunk->records.push_back((int32_t)(line - chunk->data));
+			chunk->records.push_back(chunk->lineCount);
+		}
 
-			// Material (usemtl)
-		case 'u':
+		line = lineEnd + 1;
+	}
+}
+
+
+static void AppendVertexAttributes(WavefrontObjVertexAttributes* outVertexAttributes, const WavefrontObjVertexAttributes& vertexAttributes, 
+	size_t* inOutAppendedCounts, const int32_t* counts)
+{
+	outVertexAttributes->positions.insert(outVertexAttributes->positions.end(), 
+		vertexAttributes.positions.begin() + inOutAppendedCounts[0], vertexAttributes.positions.begin() + counts[0]);
+	outVertexAttributes->normals.insert(outVertexAttributes->normals.end(), 
+		vertexAttributes.normals.begin() + inOutAppendedCounts[1], vertexAttributes.normals.begin() + counts[1]);
+	outVertexAttributes->uvs.insert(outVertexAttributes->uvs.end(), 
+		vertexAttributes.uvs.begin() + inOutAppendedCounts[2], vertexAttributes.uvs.begin() + counts[2]);
+
+	inOutAppendedCounts[0] = counts[0];
+	inOutAppendedCounts[1] = counts[1];
+	inOutAppendedCounts[2] = counts[2];
+}
+
+
+/**
+ * Splits the file in chunks at line boundaries and parses them in parallel, then replays the chunk records in file order.
+ * Attributes of each chunk are appended as the records reach them, so faces see exactly the attributes the serial reader
+ * would, and relative indices, bounds checks and group boundaries resolve the same way.
+ */
+static int32_t ReadModelParallel(WavefrontObjModelState* state, const char* objFileData, uint64_t objFileDataSize, int32_t threadCount)
+{
+	// Record offsets are 32b, and more chunks than threads balances uneven chunks
+	const uint64_t kMaxChunkSize = 256 * 1024 * 1024;
+	const int32_t kChunksPerThread = 4;
+	uint64_t chunkCount64 = Math::Max((uint64_t)threadCount * kChunksPerThread, (objFileDataSize + kMaxChunkSize - 1) / kMaxChunkSize);
+	const int32_t chunkCount = (int32_t)chunkCount64;
+
+	vector<WavefrontObjChunk> chunks(chunkCount);
+	const char* chunkStart = objFileData;
+	const char* objFileDataEnd = objFileData + objFileDataSize;
+	for (int32_t i=0; i<chunkCount; ++i)
+	{
+		const char* chunkEnd = objFileDataEnd;
+		if (i < chunkCount-1)
+		{
+			const char* splitPoint = objFileData + (objFileDataSize * (i+1)) / chunkCount;
+			if (splitPoint < chunkStart)
+				splitPoint = chunkStart;
+			chunkEnd = (const char*)memchr(splitPoint, '\n', objFileDataEnd - splitPoint);
+			chunkEnd = (chunkEnd != NULL)? chunkEnd + 1 : objFileDataEnd;
+		}
+
+		chunks[i].data = chunkStart;
+		chunks[i].dataEnd = chunkEnd;
+		chunks[i].lineCount = 0;
+		chunkStart = chunkEnd;
+	}
+
+	Thread::ParallelFor(chunkCount, ParseChunk, &chunks[0], threadCount);
+
+	// Reconcile
+	TokenArray* tokenArray = NULL;
+	StringHelper::CreateTokenArray(&tokenArray, sizeof(Token32), 8);
+
+	int32_t chunkLineStart = 0;
+	for (int32_t i=0; i<chunkCount; ++i)
+	{
+		WavefrontObjChunk& chunk = chunks[i];
+		size_t appendedCounts[3] = { 0, 0, 0 };
+
+		const int32_t* records = (chunk.records.size() > 0)? &chunk.records[0] : NULL;
+		const size_t recordCount = chunk.records.size();
+		size_t recordIndex = 0;
+		while (recordIndex < recordCount)
+		{
+			const int32_t record = records[recordIndex++];
+			switch (record & 0xFF)
 			{
-				if (materialLib != NULL &&
-					tokenArray->count > 1 && (strcmp(tokenKey, "usemtl") == 0))
+			case ObjChunkRecords::kVertexAttributeCount:
+				AppendVertexAttributes(&state->vertexAttributes, chunk.vertexAttributes, appendedCounts, &records[recordIndex]);
+				recordIndex += 3;
+				break;
+
+			case ObjChunkRecords::kFace:
 				{
-					lastReferencedMaterialGuid.initFromName(tokenValue);
-
-					int32_t i=0;
-					bool materialFound = false;
-					while (i<materialLib->materialCount && !materialFound)
-					{
-						if (lastReferencedMaterialGuid == materialLib->materials[i].guid)
-							materialFound = true;
-
-						i++;
-					}
-
-					if (!materialFound)
-					{
-						Console::WriteLine("Line %06d: [SKIPPED] \"%s\" material was not found!", gModelInputLineCount, tokenValue);
-					}
+					int32_t faceVertexCount = record >> 8;
+					AddFace(state, &records[recordIndex], faceVertexCount);
+					recordIndex += faceVertexCount * kFaceIndicesPerVertex;
 				}
-				else
+				break;
+
+			case ObjChunkRecords::kLine:
 				{
-					// TODO There was no material lib or the material name was invalid
+					gModelInputLineCount = chunkLineStart + records[recordIndex+1];
+					StringHelper::GetLineTokens(tokenArray, chunk.data + records[recordIndex], " \t");
+					if (tokenArray->count > 0)
+						ParseModelLine(state, tokenArray);
+					recordIndex += 2;
 				}
+				break;
 			}
-			break;
+		}
 
-			// Comments - IGNORED
-		case '#':
-			break;
+		int32_t chunkCounts[] = { (int32_t)chunk.vertexAttributes.positions.size(), (int32_t)chunk.vertexAttributes.normals.size(), 
+			(int32_t)chunk.vertexAttributes.uvs.size() };
+		AppendVertexAttributes(&state->vertexAttributes, chunk.vertexAttributes, appendedCounts, chunkCounts);
+		chunkLineStart += chunk.lineCount;
 
-			// Unhandled symbold
-		default:
-			{
-				//Console::WriteLine("Line %06d: [SKIPPED] \"%s\" is not supported!", gModelInputLineCount, 
-				//	StringHelper::GetTokenAt(tokenArray, 0) );
-			}
-			break;
-		}
+		// Release the chunk as soon as it's merged
+		vector<WavefrontObjVertexAttribute>().swap(chunk.vertexAttributes.positions);
+		vector<WavefrontObjVertexAttribute>().swap(chunk.vertexAttributes.normals);
+		vector<WavefrontObjVertexAttribute>().swap(chunk.vertexAttributes.uvs);
+		vector<int32_t>().swap(chunk.records);
 	}
+	gModelInputLineCount = chunkLineStart;
 
-	DebugPrintVerticesInfo(vertexAttributes);
-	DebugPrintFacesInfo(currentVertexIndexToAttributes);
+	StringHelper::DestroyTokenArray(&tokenArray);
+	return efwErrs::kOk;
+}
+
+
+int32_t WavefrontObjReader::ReadModelAndMaterials(UnprocessedTriModel** outModel, UnprocessedMaterialLib** outMaterialLib, const char* fullFilePath, ReadFileFunc_t readFileFunc, 
+	int32_t parseThreadCount)
+{
+	if (fullFilePath == NULL || outModel == NULL || outMaterialLib == NULL)
+		return efwErrs::kInvalidInput;
+
+	// Get file directory
+	char currentDirectoryPath[Path::kMaxDirectoryLength];
+	PathHelper::GetDirectory(currentDirectoryPath, Path::kMaxDirectoryLength, fullFilePath);
+
+	// Read OBJ file data
+	const int32_t kRequiredAlignment = 1024;
+	MappedFile objFile;
+	OpenFileData(&objFile, fullFilePath, readFileFunc, kRequiredAlignment);
+	const char* objFileData = (const char*)objFile.data;
+	uint64_t objFileDataSize = objFile.size;
+
+	WavefrontObjModelState state;
+	InitializeModelState(&state, currentDirectoryPath, readFileFunc);
+
+	// Reset global line counter
+	gModelInputLineCount = 0;
+
+	if (parseThreadCount <= 0)
+		parseThreadCount = Thread::GetHardwareThreadCount();
+
+	if (parseThreadCount > 1 && objFileDataSize >= kMinParallelFileSize)
+		ReadModelParallel(&state, objFileData, objFileDataSize, parseThreadCount);
+	else
+		ReadModelSerial(&state, objFileData, objFileDataSize);
+
+	DebugPrintVerticesInfo(state.vertexAttributes);
 
 	// 
-	if (currentIndexData.size() > 0)
-	{
-		int32_t meshIndex = meshes.size();
-		meshes.resize(meshes.size()+1);
-		GenerateMesh(&meshes[meshIndex], currentMeshGuid, lastReferencedMaterialGuid, vertexAttributes, currentVertexIndexToAttributes, currentIndexData);
-		
-		DebugPrintMeshInfo(meshes[meshIndex]);
-	}
+	FinishMesh(&state);
 
-	StringHelper::DestroyTokenArray(&tokenArray);
-	EFW_SAFE_ALIGNED_FREE(objFileData);
+	FileReader::Unmap(&objFile);
 
 	// Flatten all meshes
 	UnprocessedTriModel* model = NULL;
-	const int32_t meshCount = meshes.size();
+	const int32_t meshCount = state.meshes.size();
 	if (meshCount > 0)
 	{
-		int32_t modelMemory = meshes.size() * sizeof(UnprocessedTriMesh) + sizeof(UnprocessedTriModel);
+		int32_t modelMemory = state.meshes.size() * sizeof(UnprocessedTriMesh) + sizeof(UnprocessedTriModel);
 
 		model = (UnprocessedTriModel*)memalign(128, modelMemory);
 		model->meshCount = meshCount;
-		memcpy(&model->meshes[0], &meshes[0], meshCount * sizeof(UnprocessedTriMesh));
+		memcpy(&model->meshes[0], &state.meshes[0], meshCount * sizeof(UnprocessedTriMesh));
 	}
 
 	// Copy out
 	*outModel = model;
-	*outMaterialLib = materialLib;
+	*outMaterialLib = state.materialLib;
 
 	return efwErrs::kOk;
 }
 
+int32_t WavefrontObjReader::ReadModelStream(UnprocessedMaterialLib** outMaterialLib, const char* fullFilePath, ReadFileFunc_t readFileFunc, 
+	ReadMeshCallback_t meshCallback, void* userData, int32_t streamFlags, uint32_t* outSkippedFaceCount)
+{
+	if (fullFilePath == NULL || outMaterialLib == NULL || meshCallback == NULL)
+		return efwErrs::kInvalidInput;
+
+	FILE* file = fopen(fullFilePath, "rb");
+	if (file == NULL)
+		return efwErrs::kInvalidInput;
+
+	// Get file directory
+	char currentDirectoryPath[Path::kMaxDirectoryLength];
+	PathHelper::GetDirectory(currentDirectoryPath, Path::kMaxDirectoryLength, fullFilePath);
+
+	WavefrontObjModelState state;
+	InitializeModelState(&state, currentDirectoryPath, readFileFunc);
+	state.meshCallback = meshCallback;
+	state.meshCallbackUserData = userData;
+	state.streamFlags = streamFlags;
+
+	// Reset global line counter
+	gModelInputLineCount = 0;
+
+	// The window is always followed by zeroed padding, so the last line of the file is '\0' terminated as in a mapped file
+	size_t windowCapacity = kStreamWindowSize;
+	char* window = (char*)memalign(16, windowCapacity + FileReader::kMappedFilePadding);
+	size_t windowDataSize = 0;
+	bool isEndOfFile = false;
+
+	while (!isEndOfFile && state.streamResult == efwErrs::kOk)
+	{
+		windowDataSize += fread(&window[windowDataSize], 1, windowCapacity - windowDataSize, file);
+		isEndOfFile = (windowDataSize < windowCapacity);
+		memset(&window[windowDataSize], 0, FileReader::kMappedFilePadding);
+
+		// Only whole lines are parsed, the partial line at the end is moved to the start of the window
+		size_t parseSize = windowDataSize;
+		if (!isEndOfFile)
+		{
+			const char* lastLineBreak = NULL;
+			for (const char* current = &window[windowDataSize]; current > window && lastLineBreak == NULL; --current)
+			{
+				if (current[-1] == '\n')
+					lastLineBreak = current - 1;
+			}
+
+			// A single line filled the window
+			if (lastLineBreak == NULL)
+			{
+				char* newWindow = (char*)memalign(16, windowCapacity * 2 + FileReader::kMappedFilePadding);
+				memcpy(newWindow, window, windowDataSize);
+				freealign(window);
+				window = newWindow;
+				windowCapacity *= 2;
+				continue;
+			}
+			parseSize = (lastLineBreak - window) + 1;
+		}
+
+		ReadModelSerial(&state, window, parseSize);
+
+		memmove(window, &window[parseSize], windowDataSize - parseSize);
+		windowDataSize -= parseSize;
+	}
+
+	freealign(window);
+	fclose(file);
+
+	if (state.streamResult == efwErrs::kOk)
+		FinishMesh(&state);
+
+	*outMaterialLib = state.materialLib;
+	if (outSkippedFaceCount != NULL)
+		*outSkippedFaceCount = state.skippedFaceCount;
+
+	return state.streamResult;
+}
+
 /*
 int32_t WavefrontObjReader::ReadModelFromStream(UnprocessedTriModel** outModel, const void* objFileData, uint32_t objFileDataSize)
 {
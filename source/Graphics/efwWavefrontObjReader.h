@@ -14,6 +14,7 @@
 #pragma once
 
 #include "Foundation/efwPlatform.h"
+#include "Foundation/efwFileReader.h"
 #include "Graphics/efwUnprocessedTriMesh.h"
 #include "Graphics/efwUnprocessedMaterial.h"
 
@@ -23,12 +24,57 @@ namespace Graphics
 {
 	namespace WavefrontObjReader
 	{
-		// Read file function declaration
-		typedef int32_t (*ReadFileFunc_t)(void** outData, uint64_t* outSize, const char* filename, int32_t requiredAlignment);
+		// Read file function declaration. When NULL is given, files are memory mapped and parsed in place.
+		typedef FileReader::ReadFileFunc_t ReadFileFunc_t;
+
+		// Bumped whenever the reader output changes, invalidating cached models
+		const uint32_t kVersion = 1;
+
+		// Files smaller than this are always parsed on the calling thread
+		const uint64_t kMinParallelFileSize = 4 * 1024 * 1024;
+
+		// Size of the file window read at a time by ReadModelStream. Windows grow when a single line doesn't fit.
+		const uint32_t kStreamWindowSize = 16 * 1024 * 1024;
+
+		/**
+		 * Called by ReadModelStream for each mesh, as soon as its group closes.
+		 * The callback owns the mesh data and frees it with Release. Returning anything but kOk stops the read.
+		 */
+		typedef int32_t (*ReadMeshCallback_t)(UnprocessedTriMesh* mesh, const UnprocessedMaterialLib* materialLib, void* userData);
+
+		namespace StreamFlags
+		{
+			const int32_t kNone = 0;
+			const int32_t kDropGroupVertexAttributes = 1 << 0;	// Drop the vertex attributes of each group once it closes, see ReadModelStream
+		}
 
 		void Release(UnprocessedTriModel* model);
+		void Release(UnprocessedTriMesh* mesh);
 		void Release(UnprocessedMaterialLib* material);
-		int32_t ReadModelAndMaterials(UnprocessedTriModel** outModel, UnprocessedMaterialLib** outMaterialLib, const char* fullFilePath, ReadFileFunc_t customReadFileFunction);
+
+		/**
+		 * Reads an OBJ model and its material libs.
+		 * 
+		 * @param parseThreadCount Number of threads parsing the file, or 0 to use one per hardware thread. Extra threads 
+		 * come from the WorkerPool, which must be initialized. 
+		 * Parsing in parallel gives the same model as parsing serially.
+		 */
+		int32_t ReadModelAndMaterials(UnprocessedTriModel** outModel, UnprocessedMaterialLib** outMaterialLib, const char* fullFilePath, ReadFileFunc_t customReadFileFunction, 
+			int32_t parseThreadCount = 1);
+
+		/**
+		 * Reads an OBJ model one window at a time, handing each mesh to the callback instead of building a model.
+		 * Every vertex attribute is kept by default, as faces may reference attributes of any previous group. 
+		 * With kDropGroupVertexAttributes, the vertex attributes of a group are dropped once it closes, so memory tracks 
+		 * the largest group rather than the file. Attributes written after the last face of a group are kept for the next one.
+		 * Only use it for files writing the attributes of each group right before its faces. A face referencing dropped 
+		 * attributes stops the read with efwErrs::kCorruptedData, after the meshes of the previous groups were handed out.
+		 * 
+		 * @param readFileFunc Used for the material libs only.
+		 * @param outSkippedFaceCount Optional, number of faces skipped for indexing attributes that were never written.
+		 */
+		int32_t ReadModelStream(UnprocessedMaterialLib** outMaterialLib, const char* fullFilePath, ReadFileFunc_t readFileFunc, 
+			ReadMeshCallback_t meshCallback, void* userData, int32_t streamFlags = StreamFlags::kNone, uint32_t* outSkippedFaceCount = NULL);
 		int32_t ReadMaterialLib(UnprocessedMaterialLib** outMaterial, const char* fullFilePath, ReadFileFunc_t readFileFunc);
 
 		// Deprecated
@@ -0,0 +1,589 @@
+#include "Math/efwBatchMath.h"
+#include "Foundation/efwCpuFeatures.h"
+
+#if defined(EFW_X86)
+#include <immintrin.h>
+#endif
+
+using namespace efw;
+using namespace efw::Math;
+
+static EFW_INLINE int32_t GetPaddedCount(int32_t count)
+{
+	return EFW_ALIGN(BatchMath::kLaneCount, count);
+}
+
+
+int32_t efw::Math::Vec3StreamCreate(Vec3Stream* outStream, int32_t capacity)
+{
+	if (outStream == NULL || capacity < 0)
+		return efwErrs::kInvalidInput;
+
+	// Components share one allocation
+	const int32_t paddedCapacity = Math::Max(GetPaddedCount(capacity), BatchMath::kLaneCount);
+	float* data = (float*)memalign(32, 3 * paddedCapacity * sizeof(float));
+	if (data == NULL)
+		return efwErrs::kOperationFailed;
+
+	outStream->x = data;
+	outStream->y = data + paddedCapacity;
+	outStream->z = data + 2 * paddedCapacity;
+	outStream->count = 0;
+	outStream->capacity = paddedCapacity;
+	return efwErrs::kOk;
+}
+
+
+void efw::Math::Vec3StreamRelease(Vec3Stream* stream)
+{
+	if (stream == NULL)
+		return;
+
+	EFW_SAFE_ALIGNED_FREE(stream->x);
+	memset(stream, 0, sizeof(Vec3Stream));
+}
+
+
+#if defined(EFW_X86)
+EFW_TARGET_ISA("sse4.1")
+static int32_t GatherSSE41(float* x, float* y, float* z, const float* in, int32_t inStride, int32_t count)
+{
+	int32_t i = 0;
+	for (; i+4<=count; i+=4)
+	{
+		// Exactly three floats are read per element, then the 4x3 block is transposed
+		const float* in0 = in;
+		const float* in1 = (const float*)( (const uint8_t*)in0 + inStride );
+		const float* in2 = (const float*)( (const uint8_t*)in1 + inStride );
+		const float* in3 = (const float*)( (const uint8_t*)in2 + inStride );
+		__m128 row0 = _mm_movelh_ps( _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)in0)), _mm_load_ss(&in0[2]) );
+		__m128 row1 = _mm_movelh_ps( _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)in1)), _mm_load_ss(&in1[2]) );
+		__m128 row2 = _mm_movelh_ps( _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)in2)), _mm_load_ss(&in2[2]) );
+		__m128 row3 = _mm_movelh_ps( _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)in3)), _mm_load_ss(&in3[2]) );
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+		_mm_store_ps(&x[i], row0);
+		_mm_store_ps(&y[i], row1);
+		_mm_store_ps(&z[i], row2);
+		in = (const float*)( (const uint8_t*)in3 + inStride );
+	}
+	return i;
+}
+
+
+EFW_TARGET_ISA("sse4.1")
+static int32_t ScatterSSE41(float* out, int32_t outStride, const float* x, const float* y, const float* z, int32_t count)
+{
+	int32_t i = 0;
+	for (; i+4<=count; i+=4)
+	{
+		__m128 row0 = _mm_load_ps(&x[i]);
+		__m128 row1 = _mm_load_ps(&y[i]);
+		__m128 row2 = _mm_load_ps(&z[i]);
+		__m128 row3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+		const __m128 rows[] = {row0, row1, row2, row3};
+		for (int32_t j=0; j<4; ++j)
+		{
+			_mm_storel_pi((__m64*)out, rows[j]);
+			_mm_store_ss(&out[2], _mm_movehl_ps(rows[j], rows[j]));
+			out = (float*)( (uint8_t*)out + outStride );
+		}
+	}
+	return i;
+}
+#endif
+
+
+void efw::Math::Vec3StreamGather(Vec3Stream* outStream, const float* in, int32_t inStride, int32_t count)
+{
+	EFW_MATH_ASSERT(outStream != NULL && count <= outStream->capacity);
+	EFW_MATH_ASSERT(in != NULL || count == 0);
+
+	float* x = outStream->x;
+	float* y = outStream->y;
+	float* z = outStream->z;
+	int32_t i = 0;
+
+#if defined(EFW_X86)
+	if (Cpu::GetSimdTier() >= SimdTiers::kSSE41)
+	{
+		i = GatherSSE41(x, y, z, in, inStride, count);
+		in = (const float*)( (const uint8_t*)in + (intptr_t)i * inStride );
+	}
+#endif
+
+	for (; i<count; ++i)
+	{
+		x[i] = in[0];
+		y[i] = in[1];
+		z[i] = in[2];
+		in = (const float*)( (const uint8_t*)in + inStride );
+	}
+
+	// Padding repeats the last element
+	const int32_t paddedCount = GetPaddedCount(count);
+	for (; i<paddedCount; ++i)
+	{
+		x[i] = x[count-1];
+		y[i] = y[count-1];
+		z[i] = z[count-1];
+	}
+	outStream->count = count;
+}
+
+
+void efw::Math::Vec3StreamScatter(float* out, int32_t outStride, const Vec3Stream& stream)
+{
+	EFW_MATH_ASSERT(out != NULL || stream.count == 0);
+
+	const int32_t count = stream.count;
+	int32_t i = 0;
+
+#if defined(EFW_X86)
+	if (Cpu::GetSimdTier() >= SimdTiers::kSSE41)
+	{
+		i = ScatterSSE41(out, outStride, stream.x, stream.y, stream.z, count);
+		out = (float*)( (uint8_t*)out + (intptr_t)i * outStride );
+	}
+#endif
+
+	for (; i<count; ++i)
+	{
+		out[0] = stream.x[i];
+		out[1] = stream.y[i];
+		out[2] = stream.z[i];
+		out = (float*)( (uint8_t*)out + outStride );
+	}
+}
+
+
+#if defined(EFW_X86)
+// Padding repeats the last element, so the min/max kernels run over whole lanes
+EFW_TARGET_ISA("sse4.1")
+static void MinMaxSSE41(float outMin[4], float outMax[4], const Vec3Stream& stream)
+{
+	const int32_t paddedCount = GetPaddedCount(stream.count);
+	__m128 minX = _mm_load_ps(stream.x), maxX = minX;
+	__m128 minY = _mm_load_ps(stream.y), maxY = minY;
+	__m128 minZ = _mm_load_ps(stream.z), maxZ = minZ;
+	for (int32_t i=4; i<paddedCount; i+=4)
+	{
+		__m128 x = _mm_load_ps(&stream.x[i]);
+		__m128 y = _mm_load_ps(&stream.y[i]);
+		__m128 z = _mm_load_ps(&stream.z[i]);
+		minX = _mm_min_ps(minX, x);
+		maxX = _mm_max_ps(maxX, x);
+		minY = _mm_min_ps(minY, y);
+		maxY = _mm_max_ps(maxY, y);
+		minZ = _mm_min_ps(minZ, z);
+		maxZ = _mm_max_ps(maxZ, z);
+	}
+
+	// Transposing gives the per component lane results in each row
+	__m128 zero = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(minX, minY, minZ, zero);
+	_mm_storeu_ps(outMin, _mm_min_ps(_mm_min_ps(minX, minY), _mm_min_ps(minZ, zero)));
+	zero = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(maxX, maxY, maxZ, zero);
+	_mm_storeu_ps(outMax, _mm_max_ps(_mm_max_ps(maxX, maxY), _mm_max_ps(maxZ, zero)));
+}
+
+
+EFW_TARGET_ISA("avx2")
+static void MinMaxAVX2(float outMin[4], float outMax[4], const Vec3Stream& stream)
+{
+	const int32_t paddedCount = GetPaddedCount(stream.count);
+	__m256 minX = _mm256_load_ps(stream.x), maxX = minX;
+	__m256 minY = _mm256_load_ps(stream.y), maxY = minY;
+	__m256 minZ = _mm256_load_ps(stream.z), maxZ = minZ;
+	for (int32_t i=8; i<paddedCount; i+=8)
+	{
+		__m256 x = _mm256_load_ps(&stream.x[i]);
+		__m256 y = _mm256_load_ps(&stream.y[i]);
+		__m256 z = _mm256_load_ps(&stream.z[i]);
+		minX = _mm256_min_ps(minX, x);
+		maxX = _mm256_max_ps(maxX, x);
+		minY = _mm256_min_ps(minY, y);
+		maxY = _mm256_max_ps(maxY, y);
+		minZ = _mm256_min_ps(minZ, z);
+		maxZ = _mm256_max_ps(maxZ, z);
+	}
+
+	__m128 minX4 = _mm_min_ps(_mm256_castps256_ps128(minX), _mm256_extractf128_ps(minX, 1));
+	__m128 minY4 = _mm_min_ps(_mm256_castps256_ps128(minY), _mm256_extractf128_ps(minY, 1));
+	__m128 minZ4 = _mm_min_ps(_mm256_castps256_ps128(minZ), _mm256_extractf128_ps(minZ, 1));
+	__m128 maxX4 = _mm_max_ps(_mm256_castps256_ps128(maxX), _mm256_extractf128_ps(maxX, 1));
+	__m128 maxY4 = _mm_max_ps(_mm256_castps256_ps128(maxY), _mm256_extractf128_ps(maxY, 1));
+	__m128 maxZ4 = _mm_max_ps(_mm256_castps256_ps128(maxZ), _mm256_extractf128_ps(maxZ, 1));
+
+	__m128 zero = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(minX4, minY4, minZ4, zero);
+	_mm_storeu_ps(outMin, _mm_min_ps(_mm_min_ps(minX4, minY4), _mm_min_ps(minZ4, zero)));
+	zero = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(maxX4, maxY4, maxZ4, zero);
+	_mm_storeu_ps(outMax, _mm_max_ps(_mm_max_ps(maxX4, maxY4), _mm_max_ps(maxZ4, zero)));
+}
+#endif
+
+
+void efw::Math::Vec3StreamMinMax(Vec3f* outMin, Vec3f* outMax, const Vec3Stream& stream)
+{
+	EFW_MATH_ASSERT(outMin != NULL && outMax != NULL);
+	if (stream.count == 0)
+	{
+		*outMin = Vec3f::kZero;
+		*outMax = Vec3f::kZero;
+		return;
+	}
+
+	float minValue[4] = {stream.x[0], stream.y[0], stream.z[0], 0.0f};
+	float maxValue[4] = {stream.x[0], stream.y[0], stream.z[0], 0.0f};
+
+#if defined(EFW_X86)
+	const int32_t simdTier = Cpu::GetSimdTier();
+	if (simdTier >= SimdTiers::kAVX2)
+		MinMaxAVX2(minValue, maxValue, stream);
+	else if (simdTier >= SimdTiers::kSSE41)
+		MinMaxSSE41(minValue, maxValue, stream);
+	else
+#endif
+	{
+		for (int32_t i=1; i<stream.count; ++i)
+		{
+			minValue[0] = Math::Min(minValue[0], stream.x[i]);
+			minValue[1] = Math::Min(minValue[1], stream.y[i]);
+			minValue[2] = Math::Min(minValue[2], stream.z[i]);
+			maxValue[0] = Math::Max(maxValue[0], stream.x[i]);
+			maxValue[1] = Math::Max(maxValue[1], stream.y[i]);
+			maxValue[2] = Math::Max(maxValue[2], stream.z[i]);
+		}
+	}
+
+	*outMin = Vec3f(minValue[0], minValue[1], minValue[2]);
+	*outMax = Vec3f(maxValue[0], maxValue[1], maxValue[2]);
+}
+
+
+#if defined(EFW_X86)
+// Kernels don't use FMA, so every tier returns the same results
+EFW_TARGET_ISA("sse4.1")
+static int32_t DotSSE41(float* out, const Vec3Stream& stream1, const Vec3Stream& stream2, bool computeLength)
+{
+	int32_t i = 0;
+	for (; i+4<=stream1.count; i+=4)
+	{
+		__m128 result = _mm_mul_ps(_mm_load_ps(&stream1.x[i]), _mm_load_ps(&stream2.x[i]));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(&stream1.y[i]), _mm_load_ps(&stream2.y[i])));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(&stream1.z[i]), _mm_load_ps(&stream2.z[i])));
+		_mm_storeu_ps(&out[i], (computeLength)? _mm_sqrt_ps(result) : result);
+	}
+	return i;
+}
+
+
+EFW_TARGET_ISA("avx2")
+static int32_t DotAVX2(float* out, const Vec3Stream& stream1, const Vec3Stream& stream2, bool computeLength)
+{
+	int32_t i = 0;
+	for (; i+8<=stream1.count; i+=8)
+	{
+		__m256 result = _mm256_mul_ps(_mm256_load_ps(&stream1.x[i]), _mm256_load_ps(&stream2.x[i]));
+		result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_load_ps(&stream1.y[i]), _mm256_load_ps(&stream2.y[i])));
+		result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_load_ps(&stream1.z[i]), _mm256_load_ps(&stream2.z[i])));
+		_mm256_storeu_ps(&out[i], (computeLength)? _mm256_sqrt_ps(result) : result);
+	}
+	return i;
+}
+#endif
+
+
+static void Dot(float* out, const Vec3Stream& stream1, const Vec3Stream& stream2, bool computeLength)
+{
+	EFW_MATH_ASSERT(out != NULL && stream1.count == stream2.count);
+
+	int32_t i = 0;
+#if defined(EFW_X86)
+	const int32_t simdTier = Cpu::GetSimdTier();
+	if (simdTier >= SimdTiers::kAVX2)
+		i = DotAVX2(out, stream1, stream2, computeLength);
+	if (simdTier >= SimdTiers::kSSE41)
+	{
+		// Also finishes the last 4 elements of the AVX2 kernel
+		const int32_t remainingCount = stream1.count - i;
+		Vec3Stream remaining1 = { &stream1.x[i], &stream1.y[i], &stream1.z[i], remainingCount, 0 };
+		Vec3Stream remaining2 = { &stream2.x[i], &stream2.y[i], &stream2.z[i], remainingCount, 0 };
+		i += DotSSE41(&out[i], remaining1, remaining2, computeLength);
+	}
+#endif
+
+	for (; i<stream1.count; ++i)
+	{
+		const float result = stream1.x[i] * stream2.x[i] + stream1.y[i] * stream2.y[i] + stream1.z[i] * stream2.z[i];
+		out[i] = (computeLength)? Math::Sqrt(result) : result;
+	}
+}
+
+
+void efw::Math::Vec3StreamDot(float* out, const Vec3Stream& stream1, const Vec3Stream& stream2)
+{
+	Dot(out, stream1, stream2, false);
+}
+
+
+void efw::Math::Vec3StreamLength(float* out, const Vec3Stream& stream)
+{
+	Dot(out, stream, stream, true);
+}
+
+
+#if defined(EFW_X86)
+EFW_TARGET_ISA("sse4.1")
+static void CrossSSE41(Vec3Stream* outStream, const Vec3Stream& stream1, const Vec3Stream& stream2, int32_t paddedCount)
+{
+	for (int32_t i=0; i<paddedCount; i+=4)
+	{
+		const __m128 x1 = _mm_load_ps(&stream1.x[i]), y1 = _mm_load_ps(&stream1.y[i]), z1 = _mm_load_ps(&stream1.z[i]);
+		const __m128 x2 = _mm_load_ps(&stream2.x[i]), y2 = _mm_load_ps(&stream2.y[i]), z2 = _mm_load_ps(&stream2.z[i]);
+		_mm_store_ps(&outStream->x[i], _mm_sub_ps(_mm_mul_ps(y1, z2), _mm_mul_ps(z1, y2)));
+		_mm_store_ps(&outStream->y[i], _mm_sub_ps(_mm_mul_ps(z1, x2), _mm_mul_ps(x1, z2)));
+		_mm_store_ps(&outStream->z[i], _mm_sub_ps(_mm_mul_ps(x1, y2), _mm_mul_ps(y1, x2)));
+	}
+}
+
+
+EFW_TARGET_ISA("avx2")
+static void CrossAVX2(Vec3Stream* outStream, const Vec3Stream& stream1, const Vec3Stream& stream2, int32_t paddedCount)
+{
+	for (int32_t i=0; i<paddedCount; i+=8)
+	{
+		const __m256 x1 = _mm256_load_ps(&stream1.x[i]), y1 = _mm256_load_ps(&stream1.y[i]), z1 = _mm256_load_ps(&stream1.z[i]);
+		const __m256 x2 = _mm256_load_ps(&stream2.x[i]), y2 = _mm256_load_ps(&stream2.y[i]), z2 = _mm256_load_ps(&stream2.z[i]);
+		_mm256_store_ps(&outStream->x[i], _mm256_sub_ps(_mm256_mul_ps(y1, z2), _mm256_mul_ps(z1, y2)));
+		_mm256_store_ps(&outStream->y[i], _mm256_sub_ps(_mm256_mul_ps(z1, x2), _mm256_mul_ps(x1, z2)));
+		_mm256_store_ps(&outStream->z[i], _mm256_sub_ps(_mm256_mul_ps(x1, y2), _mm256_mul_ps(y1, x2)));
+	}
+}
+#endif
+
+
+void efw::Math::Vec3StreamCross(Vec3Stream* outStream, const Vec3Stream& stream1, const Vec3Stream& stream2)
+{
+	EFW_MATH_ASSERT(outStream != NULL && stream1.count == stream2.count && stream1.count <= outStream->capacity);
+
+	// Padding is computed too, so it keeps repeating the last element
+	const int32_t paddedCount = GetPaddedCount(stream1.count);
+
+#if defined(EFW_X86)
+	const int32_t simdTier = Cpu::GetSimdTier();
+	if (simdTier >= SimdTiers::kAVX2)
+		CrossAVX2(outStream, stream1, stream2, paddedCount);
+	else if (simdTier >= SimdTiers::kSSE41)
+		CrossSSE41(outStream, stream1, stream2, paddedCount);
+	else
+#endif
+	{
+		for (int32_t i=0; i<paddedCount; ++i)
+		{
+			const float x1 = stream1.x[i], y1 = stream1.y[i], z1 = stream1.z[i];
+			const float x2 = stream2.x[i], y2 = stream2.y[i], z2 = stream2.z[i];
+			outStream->x[i] = y1 * z2 - z1 * y2;
+			outStream->y[i] = z1 * x2 - x1 * z2;
+			outStream->z[i] = x1 * y2 - y1 * x2;
+		}
+	}
+	outStream->count = stream1.count;
+}
+
+
+#if defined(EFW_X86)
+EFW_TARGET_ISA("sse4.1")
+static void NormalizeSSE41(Vec3Stream* outStream, const Vec3Stream& stream, int32_t paddedCount)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	for (int32_t i=0; i<paddedCount; i+=4)
+	{
+		const __m128 x = _mm_load_ps(&stream.x[i]), y = _mm_load_ps(&stream.y[i]), z = _mm_load_ps(&stream.z[i]);
+		__m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		__m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+		invLength = _mm_blendv_ps(one, invLength, _mm_cmpgt_ps(lengthSquared, _mm_setzero_ps()));
+
+		_mm_store_ps(&outStream->x[i], _mm_mul_ps(x, invLength));
+		_mm_store_ps(&outStream->y[i], _mm_mul_ps(y, invLength));
+		_mm_store_ps(&outStream->z[i], _mm_mul_ps(z, invLength));
+	}
+}
+
+
+EFW_TARGET_ISA("avx2")
+static void NormalizeAVX2(Vec3Stream* outStream, const Vec3Stream& stream, int32_t paddedCount)
+{
+	const __m256 one = _mm256_set1_ps(1.0f);
+	for (int32_t i=0; i<paddedCount; i+=8)
+	{
+		const __m256 x = _mm256_load_ps(&stream.x[i]), y = _mm256_load_ps(&stream.y[i]), z = _mm256_load_ps(&stream.z[i]);
+		__m256 lengthSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+		__m256 invLength = _mm256_div_ps(one, _mm256_sqrt_ps(lengthSquared));
+		invLength = _mm256_blendv_ps(one, invLength, _mm256_cmp_ps(lengthSquared, _mm256_setzero_ps(), _CMP_GT_OQ));
+
+		_mm256_store_ps(&outStream->x[i], _mm256_mul_ps(x, invLength));
+		_mm256_store_ps(&outStream->y[i], _mm256_mul_ps(y, invLength));
+		_mm256_store_ps(&outStream->z[i], _mm256_mul_ps(z, invLength));
+	}
+}
+#endif
+
+
+void efw::Math::Vec3StreamNormalize(Vec3Stream* outStream, const Vec3Stream& stream)
+{
+	EFW_MATH_ASSERT(outStream != NULL && stream.count <= outStream->capacity);
+
+	// Zero length vectors are kept, like Vec3Normalize
+	const int32_t paddedCount = GetPaddedCount(stream.count);
+
+#if defined(EFW_X86)
+	const int32_t simdTier = Cpu::GetSimdTier();
+	if (simdTier >= SimdTiers::kAVX2)
+		NormalizeAVX2(outStream, stream, paddedCount);
+	else if (simdTier >= SimdTiers::kSSE41)
+		NormalizeSSE41(outStream, stream, paddedCount);
+	else
+#endif
+	{
+		for (int32_t i=0; i<paddedCount; ++i)
+		{
+			const float x = stream.x[i], y = stream.y[i], z = stream.z[i];
+			const float lengthSquared = x * x + y * y + z * z;
+			const float invLength = (lengthSquared > 0.0f)? 1.0f / Math::Sqrt(lengthSquared) : 1.0f;
+
+			outStream->x[i] = x * invLength;
+			outStream->y[i] = y * invLength;
+			outStream->z[i] = z * invLength;
+		}
+	}
+	outStream->count = stream.count;
+}
+
+
+// Farthest kernels keep the first index per lane, so the lane reduction picks the smallest index among equal distances
+static int32_t ReduceFarthestLanes(float* outDistanceSquared, const float* distancesSquared, const int32_t* indices, int32_t laneCount)
+{
+	int32_t result = indices[0];
+	float maxDistanceSquared = distancesSquared[0];
+	for (int32_t i=1; i<laneCount; ++i)
+	{
+		if (distancesSquared[i] > maxDistanceSquared || 
+			(distancesSquared[i] == maxDistanceSquared && indices[i] < result))
+		{
+			maxDistanceSquared = distancesSquared[i];
+			result = indices[i];
+		}
+	}
+
+	*outDistanceSquared = maxDistanceSquared;
+	return result;
+}
+
+
+#if defined(EFW_X86)
+EFW_TARGET_ISA("sse4.1")
+static int32_t FindFarthestSSE41(float* outDistanceSquared, const Vec3Stream& stream, const float point[3])
+{
+	const int32_t paddedCount = GetPaddedCount(stream.count);
+	const __m128 pointX = _mm_set1_ps(point[0]), pointY = _mm_set1_ps(point[1]), pointZ = _mm_set1_ps(point[2]);
+	const __m128i indexStep = _mm_set1_epi32(4);
+	__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i maxIndex = _mm_set1_epi32(-1);
+	__m128 maxDistanceSquared = _mm_set1_ps(-1.0f);
+	for (int32_t i=0; i<paddedCount; i+=4)
+	{
+		const __m128 x = _mm_sub_ps(_mm_load_ps(&stream.x[i]), pointX);
+		const __m128 y = _mm_sub_ps(_mm_load_ps(&stream.y[i]), pointY);
+		const __m128 z = _mm_sub_ps(_mm_load_ps(&stream.z[i]), pointZ);
+		const __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		const __m128 isFarther = _mm_cmpgt_ps(distanceSquared, maxDistanceSquared);
+
+		maxDistanceSquared = _mm_blendv_ps(maxDistanceSquared, distanceSquared, isFarther);
+		maxIndex = _mm_castps_si128( _mm_blendv_ps(_mm_castsi128_ps(maxIndex), _mm_castsi128_ps(index), isFarther) );
+		index = _mm_add_epi32(index, indexStep);
+	}
+
+	EFW_ALIGNED_TYPE(16, float) distancesSquared[4];
+	EFW_ALIGNED_TYPE(16, int32_t) indices[4];
+	_mm_store_ps(distancesSquared, maxDistanceSquared);
+	_mm_store_si128((__m128i*)indices, maxIndex);
+	return ReduceFarthestLanes(outDistanceSquared, distancesSquared, indices, 4);
+}
+
+
+EFW_TARGET_ISA("avx2")
+static int32_t FindFarthestAVX2(float* outDistanceSquared, const Vec3Stream& stream, const float point[3])
+{
+	const int32_t paddedCount = GetPaddedCount(stream.count);
+	const __m256 pointX = _mm256_set1_ps(point[0]), pointY = _mm256_set1_ps(point[1]), pointZ = _mm256_set1_ps(point[2]);
+	const __m256i indexStep = _mm256_set1_epi32(8);
+	__m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i maxIndex = _mm256_set1_epi32(-1);
+	__m256 maxDistanceSquared = _mm256_set1_ps(-1.0f);
+	for (int32_t i=0; i<paddedCount; i+=8)
+	{
+		const __m256 x = _mm256_sub_ps(_mm256_load_ps(&stream.x[i]), pointX);
+		const __m256 y = _mm256_sub_ps(_mm256_load_ps(&stream.y[i]), pointY);
+		const __m256 z = _mm256_sub_ps(_mm256_load_ps(&stream.z[i]), pointZ);
+		const __m256 distanceSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+		const __m256 isFarther = _mm256_cmp_ps(distanceSquared, maxDistanceSquared, _CMP_GT_OQ);
+
+		maxDistanceSquared = _mm256_blendv_ps(maxDistanceSquared, distanceSquared, isFarther);
+		maxIndex = _mm256_castps_si256( _mm256_blendv_ps(_mm256_castsi256_ps(maxIndex), _mm256_castsi256_ps(index), isFarther) );
+		index = _mm256_add_epi32(index, indexStep);
+	}
+
+	EFW_ALIGNED_TYPE(32, float) distancesSquared[8];
+	EFW_ALIGNED_TYPE(32, int32_t) indices[8];
+	_mm256_store_ps(distancesSquared, maxDistanceSquared);
+	_mm256_store_si256((__m256i*)indices, maxIndex);
+	return ReduceFarthestLanes(outDistanceSquared, distancesSquared, indices, 8);
+}
+#endif
+
+
+int32_t efw::Math::Vec3StreamFindFarthest(float* outDistanceSquared, const Vec3Stream& stream, Vec3fRef point)
+{
+	EFW_MATH_ASSERT(outDistanceSquared != NULL);
+	if (stream.count == 0)
+	{
+		*outDistanceSquared = 0.0f;
+		return -1;
+	}
+
+	float pointValues[3];
+	Vec3GetFloats(pointValues, point);
+
+	// Padding repeats the last element at larger indices, so it never wins the reduction
+#if defined(EFW_X86)
+	const int32_t simdTier = Cpu::GetSimdTier();
+	if (simdTier >= SimdTiers::kAVX2)
+		return FindFarthestAVX2(outDistanceSquared, stream, pointValues);
+	else if (simdTier >= SimdTiers::kSSE41)
+		return FindFarthestSSE41(outDistanceSquared, stream, pointValues);
+#endif
+
+	int32_t result = -1;
+	float maxDistanceSquared = -1.0f;
+	for (int32_t i=0; i<stream.count; ++i)
+	{
+		const float x = stream.x[i] - pointValues[0];
+		const float y = stream.y[i] - pointValues[1];
+		const float z = stream.z[i] - pointValues[2];
+		const float distanceSquared = x * x + y * y + z * z;
+		if (distanceSquared > maxDistanceSquared)
+		{
+			maxDistanceSquared = distanceSquared;
+			result = i;
+		}
+	}
+
+	*outDistanceSquared = maxDistanceSquared;
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+/**
+ * Copyright (C) 2012 Bruno P. Evangelista. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+ * LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "Foundation/efwPlatform.h"
+#include "Math/efwVectorMath.h"
+
+namespace efw
+{
+namespace Math
+{
+
+	namespace BatchMath
+	{
+		// Lanes of the widest kernel, streams are padded to a multiple of it
+		const int32_t kLaneCount = 8;
+	}
+
+	/**
+	 * Structure-of-arrays float3 stream. Each component array is 32B aligned and padded to a multiple of 
+	 * BatchMath::kLaneCount, and the padding repeats the last element so it doesn't change min/max results. 
+	 * Kernels are selected at runtime from Cpu::GetSimdTier().
+	 */
+	struct Vec3Stream
+	{
+		float* x;
+		float* y;
+		float* z;
+		int32_t count;
+		int32_t capacity;
+	};
+
+	// Vec3Stream* arguments may alias the input streams
+	int32_t Vec3StreamCreate(Vec3Stream* outStream, int32_t capacity);
+	void Vec3StreamRelease(Vec3Stream* stream);
+
+	// Strided float3 arrays, strides are in bytes
+	void Vec3StreamGather(Vec3Stream* outStream, const float* in, int32_t inStride, int32_t count);
+	void Vec3StreamScatter(float* out, int32_t outStride, const Vec3Stream& stream);
+
+	void Vec3StreamMinMax(Vec3f* outMin, Vec3f* outMax, const Vec3Stream& stream);
+	void Vec3StreamLength(float* out, const Vec3Stream& stream);
+	void Vec3StreamDot(float* out, const Vec3Stream& stream1, const Vec3Stream& stream2);
+	void Vec3StreamCross(Vec3Stream* outStream, const Vec3Stream& stream1, const Vec3Stream& stream2);
+	void Vec3StreamNormalize(Vec3Stream* outStream, const Vec3Stream& stream);
+
+	// Returns the index of the first element farthest from the point, or -1 when the stream is empty
+	int32_t Vec3StreamFindFarthest(float* outDistanceSquared, const Vec3Stream& stream, Vec3fRef point);
+
+} // Math
+} // efw
\ No newline at end of file
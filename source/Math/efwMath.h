@@ -59,6 +59,31 @@ namespace efw
 
 		EFW_INLINE bool IsNumber(float b) { return (b == b); }
 		EFW_INLINE bool IsFinite(float b) { return (b >= -FLT_MAX && b <= FLT_MAX); }
+
+		// Rounds to nearest even, overflows to infinity and keeps NaNs
+		EFW_INLINE uint16_t FloatToHalf(float value)
+		{
+			union { float f; uint32_t u; } bits;
+			bits.f = value;
+			const uint32_t sign = (bits.u >> 16) & 0x8000;
+			const uint32_t absBits = bits.u & 0x7FFFFFFF;
+
+			if (absBits >= 0x7F800000)
+				return (uint16_t)(sign | 0x7C00 | ((absBits > 0x7F800000)? 0x200 : 0));
+			if (absBits >= 0x477FF000)
+				return (uint16_t)(sign | 0x7C00);
+
+			// Denormals are shifted into place by adding 0.5, which rounds them too
+			if (absBits < 0x38800000)
+			{
+				bits.u = absBits;
+				bits.f += 0.5f;
+				return (uint16_t)(sign | (bits.u - 0x3F000000));
+			}
+
+			const uint32_t mantissaOdd = (absBits >> 13) & 1;
+			return (uint16_t)(sign | ((absBits + 0xC8000FFF + mantissaOdd) >> 13));
+		}
 	}
 
 } // efw
\ No newline at end of file
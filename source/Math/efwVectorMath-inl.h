@@ -32,6 +32,8 @@ EFW_INLINE Vec3f::Vec3f(const float* ptr)
 	EFW_MATH_ASSERT( IsFinite(ptr[0]) && IsFinite(ptr[1]) && IsFinite(ptr[2]) );
 
 #if defined(EFW_MATH_SSE)
+	__m128 xy = _mm_castsi128_ps( _mm_loadl_epi64((const __m128i*)ptr) );
+	v = _mm_movelh_ps(xy, _mm_load_ss(&ptr[2]));
 #else
 	v[0] = ptr[0];
 	v[1] = ptr[1];
@@ -39,9 +41,22 @@ EFW_INLINE Vec3f::Vec3f(const float* ptr)
 #endif
 }
 
+#if defined(EFW_MATH_SSE)
+EFW_INLINE Vec3f::Vec3f(EFW_INTERNAL_VECTOR128 vec)
+{
+	v = vec;
+}
+
+EFW_INLINE Vec3f::operator EFW_INTERNAL_VECTOR128 () const
+{
+	return v;
+}
+#endif
+
 EFW_INLINE Vec3f::Vec3f(const Vec3f& vec)
 {
 #if defined(EFW_MATH_SSE)
+	v = vec.v;
 #else
 	v[0] = vec.v[0];
 	v[1] = vec.v[1];
@@ -52,6 +67,7 @@ EFW_INLINE Vec3f::Vec3f(const Vec3f& vec)
 EFW_INLINE Vec3f& Vec3f::operator += (Vec3fRef vec)
 {
 #if defined(EFW_MATH_SSE)
+	v = _mm_add_ps(v, vec);
 #else
 	v[0] += vec.v[0];
 	v[1] += vec.v[1];
@@ -63,6 +79,7 @@ EFW_INLINE Vec3f& Vec3f::operator += (Vec3fRef vec)
 EFW_INLINE Vec3f& Vec3f::operator -= (Vec3fRef vec)
 {
 #if defined(EFW_MATH_SSE)
+	v = _mm_sub_ps(v, vec);
 #else
 	v[0] -= vec.v[0];
 	v[1] -= vec.v[1];
@@ -74,6 +91,7 @@ EFW_INLINE Vec3f& Vec3f::operator -= (Vec3fRef vec)
 EFW_INLINE Vec3f& Vec3f::operator *= (Vec3fRef vec)
 {
 #if defined(EFW_MATH_SSE)
+	v = _mm_mul_ps(v, vec);
 #else
 	v[0] *= vec.v[0];
 	v[1] *= vec.v[1];
@@ -84,10 +102,11 @@ EFW_INLINE Vec3f& Vec3f::operator *= (Vec3fRef vec)
 
 EFW_INLINE Vec3f& Vec3f::operator /= (Vec3fRef vec)
 {
-	EFW_MATH_ASSERT(vec.v[0] != 0 && vec.v[1] != 0 && vec.v[2] != 0);
-
 #if defined(EFW_MATH_SSE)
+	EFW_MATH_ASSERT( (_mm_movemask_ps(_mm_cmpeq_ps(vec, _mm_setzero_ps())) & 7) == 0 );
+	v = _mm_div_ps(v, vec);
 #else
+	EFW_MATH_ASSERT(vec.v[0] != 0 && vec.v[1] != 0 && vec.v[2] != 0);
 	v[0] /= vec.v[0];
 	v[1] /= vec.v[1];
 	v[2] /= vec.v[2];
@@ -103,6 +122,7 @@ EFW_INLINE Vec3f Vec3f::operator + () const
 EFW_INLINE Vec3f Vec3f::operator - () const
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_xor_ps(v, _mm_set1_ps(-0.0f)) );
 #else
 	return Vec3f( -v[0], -v[1], -v[2] );
 #endif
@@ -111,6 +131,7 @@ EFW_INLINE Vec3f Vec3f::operator - () const
 EFW_INLINE Vec3f Vec3f::operator + (Vec3fRef vec) const
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_add_ps(v, vec) );
 #else
 	return Vec3f(v[0] + vec.v[0], v[1] + vec.v[1], v[2] + vec.v[2]);
 #endif
@@ -119,6 +140,7 @@ EFW_INLINE Vec3f Vec3f::operator + (Vec3fRef vec) const
 EFW_INLINE Vec3f Vec3f::operator - (Vec3fRef vec) const
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_sub_ps(v, vec) );
 #else
 	return Vec3f(v[0] - vec.v[0], v[1] - vec.v[1], v[2] - vec.v[2]);
 #endif
@@ -127,6 +149,7 @@ EFW_INLINE Vec3f Vec3f::operator - (Vec3fRef vec) const
 EFW_INLINE Vec3f Vec3f::operator * (Vec3fRef vec) const
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_mul_ps(v, vec) );
 #else
 	return Vec3f(v[0] * vec.v[0], v[1] * vec.v[1], v[2] * vec.v[2]);
 #endif
@@ -135,22 +158,26 @@ EFW_INLINE Vec3f Vec3f::operator * (Vec3fRef vec) const
 EFW_INLINE Vec3f Vec3f::operator / (Vec3fRef vec) const
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_div_ps(v, vec) );
 #else
 	return Vec3f(v[0] / vec.v[0], v[1] / vec.v[1], v[2] / vec.v[2]);
 #endif
 }
 
-EFW_INLINE Vec3f operator * (float value, Vec3fRef vec)
+// Takes the class type, SSE operators can't be overloaded on __m128 alone
+EFW_INLINE Vec3f operator * (float value, const Vec3f& vec)
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_mul_ps(vec.v, _mm_set1_ps(value)) );
 #else
 	return Vec3f(vec.v[0] * value, vec.v[1] * value, vec.v[2] * value);
 #endif
 }
 
-EFW_INLINE Vec3f operator / (float value, Vec3fRef vec)
+EFW_INLINE Vec3f operator / (float value, const Vec3f& vec)
 {
-	#if defined(EFW_MATH_SSE)
+#if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_div_ps(_mm_set1_ps(value), vec.v) );
 #else
 	return Vec3f(value) / vec;
 #endif
@@ -159,6 +186,8 @@ EFW_INLINE Vec3f operator / (float value, Vec3fRef vec)
 EFW_INLINE bool Vec3f::operator == (Vec3fRef vec) const
 {
 #if defined(EFW_MATH_SSE)
+	__m128 diff = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(v, vec));
+	return (_mm_movemask_ps(_mm_cmple_ps(diff, _mm_set1_ps(Math::kEpsilon))) & 7) == 7;
 #else
 	float diffX = Math::Abs(v[0] - vec.v[0]);
 	float diffY = Math::Abs(v[1] - vec.v[1]);
@@ -175,6 +204,7 @@ EFW_INLINE bool Vec3f::operator != (Vec3fRef vec) const
 EFW_INLINE float Vec3f::X() const
 {
 #if defined(EFW_MATH_SSE)
+	return _mm_cvtss_f32(v);
 #else
 	return v[0];
 #endif
@@ -183,6 +213,7 @@ EFW_INLINE float Vec3f::X() const
 EFW_INLINE float Vec3f::Y() const
 {
 #if defined(EFW_MATH_SSE)
+	return _mm_cvtss_f32( _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)) );
 #else
 	return v[1];
 #endif
@@ -191,6 +222,7 @@ EFW_INLINE float Vec3f::Y() const
 EFW_INLINE float Vec3f::Z() const
 {
 #if defined(EFW_MATH_SSE)
+	return _mm_cvtss_f32( _mm_movehl_ps(v, v) );
 #else
 	return v[2];
 #endif
@@ -199,9 +231,9 @@ EFW_INLINE float Vec3f::Z() const
 EFW_INLINE bool Vec3IsValid(Vec3fRef vec)
 {
 #if defined(EFW_MATH_SSE)
-	EFW_ALIGNED_TYPE(16, float) values[4];
-	_mm_store_ss(&values[0], v);
-	return ( IsFinite(values[0]) && IsFinite(values[1]) && IsFinite(values[2]) );
+	// Infinity and NaN have all exponent bits set
+	__m128i exponent = _mm_and_si128(_mm_castps_si128(vec), _mm_set1_epi32(0x7F800000));
+	return (_mm_movemask_ps( _mm_castsi128_ps(_mm_cmpeq_epi32(exponent, _mm_set1_epi32(0x7F800000))) ) & 7) == 0;
 #else
 	return ( IsFinite(vec.v[0]) && IsFinite(vec.v[1]) && IsFinite(vec.v[2]) );
 #endif
@@ -210,6 +242,7 @@ EFW_INLINE bool Vec3IsValid(Vec3fRef vec)
 EFW_INLINE Vec3f Vec3Length(Vec3fRef vec)
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_sqrt_ps(_mm_dp_ps(vec, vec, 0x7F)) );
 #else
 	float result = Math::Sqrt( Vec3Dot(vec, vec).v[0] );
 	return Vec3f(result);
@@ -219,6 +252,7 @@ EFW_INLINE Vec3f Vec3Length(Vec3fRef vec)
 EFW_INLINE Vec3f Vec3LengthSquared(Vec3fRef vec)
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_dp_ps(vec, vec, 0x7F) );
 #else
 	return Vec3Dot(vec, vec);
 #endif
@@ -227,6 +261,10 @@ EFW_INLINE Vec3f Vec3LengthSquared(Vec3fRef vec)
 EFW_INLINE Vec3f Vec3Normalize(Vec3fRef vec)
 {
 #if defined(EFW_MATH_SSE)
+	__m128 lengthSquared = _mm_dp_ps(vec, vec, 0x7F);
+	__m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSquared));
+	invLength = _mm_blendv_ps(_mm_set1_ps(1.0f), invLength, _mm_cmpgt_ps(lengthSquared, _mm_setzero_ps()));
+	return Vec3f( _mm_mul_ps(vec, invLength) );
 #else
 	float invLength = 1.0f;
 	float lengthSquared = Vec3LengthSquared(vec).v[0];
@@ -243,6 +281,7 @@ EFW_INLINE Vec3f Vec3Normalize(Vec3fRef vec)
 EFW_INLINE Vec3f Vec3Dot(Vec3fRef vec1, Vec3fRef vec2)
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_dp_ps(vec1, vec2, 0x7F) );
 #else
 	float result = vec1.v[0] * vec2.v[0] + vec1.v[1] * vec2.v[1] + vec1.v[2] * vec2.v[2];
 	return Vec3f(result);
@@ -252,6 +291,10 @@ EFW_INLINE Vec3f Vec3Dot(Vec3fRef vec1, Vec3fRef vec2)
 EFW_INLINE Vec3f Vec3Cross(Vec3fRef vec1, Vec3fRef vec2)
 {
 #if defined(EFW_MATH_SSE)
+	__m128 vec1YZX = _mm_shuffle_ps(vec1, vec1, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 vec2YZX = _mm_shuffle_ps(vec2, vec2, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 result = _mm_sub_ps(_mm_mul_ps(vec1, vec2YZX), _mm_mul_ps(vec1YZX, vec2));
+	return Vec3f( _mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 0, 2, 1)) );
 #else
 	return Vec3f(vec1.v[1] * vec2.v[2] - vec1.v[2] * vec2.v[1],
 		vec1.v[2] * vec2.v[0] - vec1.v[0] * vec2.v[2],
@@ -262,6 +305,7 @@ EFW_INLINE Vec3f Vec3Cross(Vec3fRef vec1, Vec3fRef vec2)
 EFW_INLINE Vec3f Vec3Abs(Vec3fRef vec)
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_andnot_ps(_mm_set1_ps(-0.0f), vec) );
 #else
 	return Vec3f( Math::Abs(vec.v[0]), Math::Abs(vec.v[1]), Math::Abs(vec.v[2]) );
 #endif
@@ -270,6 +314,7 @@ EFW_INLINE Vec3f Vec3Abs(Vec3fRef vec)
 EFW_INLINE Vec3f Vec3Ceil(Vec3fRef vec)
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_ceil_ps(vec) );
 #else
 	return Vec3f(Math::Ceil(vec.v[0]), Math::Ceil(vec.v[1]), Math::Ceil(vec.v[2]));
 #endif
@@ -278,6 +323,7 @@ EFW_INLINE Vec3f Vec3Ceil(Vec3fRef vec)
 EFW_INLINE Vec3f Vec3Floor(Vec3fRef vec)
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_floor_ps(vec) );
 #else
 	return Vec3f(Math::Floor(vec.v[0]), Math::Floor(vec.v[1]), Math::Floor(vec.v[2]));
 #endif
@@ -286,6 +332,7 @@ EFW_INLINE Vec3f Vec3Floor(Vec3fRef vec)
 EFW_INLINE Vec3f Vec3Min(Vec3fRef vec1, Vec3fRef vec2)
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_min_ps(vec1, vec2) );
 #else
 	return Vec3f(
 		Math::Min(vec1.v[0], vec2.v[0]),
@@ -297,6 +344,7 @@ EFW_INLINE Vec3f Vec3Min(Vec3fRef vec1, Vec3fRef vec2)
 EFW_INLINE Vec3f Vec3Max(Vec3fRef vec1, Vec3fRef vec2)
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_max_ps(vec1, vec2) );
 #else
 	return Vec3f(
 		Math::Max(vec1.v[0], vec2.v[0]),
@@ -308,6 +356,7 @@ EFW_INLINE Vec3f Vec3Max(Vec3fRef vec1, Vec3fRef vec2)
 EFW_INLINE Vec3f Vec3Lerp(Vec3fRef vec1, Vec3fRef vec2, float factor)
 {
 #if defined(EFW_MATH_SSE)
+	return Vec3f( _mm_add_ps(vec1, _mm_mul_ps(_mm_set1_ps(factor), _mm_sub_ps(vec2, vec1))) );
 #else
 	return Vec3f(vec1.v[0] + factor * (vec2.v[0] - vec1.v[0]),
 		vec1.v[1] + factor * (vec2.v[1] - vec1.v[1]),
@@ -319,9 +368,676 @@ EFW_INLINE void Vec3GetFloats(float* out, Vec3fRef vec)
 {
 	EFW_MATH_ASSERT(out != NULL);
 #if defined(EFW_MATH_SSE)
+	_mm_storel_pi((__m64*)out, vec);
+	_mm_store_ss(&out[2], _mm_movehl_ps(vec, vec));
 #else
 	out[0] = vec.v[0];
 	out[1] = vec.v[1];
 	out[2] = vec.v[2];
 #endif
+}
+
+EFW_INLINE Vec4f::Vec4f()
+{
+}
+
+EFW_INLINE Vec4f::Vec4f(float X)
+{
+	EFW_MATH_ASSERT( IsFinite(X) );
+#if defined(EFW_MATH_SSE)
+	v = _mm_set1_ps(X);
+#else
+	v[0] = v[1] = v[2] = v[3] = X;
+#endif
+}
+
+EFW_INLINE Vec4f::Vec4f(float X, float Y, float Z, float W)
+{
+	EFW_MATH_ASSERT( IsFinite(X) && IsFinite(Y) && IsFinite(Z) && IsFinite(W) );
+#if defined(EFW_MATH_SSE)
+	v = _mm_setr_ps(X, Y, Z, W);
+#else
+	v[0] = X; v[1] = Y; v[2] = Z; v[3] = W;
+#endif
+}
+
+EFW_INLINE Vec4f::Vec4f(const float* ptr)
+{
+	EFW_MATH_ASSERT( IsFinite(ptr[0]) && IsFinite(ptr[1]) && IsFinite(ptr[2]) && IsFinite(ptr[3]) );
+#if defined(EFW_MATH_SSE)
+	v = _mm_loadu_ps(ptr);
+#else
+	v[0] = ptr[0];
+	v[1] = ptr[1];
+	v[2] = ptr[2];
+	v[3] = ptr[3];
+#endif
+}
+
+EFW_INLINE Vec4f::Vec4f(Vec3fRef vec, float W)
+{
+	EFW_MATH_ASSERT( IsFinite(W) );
+#if defined(EFW_MATH_SSE)
+	v = _mm_insert_ps(vec, _mm_set_ss(W), 0x30);
+#else
+	v[0] = vec.v[0];
+	v[1] = vec.v[1];
+	v[2] = vec.v[2];
+	v[3] = W;
+#endif
+}
+
+#if defined(EFW_MATH_SSE)
+EFW_INLINE Vec4f::Vec4f(EFW_INTERNAL_VECTOR128 vec)
+{
+	v = vec;
+}
+
+EFW_INLINE Vec4f::operator EFW_INTERNAL_VECTOR128 () const
+{
+	return v;
+}
+#endif
+
+EFW_INLINE Vec4f::Vec4f(const Vec4f& vec)
+{
+#if defined(EFW_MATH_SSE)
+	v = vec.v;
+#else
+	v[0] = vec.v[0];
+	v[1] = vec.v[1];
+	v[2] = vec.v[2];
+	v[3] = vec.v[3];
+#endif
+}
+
+EFW_INLINE Vec4f& Vec4f::operator += (Vec4fRef vec)
+{
+#if defined(EFW_MATH_SSE)
+	v = _mm_add_ps(v, vec);
+#else
+	v[0] += vec.v[0];
+	v[1] += vec.v[1];
+	v[2] += vec.v[2];
+	v[3] += vec.v[3];
+#endif
+	return *this;
+}
+
+EFW_INLINE Vec4f& Vec4f::operator -= (Vec4fRef vec)
+{
+#if defined(EFW_MATH_SSE)
+	v = _mm_sub_ps(v, vec);
+#else
+	v[0] -= vec.v[0];
+	v[1] -= vec.v[1];
+	v[2] -= vec.v[2];
+	v[3] -= vec.v[3];
+#endif
+	return *this;
+}
+
+EFW_INLINE Vec4f& Vec4f::operator *= (Vec4fRef vec)
+{
+#if defined(EFW_MATH_SSE)
+	v = _mm_mul_ps(v, vec);
+#else
+	v[0] *= vec.v[0];
+	v[1] *= vec.v[1];
+	v[2] *= vec.v[2];
+	v[3] *= vec.v[3];
+#endif
+	return *this;
+}
+
+EFW_INLINE Vec4f& Vec4f::operator /= (Vec4fRef vec)
+{
+#if defined(EFW_MATH_SSE)
+	EFW_MATH_ASSERT( _mm_movemask_ps(_mm_cmpeq_ps(vec, _mm_setzero_ps())) == 0 );
+	v = _mm_div_ps(v, vec);
+#else
+	EFW_MATH_ASSERT(vec.v[0] != 0 && vec.v[1] != 0 && vec.v[2] != 0 && vec.v[3] != 0);
+	v[0] /= vec.v[0];
+	v[1] /= vec.v[1];
+	v[2] /= vec.v[2];
+	v[3] /= vec.v[3];
+#endif
+	return *this;
+}
+
+EFW_INLINE Vec4f Vec4f::operator + () const
+{
+	return *this;
+}
+
+EFW_INLINE Vec4f Vec4f::operator - () const
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_xor_ps(v, _mm_set1_ps(-0.0f)) );
+#else
+	return Vec4f( -v[0], -v[1], -v[2], -v[3] );
+#endif
+}
+
+EFW_INLINE Vec4f Vec4f::operator + (Vec4fRef vec) const
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_add_ps(v, vec) );
+#else
+	return Vec4f(v[0] + vec.v[0], v[1] + vec.v[1], v[2] + vec.v[2], v[3] + vec.v[3]);
+#endif
+}
+
+EFW_INLINE Vec4f Vec4f::operator - (Vec4fRef vec) const
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_sub_ps(v, vec) );
+#else
+	return Vec4f(v[0] - vec.v[0], v[1] - vec.v[1], v[2] - vec.v[2], v[3] - vec.v[3]);
+#endif
+}
+
+EFW_INLINE Vec4f Vec4f::operator * (Vec4fRef vec) const
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_mul_ps(v, vec) );
+#else
+	return Vec4f(v[0] * vec.v[0], v[1] * vec.v[1], v[2] * vec.v[2], v[3] * vec.v[3]);
+#endif
+}
+
+EFW_INLINE Vec4f Vec4f::operator / (Vec4fRef vec) const
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_div_ps(v, vec) );
+#else
+	return Vec4f(v[0] / vec.v[0], v[1] / vec.v[1], v[2] / vec.v[2], v[3] / vec.v[3]);
+#endif
+}
+
+EFW_INLINE Vec4f operator * (float value, const Vec4f& vec)
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_mul_ps(vec.v, _mm_set1_ps(value)) );
+#else
+	return Vec4f(vec.v[0] * value, vec.v[1] * value, vec.v[2] * value, vec.v[3] * value);
+#endif
+}
+
+EFW_INLINE Vec4f operator / (float value, const Vec4f& vec)
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_div_ps(_mm_set1_ps(value), vec.v) );
+#else
+	return Vec4f(value) / vec;
+#endif
+}
+
+EFW_INLINE bool Vec4f::operator == (Vec4fRef vec) const
+{
+#if defined(EFW_MATH_SSE)
+	__m128 diff = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(v, vec));
+	return _mm_movemask_ps(_mm_cmple_ps(diff, _mm_set1_ps(Math::kEpsilon))) == 15;
+#else
+	float diffX = Math::Abs(v[0] - vec.v[0]);
+	float diffY = Math::Abs(v[1] - vec.v[1]);
+	float diffZ = Math::Abs(v[2] - vec.v[2]);
+	float diffW = Math::Abs(v[3] - vec.v[3]);
+	return (diffX <= Math::kEpsilon && diffY <= Math::kEpsilon && diffZ <= Math::kEpsilon && diffW <= Math::kEpsilon);
+#endif
+}
+
+EFW_INLINE bool Vec4f::operator != (Vec4fRef vec) const
+{
+	return !(*this == vec);
+}
+
+EFW_INLINE float Vec4f::X() const
+{
+#if defined(EFW_MATH_SSE)
+	return _mm_cvtss_f32(v);
+#else
+	return v[0];
+#endif
+}
+
+EFW_INLINE float Vec4f::Y() const
+{
+#if defined(EFW_MATH_SSE)
+	return _mm_cvtss_f32( _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)) );
+#else
+	return v[1];
+#endif
+}
+
+EFW_INLINE float Vec4f::Z() const
+{
+#if defined(EFW_MATH_SSE)
+	return _mm_cvtss_f32( _mm_movehl_ps(v, v) );
+#else
+	return v[2];
+#endif
+}
+
+EFW_INLINE float Vec4f::W() const
+{
+#if defined(EFW_MATH_SSE)
+	return _mm_cvtss_f32( _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)) );
+#else
+	return v[3];
+#endif
+}
+
+EFW_INLINE bool Vec4IsValid(Vec4fRef vec)
+{
+#if defined(EFW_MATH_SSE)
+	__m128i exponent = _mm_and_si128(_mm_castps_si128(vec), _mm_set1_epi32(0x7F800000));
+	return _mm_movemask_ps( _mm_castsi128_ps(_mm_cmpeq_epi32(exponent, _mm_set1_epi32(0x7F800000))) ) == 0;
+#else
+	return ( IsFinite(vec.v[0]) && IsFinite(vec.v[1]) && IsFinite(vec.v[2]) && IsFinite(vec.v[3]) );
+#endif
+}
+
+EFW_INLINE Vec4f Vec4Dot(Vec4fRef vec1, Vec4fRef vec2)
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_dp_ps(vec1, vec2, 0xFF) );
+#else
+	float result = vec1.v[0] * vec2.v[0] + vec1.v[1] * vec2.v[1] + vec1.v[2] * vec2.v[2] + vec1.v[3] * vec2.v[3];
+	return Vec4f(result);
+#endif
+}
+
+EFW_INLINE Vec4f Vec4LengthSquared(Vec4fRef vec)
+{
+	return Vec4Dot(vec, vec);
+}
+
+EFW_INLINE Vec4f Vec4Length(Vec4fRef vec)
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_sqrt_ps(_mm_dp_ps(vec, vec, 0xFF)) );
+#else
+	float result = Math::Sqrt( Vec4Dot(vec, vec).v[0] );
+	return Vec4f(result);
+#endif
+}
+
+EFW_INLINE Vec4f Vec4Normalize(Vec4fRef vec)
+{
+#if defined(EFW_MATH_SSE)
+	__m128 lengthSquared = _mm_dp_ps(vec, vec, 0xFF);
+	__m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSquared));
+	invLength = _mm_blendv_ps(_mm_set1_ps(1.0f), invLength, _mm_cmpgt_ps(lengthSquared, _mm_setzero_ps()));
+	return Vec4f( _mm_mul_ps(vec, invLength) );
+#else
+	float invLength = 1.0f;
+	float lengthSquared = Vec4LengthSquared(vec).v[0];
+
+	if (lengthSquared > 0.0f)
+	{
+		invLength = 1.0f / Math::Sqrt(lengthSquared);
+	}
+
+	return vec * Vec4f(invLength);
+#endif
+}
+
+EFW_INLINE Vec4f Vec4Abs(Vec4fRef vec)
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_andnot_ps(_mm_set1_ps(-0.0f), vec) );
+#else
+	return Vec4f( Math::Abs(vec.v[0]), Math::Abs(vec.v[1]), Math::Abs(vec.v[2]), Math::Abs(vec.v[3]) );
+#endif
+}
+
+EFW_INLINE Vec4f Vec4Min(Vec4fRef vec1, Vec4fRef vec2)
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_min_ps(vec1, vec2) );
+#else
+	return Vec4f(
+		Math::Min(vec1.v[0], vec2.v[0]),
+		Math::Min(vec1.v[1], vec2.v[1]),
+		Math::Min(vec1.v[2], vec2.v[2]),
+		Math::Min(vec1.v[3], vec2.v[3]) );
+#endif
+}
+
+EFW_INLINE Vec4f Vec4Max(Vec4fRef vec1, Vec4fRef vec2)
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_max_ps(vec1, vec2) );
+#else
+	return Vec4f(
+		Math::Max(vec1.v[0], vec2.v[0]),
+		Math::Max(vec1.v[1], vec2.v[1]),
+		Math::Max(vec1.v[2], vec2.v[2]),
+		Math::Max(vec1.v[3], vec2.v[3]) );
+#endif
+}
+
+EFW_INLINE Vec4f Vec4Lerp(Vec4fRef vec1, Vec4fRef vec2, float factor)
+{
+#if defined(EFW_MATH_SSE)
+	return Vec4f( _mm_add_ps(vec1, _mm_mul_ps(_mm_set1_ps(factor), _mm_sub_ps(vec2, vec1))) );
+#else
+	return Vec4f(vec1.v[0] + factor * (vec2.v[0] - vec1.v[0]),
+		vec1.v[1] + factor * (vec2.v[1] - vec1.v[1]),
+		vec1.v[2] + factor * (vec2.v[2] - vec1.v[2]),
+		vec1.v[3] + factor * (vec2.v[3] - vec1.v[3]) );
+#endif
+}
+
+EFW_INLINE void Vec4GetFloats(float* out, Vec4fRef vec)
+{
+	EFW_MATH_ASSERT(out != NULL);
+#if defined(EFW_MATH_SSE)
+	_mm_storeu_ps(out, vec);
+#else
+	out[0] = vec.v[0];
+	out[1] = vec.v[1];
+	out[2] = vec.v[2];
+	out[3] = vec.v[3];
+#endif
+}
+
+EFW_INLINE Vec4f Vec4Transform(Vec4fRef vec, const Mat4f& mat)
+{
+#if defined(EFW_MATH_SSE)
+	__m128 result = _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(0, 0, 0, 0)), mat.r[0].v);
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(1, 1, 1, 1)), mat.r[1].v));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(2, 2, 2, 2)), mat.r[2].v));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(3, 3, 3, 3)), mat.r[3].v));
+	return Vec4f(result);
+#else
+	Vec4f result;
+	for (int32_t i=0; i<4; ++i)
+	{
+		result.v[i] = vec.v[0] * mat.r[0].v[i] + vec.v[1] * mat.r[1].v[i] + vec.v[2] * mat.r[2].v[i] + vec.v[3] * mat.r[3].v[i];
+	}
+	return result;
+#endif
+}
+
+EFW_INLINE Vec3f Vec3TransformPoint(Vec3fRef vec, const Mat4f& mat)
+{
+#if defined(EFW_MATH_SSE)
+	__m128 result = _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(0, 0, 0, 0)), mat.r[0].v);
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(1, 1, 1, 1)), mat.r[1].v));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(2, 2, 2, 2)), mat.r[2].v));
+	return Vec3f( _mm_add_ps(result, mat.r[3].v) );
+#else
+	Vec3f result;
+	for (int32_t i=0; i<3; ++i)
+	{
+		result.v[i] = vec.v[0] * mat.r[0].v[i] + vec.v[1] * mat.r[1].v[i] + vec.v[2] * mat.r[2].v[i] + mat.r[3].v[i];
+	}
+	return result;
+#endif
+}
+
+EFW_INLINE Vec3f Vec3TransformVector(Vec3fRef vec, const Mat4f& mat)
+{
+#if defined(EFW_MATH_SSE)
+	__m128 result = _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(0, 0, 0, 0)), mat.r[0].v);
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(1, 1, 1, 1)), mat.r[1].v));
+	return Vec3f( _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(2, 2, 2, 2)), mat.r[2].v)) );
+#else
+	Vec3f result;
+	for (int32_t i=0; i<3; ++i)
+	{
+		result.v[i] = vec.v[0] * mat.r[0].v[i] + vec.v[1] * mat.r[1].v[i] + vec.v[2] * mat.r[2].v[i];
+	}
+	return result;
+#endif
+}
+
+
+EFW_INLINE Mat4f::Mat4f()
+{
+}
+
+EFW_INLINE Mat4f::Mat4f(Vec4fRef row0, Vec4fRef row1, Vec4fRef row2, Vec4fRef row3)
+{
+	r[0] = Vec4f(row0);
+	r[1] = Vec4f(row1);
+	r[2] = Vec4f(row2);
+	r[3] = Vec4f(row3);
+}
+
+EFW_INLINE Mat4f::Mat4f(const float* ptr)
+{
+	r[0] = Vec4f(&ptr[0]);
+	r[1] = Vec4f(&ptr[4]);
+	r[2] = Vec4f(&ptr[8]);
+	r[3] = Vec4f(&ptr[12]);
+}
+
+EFW_INLINE Mat4f Mat4f::operator * (const Mat4f& mat) const
+{
+	return Mat4f( Vec4Transform(r[0], mat), Vec4Transform(r[1], mat), Vec4Transform(r[2], mat), Vec4Transform(r[3], mat) );
+}
+
+EFW_INLINE Mat4f& Mat4f::operator *= (const Mat4f& mat)
+{
+	*this = *this * mat;
+	return *this;
+}
+
+EFW_INLINE Mat4f Mat4Transpose(const Mat4f& mat)
+{
+#if defined(EFW_MATH_SSE)
+	__m128 row0 = mat.r[0].v, row1 = mat.r[1].v, row2 = mat.r[2].v, row3 = mat.r[3].v;
+	_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+	return Mat4f( Vec4f(row0), Vec4f(row1), Vec4f(row2), Vec4f(row3) );
+#else
+	return Mat4f(
+		Vec4f(mat.r[0].v[0], mat.r[1].v[0], mat.r[2].v[0], mat.r[3].v[0]),
+		Vec4f(mat.r[0].v[1], mat.r[1].v[1], mat.r[2].v[1], mat.r[3].v[1]),
+		Vec4f(mat.r[0].v[2], mat.r[1].v[2], mat.r[2].v[2], mat.r[3].v[2]),
+		Vec4f(mat.r[0].v[3], mat.r[1].v[3], mat.r[2].v[3], mat.r[3].v[3]) );
+#endif
+}
+
+EFW_INLINE Mat4f Mat4Translation(Vec3fRef translation)
+{
+	return Mat4f( Vec4f(1.0f, 0.0f, 0.0f, 0.0f), Vec4f(0.0f, 1.0f, 0.0f, 0.0f), Vec4f(0.0f, 0.0f, 1.0f, 0.0f), Vec4f(translation, 1.0f) );
+}
+
+EFW_INLINE Mat4f Mat4Scale(Vec3fRef scale)
+{
+#if defined(EFW_MATH_SSE)
+	__m128 zero = _mm_setzero_ps();
+	return Mat4f( Vec4f(_mm_blend_ps(zero, scale, 1)), Vec4f(_mm_blend_ps(zero, scale, 2)), Vec4f(_mm_blend_ps(zero, scale, 4)), 
+		Vec4f(0.0f, 0.0f, 0.0f, 1.0f) );
+#else
+	return Mat4f( Vec4f(scale.v[0], 0.0f, 0.0f, 0.0f), Vec4f(0.0f, scale.v[1], 0.0f, 0.0f), Vec4f(0.0f, 0.0f, scale.v[2], 0.0f), 
+		Vec4f(0.0f, 0.0f, 0.0f, 1.0f) );
+#endif
+}
+
+EFW_INLINE Mat4f Mat4Rotation(const Quatf& quat)
+{
+	EFW_ALIGNED_TYPE(16, float) q[4];
+	QuatGetFloats(q, quat);
+	const float xx = q[0]*q[0], yy = q[1]*q[1], zz = q[2]*q[2];
+	const float xy = q[0]*q[1], xz = q[0]*q[2], yz = q[1]*q[2];
+	const float wx = q[3]*q[0], wy = q[3]*q[1], wz = q[3]*q[2];
+
+	return Mat4f(
+		Vec4f(1.0f - 2.0f*(yy + zz), 2.0f*(xy + wz), 2.0f*(xz - wy), 0.0f),
+		Vec4f(2.0f*(xy - wz), 1.0f - 2.0f*(xx + zz), 2.0f*(yz + wx), 0.0f),
+		Vec4f(2.0f*(xz + wy), 2.0f*(yz - wx), 1.0f - 2.0f*(xx + yy), 0.0f),
+		Vec4f(0.0f, 0.0f, 0.0f, 1.0f) );
+}
+
+EFW_INLINE void Mat4GetFloats(float* out, const Mat4f& mat)
+{
+	Vec4GetFloats(&out[0], mat.r[0]);
+	Vec4GetFloats(&out[4], mat.r[1]);
+	Vec4GetFloats(&out[8], mat.r[2]);
+	Vec4GetFloats(&out[12], mat.r[3]);
+}
+
+
+EFW_INLINE Quatf::Quatf()
+{
+}
+
+EFW_INLINE Quatf::Quatf(float X, float Y, float Z, float W)
+{
+	EFW_MATH_ASSERT( IsFinite(X) && IsFinite(Y) && IsFinite(Z) && IsFinite(W) );
+#if defined(EFW_MATH_SSE)
+	v = _mm_setr_ps(X, Y, Z, W);
+#else
+	v[0] = X; v[1] = Y; v[2] = Z; v[3] = W;
+#endif
+}
+
+EFW_INLINE Quatf::Quatf(const float* ptr)
+{
+	EFW_MATH_ASSERT( IsFinite(ptr[0]) && IsFinite(ptr[1]) && IsFinite(ptr[2]) && IsFinite(ptr[3]) );
+#if defined(EFW_MATH_SSE)
+	v = _mm_loadu_ps(ptr);
+#else
+	v[0] = ptr[0];
+	v[1] = ptr[1];
+	v[2] = ptr[2];
+	v[3] = ptr[3];
+#endif
+}
+
+#if defined(EFW_MATH_SSE)
+EFW_INLINE Quatf::Quatf(EFW_INTERNAL_VECTOR128 vec)
+{
+	v = vec;
+}
+#endif
+
+EFW_INLINE Quatf::Quatf(const Quatf& quat)
+{
+#if defined(EFW_MATH_SSE)
+	v = quat.v;
+#else
+	v[0] = quat.v[0];
+	v[1] = quat.v[1];
+	v[2] = quat.v[2];
+	v[3] = quat.v[3];
+#endif
+}
+
+EFW_INLINE Quatf Quatf::operator * (const Quatf& quat) const
+{
+	// Hamilton product quat * this, so this rotation is applied first
+#if defined(EFW_MATH_SSE)
+	const __m128 signs = _mm_setr_ps(1.0f, 1.0f, 1.0f, -1.0f);
+	__m128 result = _mm_mul_ps(_mm_shuffle_ps(quat.v, quat.v, _MM_SHUFFLE(3, 3, 3, 3)), v);
+	__m128 product = _mm_mul_ps(_mm_shuffle_ps(quat.v, quat.v, _MM_SHUFFLE(0, 2, 1, 0)), _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 3, 3, 3)));
+	result = _mm_add_ps(result, _mm_mul_ps(product, signs));
+	product = _mm_mul_ps(_mm_shuffle_ps(quat.v, quat.v, _MM_SHUFFLE(1, 0, 2, 1)), _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 0, 2)));
+	result = _mm_add_ps(result, _mm_mul_ps(product, signs));
+	product = _mm_mul_ps(_mm_shuffle_ps(quat.v, quat.v, _MM_SHUFFLE(2, 1, 0, 2)), _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 0, 2, 1)));
+	return Quatf( _mm_sub_ps(result, product) );
+#else
+	return Quatf(
+		quat.v[3]*v[0] + quat.v[0]*v[3] + quat.v[1]*v[2] - quat.v[2]*v[1],
+		quat.v[3]*v[1] + quat.v[1]*v[3] + quat.v[2]*v[0] - quat.v[0]*v[2],
+		quat.v[3]*v[2] + quat.v[2]*v[3] + quat.v[0]*v[1] - quat.v[1]*v[0],
+		quat.v[3]*v[3] - quat.v[0]*v[0] - quat.v[1]*v[1] - quat.v[2]*v[2] );
+#endif
+}
+
+EFW_INLINE Quatf& Quatf::operator *= (const Quatf& quat)
+{
+	*this = *this * quat;
+	return *this;
+}
+
+EFW_INLINE float Quatf::X() const
+{
+#if defined(EFW_MATH_SSE)
+	return _mm_cvtss_f32(v);
+#else
+	return v[0];
+#endif
+}
+
+EFW_INLINE float Quatf::Y() const
+{
+#if defined(EFW_MATH_SSE)
+	return _mm_cvtss_f32( _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)) );
+#else
+	return v[1];
+#endif
+}
+
+EFW_INLINE float Quatf::Z() const
+{
+#if defined(EFW_MATH_SSE)
+	return _mm_cvtss_f32( _mm_movehl_ps(v, v) );
+#else
+	return v[2];
+#endif
+}
+
+EFW_INLINE float Quatf::W() const
+{
+#if defined(EFW_MATH_SSE)
+	return _mm_cvtss_f32( _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)) );
+#else
+	return v[3];
+#endif
+}
+
+EFW_INLINE Quatf QuatConjugate(const Quatf& quat)
+{
+#if defined(EFW_MATH_SSE)
+	return Quatf( _mm_xor_ps(quat.v, _mm_setr_ps(-0.0f, -0.0f, -0.0f, 0.0f)) );
+#else
+	return Quatf(-quat.v[0], -quat.v[1], -quat.v[2], quat.v[3]);
+#endif
+}
+
+EFW_INLINE Quatf QuatNormalize(const Quatf& quat)
+{
+	return Quatf( Vec4Normalize(Vec4f(quat.v)).v );
+}
+
+EFW_INLINE Quatf QuatFromAxisAngle(Vec3fRef axis, float angle)
+{
+	EFW_ALIGNED_TYPE(16, float) values[4];
+	Vec3GetFloats(values, Vec3Normalize(axis));
+	const float sinHalfAngle = sinf(angle * 0.5f);
+	return Quatf(values[0] * sinHalfAngle, values[1] * sinHalfAngle, values[2] * sinHalfAngle, cosf(angle * 0.5f));
+}
+
+EFW_INLINE void QuatGetFloats(float* out, const Quatf& quat)
+{
+	EFW_MATH_ASSERT(out != NULL);
+#if defined(EFW_MATH_SSE)
+	_mm_storeu_ps(out, quat.v);
+#else
+	out[0] = quat.v[0];
+	out[1] = quat.v[1];
+	out[2] = quat.v[2];
+	out[3] = quat.v[3];
+#endif
+}
+
+EFW_INLINE Vec3f Vec3Rotate(Vec3fRef vec, const Quatf& quat)
+{
+	// v + w * t + cross(q, t), where t = 2 * cross(q, v)
+#if defined(EFW_MATH_SSE)
+	Vec3f axis = Vec3f(quat.v);
+	Vec3f t = Vec3Cross(axis, vec);
+	t += t;
+	return Vec3f( _mm_add_ps(_mm_add_ps(vec, _mm_mul_ps(_mm_shuffle_ps(quat.v, quat.v, _MM_SHUFFLE(3, 3, 3, 3)), t)), Vec3Cross(axis, t)) );
+#else
+	Vec3f axis = Vec3f(quat.v[0], quat.v[1], quat.v[2]);
+	Vec3f t = Vec3Cross(axis, vec);
+	t += t;
+	return vec + quat.v[3] * t + Vec3Cross(axis, t);
+#endif
 }
\ No newline at end of file
@@ -1,4 +1,192 @@
 #include "Math/efwVectorMath.h"
 using namespace efw::Math;
 
-const Vec3f Vec3f::kZero = Vec3f(0.0f);
\ No newline at end of file
+const Vec3f Vec3f::kZero = Vec3f(0.0f);
+const Vec4f Vec4f::kZero = Vec4f(0.0f);
+const Mat4f Mat4f::kIdentity = Mat4f( Vec4f(1.0f, 0.0f, 0.0f, 0.0f), Vec4f(0.0f, 1.0f, 0.0f, 0.0f), Vec4f(0.0f, 0.0f, 1.0f, 0.0f), 
+	Vec4f(0.0f, 0.0f, 0.0f, 1.0f) );
+const Quatf Quatf::kIdentity = Quatf(0.0f, 0.0f, 0.0f, 1.0f);
+
+
+#if defined(EFW_MATH_SSE)
+// 2x2 matrices stored as (m00, m01, m10, m11)
+static EFW_INLINE __m128 Mat2Mul(__m128 mat1, __m128 mat2)
+{
+	return _mm_add_ps( _mm_mul_ps(_mm_shuffle_ps(mat1, mat1, _MM_SHUFFLE(2, 2, 0, 0)), _mm_movelh_ps(mat2, mat2)), 
+		_mm_mul_ps(_mm_shuffle_ps(mat1, mat1, _MM_SHUFFLE(3, 3, 1, 1)), _mm_movehl_ps(mat2, mat2)) );
+}
+
+// adjugate(mat1) * mat2
+static EFW_INLINE __m128 Mat2AdjMul(__m128 mat1, __m128 mat2)
+{
+	return _mm_sub_ps( _mm_mul_ps(_mm_shuffle_ps(mat1, mat1, _MM_SHUFFLE(0, 0, 3, 3)), mat2), 
+		_mm_mul_ps(_mm_shuffle_ps(mat1, mat1, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(mat2, mat2, _MM_SHUFFLE(1, 0, 3, 2))) );
+}
+
+// mat1 * adjugate(mat2)
+static EFW_INLINE __m128 Mat2MulAdj(__m128 mat1, __m128 mat2)
+{
+	return _mm_sub_ps( _mm_mul_ps(mat1, _mm_shuffle_ps(mat2, mat2, _MM_SHUFFLE(0, 3, 0, 3))), 
+		_mm_mul_ps(_mm_shuffle_ps(mat1, mat1, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(mat2, mat2, _MM_SHUFFLE(1, 2, 1, 2))) );
+}
+#endif
+
+
+Mat4f efw::Math::Mat4Inverse(const Mat4f& mat, float* outDeterminant)
+{
+#if defined(EFW_MATH_SSE)
+	// Blockwise inverse of the 2x2 sub-matrices [A B; C D]
+	const __m128 row0 = mat.r[0].v, row1 = mat.r[1].v, row2 = mat.r[2].v, row3 = mat.r[3].v;
+	const __m128 A = _mm_movelh_ps(row0, row1);
+	const __m128 B = _mm_movehl_ps(row1, row0);
+	const __m128 C = _mm_movelh_ps(row2, row3);
+	const __m128 D = _mm_movehl_ps(row3, row2);
+
+	// Determinants of A, B, C and D
+	const __m128 subDeterminants = _mm_sub_ps( 
+		_mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(3, 1, 3, 1))), 
+		_mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(2, 0, 2, 0))) );
+	const __m128 detA = _mm_shuffle_ps(subDeterminants, subDeterminants, _MM_SHUFFLE(0, 0, 0, 0));
+	const __m128 detB = _mm_shuffle_ps(subDeterminants, subDeterminants, _MM_SHUFFLE(1, 1, 1, 1));
+	const __m128 detC = _mm_shuffle_ps(subDeterminants, subDeterminants, _MM_SHUFFLE(2, 2, 2, 2));
+	const __m128 detD = _mm_shuffle_ps(subDeterminants, subDeterminants, _MM_SHUFFLE(3, 3, 3, 3));
+
+	const __m128 DC = Mat2AdjMul(D, C);
+	const __m128 AB = Mat2AdjMul(A, B);
+	__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, DC));
+	__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, AB));
+	__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, AB));
+	__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, DC));
+
+	__m128 determinant = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+	__m128 trace = _mm_dp_ps(AB, _mm_shuffle_ps(DC, DC, _MM_SHUFFLE(3, 1, 2, 0)), 0xFF);
+	determinant = _mm_sub_ps(determinant, trace);
+	if (outDeterminant != NULL)
+		*outDeterminant = _mm_cvtss_f32(determinant);
+	if (_mm_cvtss_f32(determinant) == 0.0f)
+		return Mat4f::kIdentity;
+
+	// The adjugate signs of each block are folded into the reciprocal
+	const __m128 invDeterminant = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+	X = _mm_mul_ps(X, invDeterminant);
+	Y = _mm_mul_ps(Y, invDeterminant);
+	Z = _mm_mul_ps(Z, invDeterminant);
+	W = _mm_mul_ps(W, invDeterminant);
+
+	return Mat4f( 
+		Vec4f(_mm_shuffle_ps(X, Y, _MM_SHUFFLE(1, 3, 1, 3))), 
+		Vec4f(_mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 2, 0, 2))), 
+		Vec4f(_mm_shuffle_ps(Z, W, _MM_SHUFFLE(1, 3, 1, 3))), 
+		Vec4f(_mm_shuffle_ps(Z, W, _MM_SHUFFLE(0, 2, 0, 2))) );
+#else
+	// Cofactor expansion
+	const float* m = &mat.r[0].v[0];
+	float inv[16];
+
+	inv[0] = m[5]*m[10]*m[15] - m[5]*m[11]*m[14] - m[9]*m[6]*m[15] + m[9]*m[7]*m[14] + m[13]*m[6]*m[11] - m[13]*m[7]*m[10];
+	inv[4] = -m[4]*m[10]*m[15] + m[4]*m[11]*m[14] + m[8]*m[6]*m[15] - m[8]*m[7]*m[14] - m[12]*m[6]*m[11] + m[12]*m[7]*m[10];
+	inv[8] = m[4]*m[9]*m[15] - m[4]*m[11]*m[13] - m[8]*m[5]*m[15] + m[8]*m[7]*m[13] + m[12]*m[5]*m[11] - m[12]*m[7]*m[9];
+	inv[12] = -m[4]*m[9]*m[14] + m[4]*m[10]*m[13] + m[8]*m[5]*m[14] - m[8]*m[6]*m[13] - m[12]*m[5]*m[10] + m[12]*m[6]*m[9];
+	inv[1] = -m[1]*m[10]*m[15] + m[1]*m[11]*m[14] + m[9]*m[2]*m[15] - m[9]*m[3]*m[14] - m[13]*m[2]*m[11] + m[13]*m[3]*m[10];
+	inv[5] = m[0]*m[10]*m[15] - m[0]*m[11]*m[14] - m[8]*m[2]*m[15] + m[8]*m[3]*m[14] + m[12]*m[2]*m[11] - m[12]*m[3]*m[10];
+	inv[9] = -m[0]*m[9]*m[15] + m[0]*m[11]*m[13] + m[8]*m[1]*m[15] - m[8]*m[3]*m[13] - m[12]*m[1]*m[11] + m[12]*m[3]*m[9];
+	inv[13] = m[0]*m[9]*m[14] - m[0]*m[10]*m[13] - m[8]*m[1]*m[14] + m[8]*m[2]*m[13] + m[12]*m[1]*m[10] - m[12]*m[2]*m[9];
+	inv[2] = m[1]*m[6]*m[15] - m[1]*m[7]*m[14] - m[5]*m[2]*m[15] + m[5]*m[3]*m[14] + m[13]*m[2]*m[7] - m[13]*m[3]*m[6];
+	inv[6] = -m[0]*m[6]*m[15] + m[0]*m[7]*m[14] + m[4]*m[2]*m[15] - m[4]*m[3]*m[14] - m[12]*m[2]*m[7] + m[12]*m[3]*m[6];
+	inv[10] = m[0]*m[5]*m[15] - m[0]*m[7]*m[13] - m[4]*m[1]*m[15] + m[4]*m[3]*m[13] + m[12]*m[1]*m[7] - m[12]*m[3]*m[5];
+	inv[14] = -m[0]*m[5]*m[14] + m[0]*m[6]*m[13] + m[4]*m[1]*m[14] - m[4]*m[2]*m[13] - m[12]*m[1]*m[6] + m[12]*m[2]*m[5];
+	inv[3] = -m[1]*m[6]*m[11] + m[1]*m[7]*m[10] + m[5]*m[2]*m[11] - m[5]*m[3]*m[10] - m[9]*m[2]*m[7] + m[9]*m[3]*m[6];
+	inv[7] = m[0]*m[6]*m[11] - m[0]*m[7]*m[10] - m[4]*m[2]*m[11] + m[4]*m[3]*m[10] + m[8]*m[2]*m[7] - m[8]*m[3]*m[6];
+	inv[11] = -m[0]*m[5]*m[11] + m[0]*m[7]*m[9] + m[4]*m[1]*m[11] - m[4]*m[3]*m[9] - m[8]*m[1]*m[7] + m[8]*m[3]*m[5];
+	inv[15] = m[0]*m[5]*m[10] - m[0]*m[6]*m[9] - m[4]*m[1]*m[10] + m[4]*m[2]*m[9] + m[8]*m[1]*m[6] - m[8]*m[2]*m[5];
+
+	const float determinant = m[0]*inv[0] + m[1]*inv[4] + m[2]*inv[8] + m[3]*inv[12];
+	if (outDeterminant != NULL)
+		*outDeterminant = determinant;
+	if (determinant == 0.0f)
+		return Mat4f::kIdentity;
+
+	const float invDeterminant = 1.0f / determinant;
+	Mat4f result;
+	for (int32_t i=0; i<16; ++i)
+		result.r[i/4].v[i%4] = inv[i] * invDeterminant;
+	return result;
+#endif
+}
+
+
+Quatf efw::Math::QuatFromRotation(const Mat4f& mat)
+{
+	EFW_ALIGNED_TYPE(16, float) m[16];
+	Mat4GetFloats(m, mat);
+
+	// Matrices are transposed rotations, since they are applied to row vectors
+	const float trace = m[0] + m[5] + m[10];
+	if (trace > 0.0f)
+	{
+		const float s = 0.5f / Math::Sqrt(trace + 1.0f);
+		return Quatf((m[6] - m[9]) * s, (m[8] - m[2]) * s, (m[1] - m[4]) * s, 0.25f / s);
+	}
+	else if (m[0] > m[5] && m[0] > m[10])
+	{
+		const float s = 2.0f * Math::Sqrt(1.0f + m[0] - m[5] - m[10]);
+		return Quatf(0.25f * s, (m[4] + m[1]) / s, (m[8] + m[2]) / s, (m[6] - m[9]) / s);
+	}
+	else if (m[5] > m[10])
+	{
+		const float s = 2.0f * Math::Sqrt(1.0f + m[5] - m[0] - m[10]);
+		return Quatf((m[4] + m[1]) / s, 0.25f * s, (m[9] + m[6]) / s, (m[8] - m[2]) / s);
+	}
+	
+	const float s = 2.0f * Math::Sqrt(1.0f + m[10] - m[0] - m[5]);
+	return Quatf((m[8] + m[2]) / s, (m[9] + m[6]) / s, 0.25f * s, (m[1] - m[4]) / s);
+}
+
+
+static void TransformVec3Array(float* out, int32_t outStride, const float* in, int32_t inStride, int32_t count, const Mat4f& mat, 
+	bool isPoint)
+{
+	EFW_MATH_ASSERT(out != NULL && in != NULL);
+
+#if defined(EFW_MATH_SSE)
+	const __m128 row0 = mat.r[0].v, row1 = mat.r[1].v, row2 = mat.r[2].v;
+	const __m128 row3 = (isPoint)? mat.r[3].v : _mm_setzero_ps();
+	for (int32_t i=0; i<count; ++i)
+	{
+		// Exactly three floats are read and written, so packed arrays are safe
+		__m128 vec = _mm_movelh_ps( _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)in)), _mm_load_ss(&in[2]) );
+		__m128 result = _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(0, 0, 0, 0)), row0);
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(1, 1, 1, 1)), row1));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vec, vec, _MM_SHUFFLE(2, 2, 2, 2)), row2));
+		result = _mm_add_ps(result, row3);
+
+		_mm_storel_pi((__m64*)out, result);
+		_mm_store_ss(&out[2], _mm_movehl_ps(result, result));
+		in = (const float*)( (const uint8_t*)in + inStride );
+		out = (float*)( (uint8_t*)out + outStride );
+	}
+#else
+	const float w = (isPoint)? 1.0f : 0.0f;
+	for (int32_t i=0; i<count; ++i)
+	{
+		const float x = in[0], y = in[1], z = in[2];
+		for (int32_t j=0; j<3; ++j)
+			out[j] = x * mat.r[0].v[j] + y * mat.r[1].v[j] + z * mat.r[2].v[j] + w * mat.r[3].v[j];
+
+		in = (const float*)( (const uint8_t*)in + inStride );
+		out = (float*)( (uint8_t*)out + outStride );
+	}
+#endif
+}
+
+
+void efw::Math::Vec3TransformPoints(float* out, int32_t outStride, const float* in, int32_t inStride, int32_t count, const Mat4f& mat)
+{
+	TransformVec3Array(out, outStride, in, inStride, count, mat, true);
+}
+
+
+void efw::Math::Vec3TransformVectors(float* out, int32_t outStride, const float* in, int32_t inStride, int32_t count, const Mat4f& mat)
+{
+	TransformVec3Array(out, outStride, in, inStride, count, mat, false);
+}
\ No newline at end of file
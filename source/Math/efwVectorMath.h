@@ -16,8 +16,14 @@
 #include "Foundation/efwPlatform.h"
 #include "Math/efwMath.h"
 
+// Define EFW_MATH_SSE in the build to use the SSE4.1 backend
 //#define EFW_MATH_SSE
 
+// Both backends give the same results, except where the SSE one evaluates in a different order. Vec4Normalize and 
+// QuatNormalize agree within 4 ulps. Vec4Dot and Mat4Rotation add their products in another order, so they agree 
+// within a few ulps of the largest product rather than of the result. Mat4Inverse is blockwise instead of by cofactors, 
+// and its difference grows with the condition number of the matrix.
+
 #if defined(EFW_MATH_SSE)
 #include <mmintrin.h>
 #include <xmmintrin.h>
@@ -52,6 +58,10 @@ namespace Math
 		Vec3f(const Vec3f&);
 		explicit Vec3f(float);
 		explicit Vec3f(const float*);
+#if defined(EFW_MATH_SSE)
+		explicit Vec3f(EFW_INTERNAL_VECTOR128);
+		operator EFW_INTERNAL_VECTOR128 () const;
+#endif
 
 		Vec3f& operator += (Vec3fRef);
 		Vec3f& operator -= (Vec3fRef);
@@ -78,7 +88,6 @@ namespace Math
 		static const Vec3f kZero;
 	};
 
-	/*
 	EFW_ALIGNED_TYPE(16, struct) Vec4f
 	{
 		EFW_INTERNAL_VECTOR128 v;
@@ -88,6 +97,11 @@ namespace Math
 		Vec4f(const Vec4f&);
 		explicit Vec4f(float);
 		explicit Vec4f(const float*);
+		explicit Vec4f(Vec3fRef, float W);
+#if defined(EFW_MATH_SSE)
+		explicit Vec4f(EFW_INTERNAL_VECTOR128);
+		operator EFW_INTERNAL_VECTOR128 () const;
+#endif
 
 		Vec4f& operator += (Vec4fRef);
 		Vec4f& operator -= (Vec4fRef);
@@ -109,11 +123,58 @@ namespace Math
 		float X() const;
 		float Y() const;
 		float Z() const;
+		float W() const;
 
 		// Static
-		static const Vec3f kZero;
+		static const Vec4f kZero;
+	};
+
+	/**
+	 * Row major matrix used with row vectors, so points are transformed as (x, y, z, 1) * M and the translation 
+	 * is in the last row. A * B applies A first and then B.
+	 */
+	EFW_ALIGNED_TYPE(16, struct) Mat4f
+	{
+		Vec4f r[4];
+
+		Mat4f();
+		Mat4f(Vec4fRef row0, Vec4fRef row1, Vec4fRef row2, Vec4fRef row3);
+		explicit Mat4f(const float*);
+
+		Mat4f operator * (const Mat4f&) const;
+		Mat4f& operator *= (const Mat4f&);
+
+		// Static
+		static const Mat4f kIdentity;
+	};
+
+	/**
+	 * Rotation quaternion stored as (x, y, z, w). Like matrices, q1 * q2 rotates by q1 first and then by q2.
+	 */
+	EFW_ALIGNED_TYPE(16, struct) Quatf
+	{
+		EFW_INTERNAL_VECTOR128 v;
+
+		Quatf();
+		Quatf(float X, float Y, float Z, float W);
+		Quatf(const Quatf&);
+		explicit Quatf(const float*);
+#if defined(EFW_MATH_SSE)
+		explicit Quatf(EFW_INTERNAL_VECTOR128);
+#endif
+
+		Quatf operator * (const Quatf&) const;
+		Quatf& operator *= (const Quatf&);
+
+		// Slow single component access
+		float X() const;
+		float Y() const;
+		float Z() const;
+		float W() const;
+
+		// Static
+		static const Quatf kIdentity;
 	};
-	*/
 
 	// 
 	bool Vec3IsValid(Vec3fRef vec);
@@ -130,6 +191,43 @@ namespace Math
 	Vec3f Vec3Max(Vec3fRef vec1, Vec3fRef vec2);
 	Vec3f Vec3Lerp(Vec3fRef vec1, Vec3fRef vec2, float factor);
 	void Vec3GetFloats(float* out, Vec3fRef vec);
+	Vec3f Vec3TransformPoint(Vec3fRef vec, const Mat4f& mat);
+	Vec3f Vec3TransformVector(Vec3fRef vec, const Mat4f& mat);
+	Vec3f Vec3Rotate(Vec3fRef vec, const Quatf& quat);
+
+	// Strided batch transforms, strides are in bytes and the input and output can alias
+	void Vec3TransformPoints(float* out, int32_t outStride, const float* in, int32_t inStride, int32_t count, const Mat4f& mat);
+	void Vec3TransformVectors(float* out, int32_t outStride, const float* in, int32_t inStride, int32_t count, const Mat4f& mat);
+
+	// 
+	bool Vec4IsValid(Vec4fRef vec);
+	Vec4f Vec4Length(Vec4fRef vec);
+	Vec4f Vec4LengthSquared(Vec4fRef vec);
+	Vec4f Vec4Normalize(Vec4fRef vec);
+	Vec4f Vec4Dot(Vec4fRef vec1, Vec4fRef vec2);
+
+	Vec4f Vec4Abs(Vec4fRef vec);
+	Vec4f Vec4Min(Vec4fRef vec1, Vec4fRef vec2);
+	Vec4f Vec4Max(Vec4fRef vec1, Vec4fRef vec2);
+	Vec4f Vec4Lerp(Vec4fRef vec1, Vec4fRef vec2, float factor);
+	void Vec4GetFloats(float* out, Vec4fRef vec);
+	Vec4f Vec4Transform(Vec4fRef vec, const Mat4f& mat);
+
+	// 
+	Mat4f Mat4Transpose(const Mat4f& mat);
+	// Singular matrices, whose determinant is zero, have no inverse and give the identity
+	Mat4f Mat4Inverse(const Mat4f& mat, float* outDeterminant = NULL);
+	Mat4f Mat4Translation(Vec3fRef translation);
+	Mat4f Mat4Scale(Vec3fRef scale);
+	Mat4f Mat4Rotation(const Quatf& quat);
+	void Mat4GetFloats(float* out, const Mat4f& mat);
+
+	// 
+	Quatf QuatConjugate(const Quatf& quat);
+	Quatf QuatNormalize(const Quatf& quat);
+	Quatf QuatFromAxisAngle(Vec3fRef axis, float angle);
+	Quatf QuatFromRotation(const Mat4f& mat);
+	void QuatGetFloats(float* out, const Quatf& quat);
 
 	// Inline file
 	#include "efwVectorMath-inl.h"
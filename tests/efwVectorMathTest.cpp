@@ -0,0 +1,303 @@
+/**
+ * Standalone conformance test of the VectorMath backends against a double precision reference, build it with the
+ * framework sources both with and without EFW_MATH_SSE. Every result must be within kTolerance of the reference,
+ * relative to its magnitude when above 1. Returns 0 when every case passes.
+ */
+#include "Math/efwVectorMath.h"
+
+#include <math.h>
+#include <stdio.h>
+
+using namespace efw;
+using namespace efw::Math;
+
+static const int32_t kCaseCount = 2000;
+static const double kTolerance = 2e-4;
+static const double kPi = 3.14159265358979323846;
+
+static uint32_t sRandomSeed = 1;
+static int32_t sFailureCount = 0;
+
+
+static float GetRandom(float minValue, float maxValue)
+{
+	sRandomSeed = sRandomSeed * 1664525u + 1013904223u;
+	return minValue + (maxValue - minValue) * ((sRandomSeed >> 8) * (1.0f / 16777216.0f));
+}
+
+
+static void Check(const char* name, int32_t caseIndex, const float* values, const double* references, int32_t count)
+{
+	for (int32_t i=0; i<count; ++i)
+	{
+		const double error = fabs(values[i] - references[i]);
+		const double magnitude = (fabs(references[i]) > 1.0)? fabs(references[i]) : 1.0;
+		if (!(error <= kTolerance * magnitude))
+		{
+			if (sFailureCount++ < 20)
+				printf("FAIL: %s case %d component %d: %.9g, expected %.9g\n", name, caseIndex, i, values[i], references[i]);
+			return;
+		}
+	}
+}
+
+
+static void CheckVec3(const char* name, int32_t caseIndex, Vec3fRef vec, const double* references)
+{
+	EFW_ALIGNED_TYPE(16, float) values[4];
+	Vec3GetFloats(values, vec);
+	Check(name, caseIndex, values, references, 3);
+}
+
+
+static void CheckMat4(const char* name, int32_t caseIndex, const Mat4f& mat, const double* references)
+{
+	EFW_ALIGNED_TYPE(16, float) values[16];
+	Mat4GetFloats(values, mat);
+	Check(name, caseIndex, values, references, 16);
+}
+
+
+// Reference rotation of a vector by an angle around a unit axis (Rodrigues)
+static void RotateReference(double* out, const double* vec, const double* axis, double angle)
+{
+	const double cosAngle = cos(angle), sinAngle = sin(angle);
+	const double dot = axis[0]*vec[0] + axis[1]*vec[1] + axis[2]*vec[2];
+	const double cross[3] = { axis[1]*vec[2] - axis[2]*vec[1], axis[2]*vec[0] - axis[0]*vec[2], axis[0]*vec[1] - axis[1]*vec[0] };
+	for (int32_t i=0; i<3; ++i)
+		out[i] = vec[i] * cosAngle + cross[i] * sinAngle + axis[i] * dot * (1.0 - cosAngle);
+}
+
+
+// Row vector times row major matrix
+static void TransformReference(double* out, const double* vec, int32_t componentCount, const float* mat)
+{
+	for (int32_t j=0; j<4; ++j)
+	{
+		out[j] = (componentCount == 3)? mat[12+j] : 0.0;
+		for (int32_t i=0; i<componentCount; ++i)
+			out[j] += vec[i] * mat[i*4+j];
+	}
+}
+
+
+static void MultiplyReference(double* out, const double* mat1, const double* mat2)
+{
+	for (int32_t i=0; i<4; ++i)
+	for (int32_t j=0; j<4; ++j)
+	{
+		out[i*4+j] = 0.0;
+		for (int32_t k=0; k<4; ++k)
+			out[i*4+j] += mat1[i*4+k] * mat2[k*4+j];
+	}
+}
+
+
+// Gauss-Jordan elimination with partial pivoting
+static void InverseReference(double* out, const float* mat)
+{
+	double m[4][8];
+	for (int32_t i=0; i<4; ++i)
+	for (int32_t j=0; j<4; ++j)
+	{
+		m[i][j] = mat[i*4+j];
+		m[i][j+4] = (i == j)? 1.0 : 0.0;
+	}
+
+	for (int32_t column=0; column<4; ++column)
+	{
+		int32_t pivot = column;
+		for (int32_t i=column+1; i<4; ++i)
+			pivot = (fabs(m[i][column]) > fabs(m[pivot][column]))? i : pivot;
+		for (int32_t j=0; j<8; ++j)
+		{
+			const double value = m[column][j];
+			m[column][j] = m[pivot][j];
+			m[pivot][j] = value;
+		}
+
+		const double invPivot = 1.0 / m[column][column];
+		for (int32_t j=0; j<8; ++j)
+			m[column][j] *= invPivot;
+		for (int32_t i=0; i<4; ++i)
+		{
+			const double factor = (i != column)? m[i][column] : 0.0;
+			for (int32_t j=0; j<8; ++j)
+				m[i][j] -= factor * m[column][j];
+		}
+	}
+
+	for (int32_t i=0; i<4; ++i)
+	for (int32_t j=0; j<4; ++j)
+		out[i*4+j] = m[i][j+4];
+}
+
+
+static void TestVec3(int32_t caseIndex)
+{
+	const float a[3] = { GetRandom(-10.0f, 10.0f), GetRandom(-10.0f, 10.0f), GetRandom(-10.0f, 10.0f) };
+	const float b[3] = { GetRandom(0.5f, 10.0f), GetRandom(-10.0f, -0.5f), GetRandom(0.5f, 10.0f) };
+	const float factor = GetRandom(0.0f, 1.0f);
+	const Vec3f vec1(a[0], a[1], a[2]), vec2(b[0], b[1], b[2]);
+
+	double reference[3];
+	for (int32_t i=0; i<3; ++i) reference[i] = (double)a[i] + b[i];
+	CheckVec3("Vec3 add", caseIndex, vec1 + vec2, reference);
+	for (int32_t i=0; i<3; ++i) reference[i] = (double)a[i] - b[i];
+	CheckVec3("Vec3 sub", caseIndex, vec1 - vec2, reference);
+	for (int32_t i=0; i<3; ++i) reference[i] = (double)a[i] * b[i];
+	CheckVec3("Vec3 mul", caseIndex, vec1 * vec2, reference);
+	for (int32_t i=0; i<3; ++i) reference[i] = (double)a[i] / b[i];
+	CheckVec3("Vec3 div", caseIndex, vec1 / vec2, reference);
+	for (int32_t i=0; i<3; ++i) reference[i] = (a[i] < b[i])? a[i] : b[i];
+	CheckVec3("Vec3Min", caseIndex, Vec3Min(vec1, vec2), reference);
+	for (int32_t i=0; i<3; ++i) reference[i] = (a[i] > b[i])? a[i] : b[i];
+	CheckVec3("Vec3Max", caseIndex, Vec3Max(vec1, vec2), reference);
+	for (int32_t i=0; i<3; ++i) reference[i] = fabs((double)a[i]);
+	CheckVec3("Vec3Abs", caseIndex, Vec3Abs(vec1), reference);
+	for (int32_t i=0; i<3; ++i) reference[i] = floor((double)a[i]);
+	CheckVec3("Vec3Floor", caseIndex, Vec3Floor(vec1), reference);
+	for (int32_t i=0; i<3; ++i) reference[i] = ceil((double)a[i]);
+	CheckVec3("Vec3Ceil", caseIndex, Vec3Ceil(vec1), reference);
+	for (int32_t i=0; i<3; ++i) reference[i] = a[i] + ((double)b[i] - a[i]) * factor;
+	CheckVec3("Vec3Lerp", caseIndex, Vec3Lerp(vec1, vec2, factor), reference);
+
+	const double dot = (double)a[0]*b[0] + (double)a[1]*b[1] + (double)a[2]*b[2];
+	const double length = sqrt((double)a[0]*a[0] + (double)a[1]*a[1] + (double)a[2]*a[2]);
+	for (int32_t i=0; i<3; ++i) reference[i] = dot;
+	CheckVec3("Vec3Dot", caseIndex, Vec3Dot(vec1, vec2), reference);
+	for (int32_t i=0; i<3; ++i) reference[i] = length;
+	CheckVec3("Vec3Length", caseIndex, Vec3Length(vec1), reference);
+	for (int32_t i=0; i<3; ++i) reference[i] = a[i] / length;
+	CheckVec3("Vec3Normalize", caseIndex, Vec3Normalize(vec1), reference);
+
+	reference[0] = (double)a[1]*b[2] - (double)a[2]*b[1];
+	reference[1] = (double)a[2]*b[0] - (double)a[0]*b[2];
+	reference[2] = (double)a[0]*b[1] - (double)a[1]*b[0];
+	CheckVec3("Vec3Cross", caseIndex, Vec3Cross(vec1, vec2), reference);
+}
+
+
+static void TestRotations(int32_t caseIndex)
+{
+	double axis[3] = { GetRandom(-1.0f, 1.0f), GetRandom(-1.0f, 1.0f), GetRandom(-1.0f, 1.0f) + 2.0f };
+	const double axisLength = sqrt(axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2]);
+	for (int32_t i=0; i<3; ++i)
+		axis[i] /= axisLength;
+	const float angle1 = GetRandom(-(float)kPi, (float)kPi);
+	const float angle2 = GetRandom(-(float)kPi, (float)kPi);
+	const double vec[3] = { GetRandom(-10.0f, 10.0f), GetRandom(-10.0f, 10.0f), GetRandom(-10.0f, 10.0f) };
+	const Vec3f axisVec((float)axis[0], (float)axis[1], (float)axis[2]);
+	const Vec3f vecVec((float)vec[0], (float)vec[1], (float)vec[2]);
+
+	// Quaternion, its matrix and the round trip back to a quaternion rotate the same way
+	const Quatf quat1 = QuatFromAxisAngle(axisVec, angle1);
+	double reference[3];
+	RotateReference(reference, vec, axis, angle1);
+	CheckVec3("Vec3Rotate", caseIndex, Vec3Rotate(vecVec, quat1), reference);
+	CheckVec3("Mat4Rotation", caseIndex, Vec3TransformVector(vecVec, Mat4Rotation(quat1)), reference);
+	CheckVec3("QuatFromRotation", caseIndex, Vec3Rotate(vecVec, QuatFromRotation(Mat4Rotation(quat1))), reference);
+	CheckVec3("QuatNormalize", caseIndex, Vec3Rotate(vecVec, QuatNormalize(quat1)), reference);
+
+	// Both compositions apply the left rotation first
+	const Vec3f otherAxisVec(Vec3Normalize(Vec3Cross(axisVec, Vec3f(1.0f, 0.0f, 0.0f))));
+	EFW_ALIGNED_TYPE(16, float) otherAxisValues[4];
+	Vec3GetFloats(otherAxisValues, otherAxisVec);
+	const double otherAxis[3] = { otherAxisValues[0], otherAxisValues[1], otherAxisValues[2] };
+	const Quatf quat2 = QuatFromAxisAngle(otherAxisVec, angle2);
+	double rotated[3];
+	RotateReference(rotated, vec, axis, angle1);
+	RotateReference(reference, rotated, otherAxis, angle2);
+	CheckVec3("Quatf operator *", caseIndex, Vec3Rotate(vecVec, quat1 * quat2), reference);
+	CheckVec3("Mat4f operator *", caseIndex, Vec3TransformVector(vecVec, Mat4Rotation(quat1) * Mat4Rotation(quat2)), reference);
+
+	// Conjugates undo the rotation
+	CheckVec3("QuatConjugate", caseIndex, Vec3Rotate(Vec3Rotate(vecVec, quat1), QuatConjugate(quat1)), vec);
+}
+
+
+static void TestTransforms(int32_t caseIndex)
+{
+	// Scale, rotation and translation with moderate scales, so the matrix is well conditioned
+	const Vec3f scale(GetRandom(0.5f, 2.0f), GetRandom(0.5f, 2.0f), GetRandom(0.5f, 2.0f));
+	const Vec3f axis(GetRandom(-1.0f, 1.0f), GetRandom(-1.0f, 1.0f), GetRandom(1.0f, 2.0f));
+	const Vec3f translation(GetRandom(-50.0f, 50.0f), GetRandom(-50.0f, 50.0f), GetRandom(-50.0f, 50.0f));
+	const Mat4f mat = Mat4Scale(scale) * Mat4Rotation(QuatFromAxisAngle(axis, GetRandom(-3.0f, 3.0f))) * Mat4Translation(translation);
+	EFW_ALIGNED_TYPE(16, float) m[16];
+	Mat4GetFloats(m, mat);
+
+	const double point[4] = { GetRandom(-10.0f, 10.0f), GetRandom(-10.0f, 10.0f), GetRandom(-10.0f, 10.0f), GetRandom(-2.0f, 2.0f) };
+	const Vec3f pointVec((float)point[0], (float)point[1], (float)point[2]);
+	double reference[4];
+	TransformReference(reference, point, 3, m);
+	CheckVec3("Vec3TransformPoint", caseIndex, Vec3TransformPoint(pointVec, mat), reference);
+	TransformReference(reference, point, 3, m);
+	for (int32_t i=0; i<3; ++i)
+		reference[i] -= m[12+i];
+	CheckVec3("Vec3TransformVector", caseIndex, Vec3TransformVector(pointVec, mat), reference);
+
+	EFW_ALIGNED_TYPE(16, float) values[4];
+	TransformReference(reference, point, 4, m);
+	Vec4GetFloats(values, Vec4Transform(Vec4f((float)point[0], (float)point[1], (float)point[2], (float)point[3]), mat));
+	Check("Vec4Transform", caseIndex, values, reference, 4);
+
+	// Batch transforms go through other kernels than the single ones
+	float points[3*3];
+	for (int32_t i=0; i<9; ++i)
+		points[i] = (float)point[i % 3] + i;
+	float transformedPoints[3*3];
+	Vec3TransformPoints(transformedPoints, 3 * sizeof(float), points, 3 * sizeof(float), 3, mat);
+	for (int32_t i=0; i<3; ++i)
+	{
+		const double batchPoint[3] = { points[i*3+0], points[i*3+1], points[i*3+2] };
+		TransformReference(reference, batchPoint, 3, m);
+		Check("Vec3TransformPoints", caseIndex, &transformedPoints[i*3], reference, 3);
+	}
+
+	double transposeReference[16], inverseReference[16];
+	for (int32_t i=0; i<16; ++i)
+		transposeReference[i] = m[(i % 4) * 4 + i / 4];
+	CheckMat4("Mat4Transpose", caseIndex, Mat4Transpose(mat), transposeReference);
+
+	InverseReference(inverseReference, m);
+	CheckMat4("Mat4Inverse", caseIndex, Mat4Inverse(mat), inverseReference);
+
+	double matReference[16], productReference[16];
+	for (int32_t i=0; i<16; ++i)
+		matReference[i] = m[i];
+	MultiplyReference(productReference, matReference, transposeReference);
+	CheckMat4("Mat4f operator *", caseIndex, mat * Mat4Transpose(mat), productReference);
+}
+
+
+int main()
+{
+	for (int32_t i=0; i<kCaseCount; ++i)
+	{
+		TestVec3(i);
+		TestRotations(i);
+		TestTransforms(i);
+	}
+
+	// Singular matrices give the identity and a zero determinant
+	float determinant = 1.0f;
+	EFW_ALIGNED_TYPE(16, float) identity[16];
+	Mat4GetFloats(identity, Mat4f::kIdentity);
+	double identityReference[16];
+	for (int32_t i=0; i<16; ++i)
+		identityReference[i] = identity[i];
+	CheckMat4("Mat4Inverse singular", 0, Mat4Inverse(Mat4Scale(Vec3f(1.0f, 0.0f, 1.0f)), &determinant), identityReference);
+	if (determinant != 0.0f)
+	{
+		printf("FAIL: Mat4Inverse singular determinant %.9g, expected 0\n", determinant);
+		sFailureCount++;
+	}
+
+#if defined(EFW_MATH_SSE)
+	const char* kBackendName = "SSE";
+#else
+	const char* kBackendName = "scalar";
+#endif
+	printf("%s: %s backend, %d cases, %d failures\n", (sFailureCount == 0)? "PASS" : "FAIL", kBackendName, kCaseCount, sFailureCount);
+	return (sFailureCount == 0)? 0 : 1;
+}
\ No newline at end of file
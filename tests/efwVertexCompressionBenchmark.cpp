@@ -0,0 +1,154 @@
+/**
+ * Standalone throughput benchmark of UnprocessedTriMeshHelper::CompressVertexAttribute on every SIMD tier the host
+ * supports, build it with the framework sources. Each tier must give the same bytes as the scalar one.
+ * Returns 0 when every tier matches.
+ */
+#include "Foundation/efwCpuFeatures.h"
+#include "Graphics/efwUnprocessedTriMeshHelper.h"
+#include "Graphics/efwUnprocessedTriMesh.h"
+#include "Math/efwMath.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+using namespace efw;
+using namespace efw::Graphics;
+
+static const int32_t kVertexCount = 1 << 20;
+static const int32_t kIterationCount = 8;
+
+// Position, normal and uv. Kernels read 4 components at a time, so the last uvs also go through the scalar tail
+static const int32_t kVertexComponents = 8;
+static const int32_t kPositionOffset = 0;
+static const int32_t kNormalOffset = 3 * sizeof(float);
+static const int32_t kUvOffset = 6 * sizeof(float);
+
+static const char* kTierNames[] = { "scalar", "sse4.1", "avx2", "avx512" };
+
+struct BenchmarkCase
+{
+	const char* name;
+	AttributeCompression compression;
+	int32_t attributeOffset;
+	int32_t componentCount;
+	int32_t outputComponentSize;
+};
+
+
+static float* CreateVertexData()
+{
+	float* vertexData = (float*)memalign(16, kVertexCount * kVertexComponents * sizeof(float));
+	uint32_t seed = 1;
+	for (int32_t i=0; i<kVertexCount; ++i)
+	{
+		float* vertex = &vertexData[i * kVertexComponents];
+		float random[3];
+		for (int32_t j=0; j<3; ++j)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			random[j] = (seed >> 8) * (1.0f / 16777216.0f);
+		}
+
+		vertex[0] = random[0] * 200.0f - 100.0f;
+		vertex[1] = random[1] * 50.0f;
+		vertex[2] = random[2] * 10.0f - 80.0f;
+
+		const float theta = random[0] * 3.14159265f;
+		const float phi = random[1] * 6.28318531f;
+		vertex[3] = sinf(theta) * cosf(phi);
+		vertex[4] = cosf(theta);
+		vertex[5] = sinf(theta) * sinf(phi);
+
+		vertex[6] = random[1];
+		vertex[7] = random[2];
+	}
+	return vertexData;
+}
+
+
+static bool RunBenchmarkCase(const BenchmarkCase& benchmarkCase, const float* vertexData)
+{
+	UnprocessedTriMeshVertexAttribute attribute;
+	memset(&attribute, 0, sizeof(attribute));
+	attribute.componentCount = (uint8_t)benchmarkCase.componentCount;
+	attribute.offset = (uint8_t)benchmarkCase.attributeOffset;
+
+	const size_t outputSize = (size_t)kVertexCount * benchmarkCase.componentCount * benchmarkCase.outputComponentSize;
+	void* scalarData = NULL;
+	float scalarScale[4], scalarBias[4];
+	bool isValid = true;
+
+	const int32_t maxTier = Math::Min(Cpu::GetMaxSimdTier(), (int32_t)SimdTiers::kAVX512);
+	for (int32_t tier=SimdTiers::kScalar; tier<=maxTier; ++tier)
+	{
+		Cpu::ForceSimdTier(tier);
+
+		// Best of a few runs, the first one also warms up the caches
+		double bestSeconds = 1e30;
+		void* data = NULL;
+		float scale[4], bias[4];
+		for (int32_t i=0; i<kIterationCount; ++i)
+		{
+			EFW_SAFE_ALIGNED_FREE(data);
+			clock_t start = clock();
+			UnprocessedTriMeshHelper::CompressVertexAttribute(&data, vertexData, kVertexComponents * sizeof(float), kVertexCount,
+				attribute, benchmarkCase.compression, scale, bias);
+			const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+			if (seconds < bestSeconds)
+				bestSeconds = seconds;
+		}
+
+		bool isMatching = true;
+		if (tier == SimdTiers::kScalar)
+		{
+			scalarData = data;
+			data = NULL;
+			memcpy(scalarScale, scale, sizeof(scale));
+			memcpy(scalarBias, bias, sizeof(bias));
+		}
+		else
+		{
+			isMatching = (memcmp(data, scalarData, outputSize) == 0);
+			for (int32_t j=0; j<benchmarkCase.componentCount && isMatching; ++j)
+				isMatching = (scale[j] == scalarScale[j] && bias[j] == scalarBias[j]);
+		}
+		isValid &= isMatching;
+
+		printf("%-42s %-7s %8.1f Mvertices/s  %s\n", benchmarkCase.name, kTierNames[tier],
+			(bestSeconds > 0.0)? kVertexCount / bestSeconds * 1e-6 : 0.0, isMatching? "" : "MISMATCH");
+		EFW_SAFE_ALIGNED_FREE(data);
+	}
+
+	EFW_SAFE_ALIGNED_FREE(scalarData);
+	Cpu::ForceSimdTier(SimdTiers::kAuto);
+	return isValid;
+}
+
+
+int main()
+{
+	const BenchmarkCase benchmarkCases[] =
+	{
+		{ "normal kSFloatNormToU8Norm", AttributeCompressions::kSFloatNormToU8Norm, kNormalOffset, 3, 1 },
+		{ "normal kSFloatNormToU16Norm", AttributeCompressions::kSFloatNormToU16Norm, kNormalOffset, 3, 2 },
+		{ "uv kUFloatNormToU8Norm", AttributeCompressions::kUFloatNormToU8Norm, kUvOffset, 2, 1 },
+		{ "uv kUFloatNormToU16Norm", AttributeCompressions::kUFloatNormToU16Norm, kUvOffset, 2, 2 },
+		{ "position kSFloatToU8NormWithScaleAndBias", AttributeCompressions::kSFloatToU8NormWithScaleAndBias, kPositionOffset, 3, 1 },
+		{ "position kSFloatToU16NormWithScaleAndBias", AttributeCompressions::kSFloatToU16NormWithScaleAndBias, kPositionOffset, 3, 2 },
+		{ "uv kUFloatToU8NormWithScaleAndBias", AttributeCompressions::kUFloatToU8NormWithScaleAndBias, kUvOffset, 2, 1 },
+		{ "uv kUFloatToU16NormWithScaleAndBias", AttributeCompressions::kUFloatToU16NormWithScaleAndBias, kUvOffset, 2, 2 },
+	};
+
+	float* vertexData = CreateVertexData();
+	printf("%d vertices, best of %d runs, detected tier %s\n", kVertexCount, kIterationCount, kTierNames[Cpu::GetMaxSimdTier()]);
+
+	bool isValid = true;
+	for (uint32_t i=0; i<EFW_COUNTOF(benchmarkCases); ++i)
+		isValid &= RunBenchmarkCase(benchmarkCases[i], vertexData);
+
+	freealign(vertexData);
+	printf("%s\n", isValid? "PASS: every tier matches the scalar output" : "FAIL: tiers differ from the scalar output");
+	return isValid? 0 : 1;
+}
\ No newline at end of file
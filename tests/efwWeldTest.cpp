@@ -0,0 +1,91 @@
+/**
+ * Standalone regression test of UnprocessedTriMeshHelper::MergeDuplicatedVertices, build it with the framework sources.
+ * Returns 0 when every case passes.
+ */
+#include "Foundation/efwThread.h"
+#include "Graphics/efwUnprocessedTriMeshHelper.h"
+#include "Graphics/efwUnprocessedTriMesh.h"
+#include "Math/efwMath.h"
+
+#include <math.h>
+#include <stdio.h>
+
+using namespace efw;
+using namespace efw::Graphics;
+
+static const float kPi = 3.14159265f;
+
+// Sphere as a triangle soup, every triangle with its own vertices
+static void CreateSphereSoup(UnprocessedTriMesh* outMesh, int32_t segmentCount)
+{
+	const int32_t triangleCount = segmentCount * segmentCount * 2;
+	const uint32_t vertexCount = triangleCount * 3;
+	float* vertexData = (float*)memalign(16, vertexCount * 3 * sizeof(float));
+	uint32_t* indexData = (uint32_t*)memalign(16, vertexCount * sizeof(uint32_t));
+
+	uint32_t vertex = 0;
+	for (int32_t y=0; y<segmentCount; ++y)
+	for (int32_t x=0; x<segmentCount; ++x)
+	{
+		const int32_t corners[6][2] = { {x, y}, {x+1, y}, {x+1, y+1}, {x, y}, {x+1, y+1}, {x, y+1} };
+		for (int32_t i=0; i<6; ++i)
+		{
+			const float theta = kPi * corners[i][1] / segmentCount;
+			const float phi = 2.0f * kPi * corners[i][0] / segmentCount;
+			vertexData[vertex*3+0] = sinf(theta) * cosf(phi);
+			vertexData[vertex*3+1] = cosf(theta);
+			vertexData[vertex*3+2] = sinf(theta) * sinf(phi);
+			indexData[vertex] = vertex;
+			vertex++;
+		}
+	}
+
+	memset(outMesh, 0, sizeof(UnprocessedTriMesh));
+	outMesh->vertexStride = 3 * sizeof(float);
+	outMesh->indexStride = sizeof(uint32_t);
+	outMesh->vertexCount = vertexCount;
+	outMesh->indexCount = vertexCount;
+	outMesh->vertexData = vertexData;
+	outMesh->indexData = indexData;
+	outMesh->vertexAttributes[VertexAttributes::kPosition].componentCount = 3;
+}
+
+
+static bool TestSphereSoup(int32_t segmentCount, float threshold, int32_t threadCount)
+{
+	UnprocessedTriMesh mesh;
+	CreateSphereSoup(&mesh, segmentCount);
+
+	// Thresholds below a hundredth of the extent make cells exactly the threshold size
+	int32_t result = UnprocessedTriMeshHelper::MergeDuplicatedVertices(&mesh, threshold, 0, threadCount);
+
+	// Rings merge their first and last vertices, and the poles collapse to one vertex
+	const uint32_t expectedVertexCount = (segmentCount - 1) * segmentCount + 2;
+	bool isValid = (result == efwErrs::kOk && mesh.vertexCount == expectedVertexCount);
+	const uint32_t* indices = (const uint32_t*)mesh.indexData;
+	for (uint32_t i=0; i<mesh.indexCount && isValid; ++i)
+		isValid = (indices[i] < mesh.vertexCount);
+
+	printf("%s: sphere soup %dx%d, threshold %g, %d threads: %u vertices, expected %u\n", isValid? "PASS" : "FAIL", 
+		segmentCount, segmentCount, threshold, threadCount, mesh.vertexCount, expectedVertexCount);
+
+	EFW_SAFE_ALIGNED_FREE(mesh.vertexData);
+	EFW_SAFE_ALIGNED_FREE(mesh.indexData);
+	return isValid;
+}
+
+
+int main()
+{
+	// Threaded cases only use more than the calling thread on a running pool
+	if (WorkerPool::Initialize(4) != efwErrs::kOk)
+		return 1;
+
+	bool isValid = true;
+	isValid &= TestSphereSoup(60, 0.001f, 1);
+	isValid &= TestSphereSoup(60, 0.001f, 4);
+	isValid &= TestSphereSoup(200, 0.0001f, 1);
+
+	WorkerPool::Shutdown();
+	return isValid? 0 : 1;
+}
\ No newline at end of file